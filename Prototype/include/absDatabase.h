@@ -12,6 +12,7 @@
 #define BASICDEDUP_ABS_DATABASE_H
 
 #include "configure.h"
+#include "chunkStructure.h"
 
 using namespace std;
 
@@ -115,6 +116,19 @@ class AbsDatabase {
          */
         virtual bool QueryBuffer(const char* key, size_t keySize, std::string& value) = 0;
 
+        /**
+         * @brief query a batch of (CHUNK_HASH_SIZE key, sizeof(RecipeEntry_t) value) pairs
+         * 
+         * @param keys the first key, the i-th key is at keys + i * keyStride
+         * @param n the number of keys
+         * @param keyStride the distance between two keys
+         * @param values the first value, the i-th value is written to values + i * valueStride
+         * @param valueStride the distance between two values
+         * @param found the query result of each key
+         */
+        virtual void QueryBatch(const uint8_t* keys, size_t n, size_t keyStride,
+            uint8_t* values, size_t valueStride, uint8_t* found);
+
         /**
          * @brief query the superfeature(sf,fp) pair
          * 
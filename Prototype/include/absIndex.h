@@ -96,6 +96,15 @@ class AbsIndex {
         virtual void ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf, 
             UpOutSGX_t* upOutSGX) = 0;
         
+        /**
+         * @brief answer a fingerprint batch with the duplicate bitmap
+         * 
+         * @param recvFpBuf the recv fingerprint buffer, the bitmap is written back to it
+         * @param upOutSGX the structure to store the enclave related variable
+         */
+        virtual void ProcessFpBatch(SendMsgBuffer_t* recvFpBuf,
+            UpOutSGX_t* upOutSGX) = 0;
+
         /**
          * @brief offline phase
          * 
@@ -0,0 +1,61 @@
+/**
+ * @file chunkPool.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define a pool of fixed-size chunk buffers shared by two threads
+ * @version 0.1
+ * @date 2024-03-12
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#ifndef CHUNK_POOL_H
+#define CHUNK_POOL_H
+
+#include "configure.h"
+#include "messageQueue.h"
+
+using namespace std;
+
+class ChunkPool {
+    private:
+        string myName_ = "ChunkPool";
+
+        // the buffer of all chunks (chunkNum_ * MAX_CHUNK_SIZE)
+        uint8_t* poolBuffer_;
+        uint32_t chunkNum_;
+
+        // the free chunk buffers: released by the consumer, acquired by the producer
+        MessageQueue<uint8_t*>* freeMQ_;
+
+    public:
+        /**
+         * @brief Construct a new Chunk Pool object
+         * 
+         * @param chunkNum the number of chunk buffers
+         */
+        ChunkPool(uint32_t chunkNum);
+
+        /**
+         * @brief Destroy the Chunk Pool object
+         * 
+         */
+        ~ChunkPool();
+
+        /**
+         * @brief acquire a free chunk buffer, wait until one is released
+         * 
+         * @return uint8_t* the chunk buffer (MAX_CHUNK_SIZE)
+         */
+        uint8_t* Acquire();
+
+        /**
+         * @brief release a chunk buffer to the pool, a chunk not in the pool (e.g., in the
+         * mapped input file) is skipped
+         * 
+         * @param chunkBuffer the chunk buffer
+         */
+        void Release(uint8_t* chunkBuffer);
+};
+
+#endif
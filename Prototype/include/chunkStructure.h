@@ -25,9 +25,15 @@ typedef struct {
     uint64_t totalChunkNum;
 } FileRecipeHead_t;
 
+// a chunk in a buffer of the ChunkPool
+typedef struct {
+    uint32_t chunkSize;
+    uint8_t* data;
+} ChunkRef_t;
+
 typedef struct {
     union {
-        Chunk_t chunk;
+        ChunkRef_t chunk;
         FileRecipeHead_t recipeHead;
     };
     int dataType;
@@ -56,10 +62,17 @@ typedef struct {
     uint8_t superfeature[3*CHUNK_HASH_SIZE];
 } RecipeEntry_t;
 
+// the size of a chunk record in a container: recipe entry, fp, 3 sf, ciphertext, iv
+#define CHUNK_RECORD_SIZE(length) (sizeof(RecipeEntry_t) + 4 * CHUNK_HASH_SIZE + (length) + CRYPTO_BLOCK_SIZE)
+
 typedef struct {
     uint64_t sendChunkBatchSize;
     uint64_t sendRecipeBatchSize;
     uint64_t topKParam;
+    uint64_t sfThreadNum;
+    uint64_t baseCacheSize; // the byte budget of the restore base chunk cache
+    uint64_t faaSize; // the byte size of the restore forward assembly area (0: disable)
+    uint64_t decodeThreadNum; // the number of the restore decode threads
 } EnclaveConfig_t;
 
 typedef struct {
@@ -207,6 +220,10 @@ typedef struct {
     RecipeEntry_t chunkAddr;
     uint32_t chunkFreq;
     uint32_t chunkSize;
+    uint32_t chunkOffset; // the offset of the chunk body in the recv buffer
+    uint8_t fpOnlyFlag; // 1: only the fingerprint is received (pre-filtered duplicate)
+    uint8_t* compressedChunk; // the LZ4 form sent by the client, NULL: sent uncompressed
+    uint32_t compressedSize;
     uint8_t superfeature[3*CHUNK_HASH_SIZE];
     RecipeEntry_t basechunkAddr;
 
@@ -229,6 +246,13 @@ typedef struct {
     uint8_t* container;
 } ReqOneContainer_t;
 
+typedef struct {
+    uint8_t* idBuffer; // the ids of the base containers to fetch
+    uint8_t** containerArray; // the untrusted container buffers
+    uint32_t* sizeArray; // the size of each container, 0 if it is not on disk
+    uint32_t idNum;
+} BaseFetch_t;
+
 typedef struct {
     uint32_t QueryNum;
 } DeltaMapInfo_t;
@@ -241,6 +265,7 @@ typedef struct {
     void* outClient;
     void* sgxClient;
     uint8_t* outcallcontainer;
+    BaseFetch_t* baseFetch;
     //for offline process
     uint8_t* process_buffer;
     uint8_t* out_buffer;
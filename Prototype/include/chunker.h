@@ -17,10 +17,15 @@
 #include "configure.h"
 #include "storageCore.h"
 #include "compressGen.h"
+#include "chunkPool.h"
+#include "mappedFile.h"
 
 #include <functional>
 #include <random>
 #include <algorithm>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 
 using namespace std;
 
@@ -72,6 +77,35 @@ static const uint32_t GEAR[] = {
     0x0DC82C11, 0x23FFE354, 0x2EAC53A6, 0x16139E09, 0x0AFD0DBC, 0x2A4D4237,
     0x56A368C7, 0x234325E4, 0x2DCE9187, 0x32E8EA7E};
 
+// a file segment of the parallel FastCDC
+typedef struct {
+    uint64_t offset; // the offset of the segment in the file
+    uint64_t size; // the size of the segment
+    uint8_t* buffer; // the segment and the bytes after it (up to the max chunk size), in the mapped file
+    uint64_t bufferSize;
+    vector<uint64_t> cutList; // the cut points chunked from the segment start (relative to offset)
+    bool ready; // the cut points are ready for the merge
+} ChunkingSegment_t;
+
+// the head of a pre-parsed (binary) FSL/UBC trace
+typedef struct {
+    uint32_t magic;
+    uint32_t traceType; // FSL_TRACE or UBC_TRACE
+    uint64_t traceSize; // the size of the text trace it is parsed from
+    int64_t traceMtimeSec; // the mtime of the text trace it is parsed from
+    int64_t traceMtimeNsec;
+    double avgCompressRatio; // the distribution the compression levels of the records are drawn from
+    double stdCompressRatio;
+    uint64_t recordNum;
+} TraceHead_t;
+
+// a chunk of a pre-parsed (binary) FSL/UBC trace
+typedef struct {
+    uint8_t chunkFp[TRACE_FP_SIZE]; // the fp prefix in the trace (FSL: 6 bytes, UBC: 5 bytes)
+    uint32_t size; // the chunk size in the trace
+    uint32_t compressionInt; // the compression level of the generated chunk
+} TraceRecord_t;
+
 class Chunker{
     private:
         string myName_ = "Chunker";
@@ -87,22 +121,42 @@ class Chunker{
 
         // sliding window size
         int slidingWinSize_;
-        uint8_t* waitingForChunkingBuffer_;
-        uint8_t* chunkBuffer_;
+        // the read-ahead window of the mapped input file
         uint64_t readSize_;
 
-        // for data recipe 
-        ifstream chunkingFile_;
+        // the input file (FIXED_SIZE_CHUNKING and FAST_CDC), the chunks refer to it without copy
+        string chunkingPath_;
+        MappedFile* inputFile_ = NULL;
+
+        // the trace (FSL_TRACE and UBC_TRACE): the pre-parsed records, in the mapped binary
+        // trace or in parsedTrace_
+        vector<TraceRecord_t> parsedTrace_;
+        const TraceRecord_t* traceRecordList_ = NULL;
+        uint64_t traceRecordNum_ = 0;
+        uint32_t traceFpSize_;
 
         // message queue: chunk unit
         MessageQueue<Data_t>* outputMQ_;
+        // the chunk buffers referred by the chunks in the MQ
+        ChunkPool* chunkPoolObj_;
 
         // FAST_CDC
-        size_t pos_ = 0;
         uint32_t normalSize_;
         uint32_t maskS_;
         uint32_t maskL_;
 
+        // parallel FastCDC
+        uint64_t chunkingThreadNum_;
+        uint64_t segmentSize_;
+        // the in-flight segments, segment i is in slot (i % size)
+        vector<ChunkingSegment_t> segmentList_;
+        uint64_t segmentNum_ = 0;
+        uint64_t nextSegment_ = 0; // the next segment to chunk
+        uint64_t mergedSegment_ = 0; // the number of merged segments
+        boost::mutex segmentLck_;
+        boost::condition_variable segmentCond_;
+        uint64_t seamChunkNum_ = 0; // the chunks re-chunked at the segment seams
+
         // for compression
         double avgCompressRatio_ = 2;
         double stdCompressRatio_ = 0.25;
@@ -117,23 +171,43 @@ class Chunker{
         void fixSizeChunking();
 
         /**
-         * @brief FSL trace-driven chunking
+         * @brief FSL/UBC trace-driven chunking, replay the pre-parsed trace records
+         * 
+         */
+        void TraceChunking();
+
+        /**
+         * @brief load the pre-parsed (binary) trace if it matches the text trace
+         * 
+         * @param binPath the path of the binary trace
+         * @param traceStat the stat of the text trace
+         * @return true the binary trace is loaded
+         * @return false the binary trace is missing or stale
+         */
+        bool LoadBinaryTrace(string binPath, const struct stat& traceStat);
+
+        /**
+         * @brief parse the text trace, and save the records as the binary trace for the next runs
          * 
+         * @param path the path of the text trace
+         * @param binPath the path of the binary trace
+         * @param traceStat the stat of the text trace
          */
-        void FSLChunking();
+        void ParseTrace(string path, string binPath, const struct stat& traceStat);
 
         /**
-         * @brief UBC trace-driven chunking
+         * @brief fill the head of the binary trace of the current text trace and config
          * 
+         * @param traceStat the stat of the text trace
+         * @param traceHead the head (without the record num) <return>
          */
-        void UBCChunking();
+        void FillTraceHead(const struct stat& traceStat, TraceHead_t& traceHead);
 
         /**
-         * @brief initialize the chunker inputstream
+         * @brief initialize the chunker settings
          * 
-         * @param path 
          */
-        void ChunkerInit(string path);
+        void ChunkerInit();
 
         /**
          * @brief load the input file 
@@ -148,6 +222,28 @@ class Chunker{
          */
         void FastCDC();
 
+        /**
+         * @brief use FastCDC to do the chunking with multiple threads, the segments are
+         * chunked in parallel and merged in order, the chunks are the same as FastCDC()
+         * 
+         */
+        void ParallelFastCDC();
+
+        /**
+         * @brief the chunking thread of the parallel FastCDC, chunk the segments from
+         * their start offsets
+         * 
+         */
+        void SegmentChunking();
+
+        /**
+         * @brief insert a chunk of the mapped input file to the output MQ without copy
+         * 
+         * @param data the chunk data
+         * @param size the chunk size
+         */
+        void InsertChunk(uint8_t* data, uint32_t size);
+
         /**
          * @brief compute the normal size 
          * 
@@ -211,6 +307,16 @@ class Chunker{
             outputMQ_ = outputMQ;
             return ;
         }
+
+        /**
+         * @brief Set the Chunk Pool object
+         * 
+         * @param chunkPoolObj the pool of chunk buffers
+         */
+        void SetChunkPool(ChunkPool* chunkPoolObj) {
+            chunkPoolObj_ = chunkPoolObj;
+            return ;
+        }
 };
 
 #endif // BASICDEDUP_CHUNKER_h
\ No newline at end of file
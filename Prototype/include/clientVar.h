@@ -17,6 +17,8 @@
 #include "chunkStructure.h"
 #include "messageQueue.h"
 #include "readCache.h"
+#include "containerStore.h"
+#include "restorePrefetcher.h"
 #include "sslConnection.h"
 
 using namespace std;
@@ -60,6 +62,10 @@ class ClientVar {
         // for handling file recipe
         ofstream _recipeWriteHandler;
         ifstream _recipeReadHandler;
+        // set once the recipe end is written, the recipe is published after the epoch is durable
+        bool _recipeFinalized = false;
+        // the fingerprint pre-filter is accepted in the upload login
+        bool _fpPrefilter = false;
         string _tmpQueryBufferStr;
         string _tmpBatchQueryBufferStr;
 
@@ -73,7 +79,8 @@ class ClientVar {
 
         OutQuery_t _outQuery; // the buffer to store the encrypted chunk fp
         MessageQueue<Container_t>* _inputMQ;
-        SendMsgBuffer_t _recvChunkBuf;
+        SendMsgBuffer_t _recvChunkBuf; // alias of the first buffer in the ring
+        SendMsgBuffer_t _recvChunkBufRing[RECV_BUF_RING_SIZE]; // the recv buffers in the pipeline
         Recipe_t _outRecipe; // the buffer to store ciphertext recipe
 
         // restore buffer parameters
@@ -84,6 +91,15 @@ class ClientVar {
         SendMsgBuffer_t _sendChunkBuf;
         ReqOneContainer_t _reqOneContainer;
         uint8_t* _outCallcontainer;
+        BaseFetch_t _baseFetch; // the base containers of the current batch
+
+        // the container views held by this client, released on the next load
+        ContainerStore* _containerStore = NULL;
+        vector<ContainerView_t> _baseViewList; // for the batch fetch
+        vector<ContainerView_t> _refViewList; // for Ocall_getRefContainer
+        vector<ContainerView_t> _reqViewList; // for restore
+        vector<uint32_t> _reqPinList; // the cached containers pinned for restore
+        RestorePrefetcher* _restorePrefetcher = NULL; // the read-ahead of the restore
 
         //buffer for offline
         uint8_t* _process_buffer;
@@ -27,6 +27,8 @@ private:
     uint64_t minChunkSize_;
     uint64_t slidingWinSize_;
     uint64_t readSize_; //128MB per time 
+    uint64_t chunkingThreadNum_; // the number of FastCDC chunking threads, 1: sequential
+    uint64_t chunkingSegmentSize_; // the size (MiB) of the file segment of a chunking thread
     
     // deduplication setting 
     string recipeRootPath_;
@@ -35,9 +37,14 @@ private:
     string containerSuffix_ = "-container";
     string fp2ChunkDBName_;
     uint64_t topKParam_;
+    uint64_t sfThreadNum_; // the number of superfeature workers inside the enclave
+    uint64_t acceptFpPrefilter_; // 1: accept the fingerprint pre-filter of a client in the upload login
     
     // restore setting
     uint64_t readCacheSize_;
+    uint64_t baseCacheSize_; // the byte budget (MiB) of the in-enclave base chunk cache
+    uint64_t faaSize_; // the size (MiB) of the restore forward assembly area, 0: disable
+    uint64_t decodeThreadNum_; // the number of the in-enclave restore decode threads
     
     // for storage ip
     string storageServerIp_;
@@ -47,6 +54,8 @@ private:
     uint32_t clientID_;
     uint64_t sendChunkBatchSize_ = 0;
     uint64_t sendRecipeBatchSize_ = 0;
+    uint64_t fpPrefilter_ = 0; // 1: send the fingerprint batch before the chunk batch
+    uint64_t transCompress_ = 0; // the requested transport compression of the chunk batch
 
     // for RA
     string spid_;
@@ -104,6 +113,14 @@ public:
     inline uint64_t GetReadSize() {
         return readSize_;
     }
+
+    inline uint64_t GetChunkingThreadNum() {
+        return chunkingThreadNum_;
+    }
+
+    inline uint64_t GetChunkingSegmentSize() {
+        return chunkingSegmentSize_ << 20;
+    }
     
     inline string GetRecipeRootPath() {
         return recipeRootPath_;
@@ -153,6 +170,18 @@ public:
         return sendChunkBatchSize_;
     }
 
+    inline uint64_t GetFpPrefilter() {
+        return fpPrefilter_;
+    }
+
+    inline uint64_t GetAcceptFpPrefilter() {
+        return acceptFpPrefilter_;
+    }
+
+    inline uint64_t GetTransCompress() {
+        return transCompress_;
+    }
+
     inline uint64_t GetSendRecipeBatchSize() {
         return sendRecipeBatchSize_;
     }
@@ -184,6 +213,22 @@ public:
     inline uint64_t GetTopKParam() {
         return (topKParam_ * 1024);
     }
+
+    inline uint64_t GetSFThreadNum() {
+        return sfThreadNum_;
+    }
+
+    inline uint64_t GetBaseCacheSize() {
+        return baseCacheSize_ << 20;
+    }
+
+    inline uint64_t GetFAASize() {
+        return faaSize_ << 20;
+    }
+
+    inline uint64_t GetDecodeThreadNum() {
+        return decodeThreadNum_;
+    }
 };
 
 #endif
\ No newline at end of file
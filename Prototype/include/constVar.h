@@ -20,6 +20,15 @@ static const char ENCLAVE_PATH[] = "../lib/storeEnclave.signed.so";
 #define DATAWRITER_BREAKDOWN 0
 #define RESTORE_WRITER_BREAKDOWN 0
 
+// for the container writer: io_uring backend (set by cmake -DWRITER_IO_URING=ON), O_DIRECT writes
+#ifndef IO_URING_WRITER
+#define IO_URING_WRITER 0
+#endif
+#define CONTAINER_O_DIRECT 0
+// 1: append the containers to packfiles with an index footer (CONTAINER_O_DIRECT is not used, the
+// existing container files are still read and replaced by the packfile records), 0: one file per container
+#define CONTAINER_PACK 1
+
 // for GC
 #define IS_MERGE_CONTAINER 1
 #define QUICK_CHECK 0
@@ -39,6 +48,8 @@ static const char ENCLAVE_PATH[] = "../lib/storeEnclave.signed.so";
 #define GREEDY_THRESHOLD 0.0
 #define CONTAINER_SEPARATE 1
 #define SF_SINGLE_THREAD 0
+// 0: rabin-karp features, 1: gear features (the SF index records it, an index built by the other is refused)
+#define SF_GEAR_HASH 0
 #define MeGA_THRESOLD 3
 #define OFFLINE 1
 
@@ -74,6 +85,15 @@ static const uint32_t MAX_SEGMENT_SIZE = AVG_SEGMENT_SIZE * 2; // 20MB default
 static const uint32_t DIVISOR = ((AVG_SEGMENT_SIZE - MIN_SEGMENT_SIZE) / AVG_CHUNK_SIZE);
 static const uint32_t PATTERN = 1;
 
+// the superfeature function (see SF_GEAR_HASH), recorded in the head of the sf index file
+enum SF_FUNCTION_TYPE {SF_FUNCTION_RABIN = 1, SF_FUNCTION_GEAR};
+#if (SF_GEAR_HASH == 1)
+static const uint32_t SF_FUNCTION = SF_FUNCTION_GEAR;
+#else
+static const uint32_t SF_FUNCTION = SF_FUNCTION_RABIN;
+#endif
+static const uint32_t SF_INDEX_MAGIC = 0x58494653;
+
 // the type of chunker
 enum CHUNKER_TYPE
 {
@@ -83,10 +103,25 @@ enum CHUNKER_TYPE
     UBC_TRACE
 };
 
+// the default number of the FastCDC chunking threads, 1: chunk the file sequentially
+static const uint64_t CHUNKING_THREAD_NUM = 1;
+// the default size (MiB) of the file segment chunked by one thread in the parallel FastCDC
+static const uint64_t CHUNKING_SEGMENT_SIZE = 16;
+
+// the pre-parsed (binary) FSL/UBC trace is cached next to the text trace with this suffix
+static const char TRACE_BIN_SUFFIX[] = ".bin";
+static const uint32_t TRACE_BIN_MAGIC = 0x32525442;
+// the max fp prefix size of a trace record
+static const uint32_t TRACE_FP_SIZE = 8;
+static const uint32_t FSL_TRACE_FP_SIZE = 6;
+static const uint32_t UBC_TRACE_FP_SIZE = 5;
+
 // the setting of the container
 static const uint32_t MAX_CONTAINER_SIZE = 1 << 22; // container size: 4MB
 static const uint32_t CONTAINER_ID_LENGTH = 7;
 static const uint32_t SEGMENT_ID_LENGTH = 16;
+// an uploaded recipe is written to <recipe>.tmp, and renamed once all its containers are durable
+static const char RECIPE_TMP_SUFFIX[] = ".tmp";
 
 // define the data type of the MQ
 enum DATA_TYPE_SET
@@ -144,12 +179,77 @@ enum PROTCOL_CODE_SET
     SGX_RA_NOT_SUPPORT,
     SESSION_KEY_INIT,
     SESSION_KEY_REPLY,
-    CLIENT_LOGIN_OFFLINE
+    CLIENT_LOGIN_OFFLINE,
+    CLIENT_UPLOAD_FP,
+    SERVER_FP_BITMAP
 };
 
 static const uint32_t CHUNK_QUEUE_SIZE = 8192;
+
+// how a MessageQueue waits for data (consumer) or space (producer)
+enum MQ_WAIT_TYPE {MQ_WAIT_SPIN = 0, MQ_WAIT_YIELD, MQ_WAIT_PARK};
+static const int MQ_DEFAULT_WAIT = MQ_WAIT_PARK;
+// the number of spin tries before yielding, and yield tries before parking
+static const uint32_t MQ_SPIN_NUM = 1024;
+static const uint32_t MQ_YIELD_NUM = 64;
+// the max wait time of PopWait (us), the consumer re-checks done_ after it
+static const int64_t MQ_WAIT_TIMEOUT_US = 1000;
+// the number of chunk buffers between the chunker and the sender (MAX_CHUNK_SIZE each)
+static const uint32_t CHUNK_POOL_SIZE = 1024;
 static const uint32_t CONTAINER_QUEUE_SIZE = 32;
+// the number of recv buffers in the upload pipeline (network recv || enclave process)
+static const uint32_t RECV_BUF_RING_SIZE = 3;
+// the default of the fingerprint pre-filter upload, 0: send every chunk body
+static const uint64_t FP_PREFILTER = 0;
+// the default of the server switch of the fingerprint pre-filter, 0: refuse it in the upload login
+// (the fingerprint bitmap tells a client whether the chunks of the other clients exist)
+static const uint64_t ACCEPT_FP_PREFILTER = 0;
+// the high bit of the chunk size in a chunk batch: a fingerprint is sent instead of the
+// chunk body, since the enclave reported the chunk as duplicate in the fingerprint batch
+static const uint32_t CHUNK_FP_ONLY_FLAG = 0x80000000;
+// the transport compression of the chunk batches, negotiated in the upload login
+enum TRANS_COMPRESS_TYPE {TRANS_COMPRESS_NONE = 0, TRANS_COMPRESS_LZ4};
+static const uint64_t TRANS_COMPRESS = TRANS_COMPRESS_NONE;
+// the LZ4 acceleration of the transport compression (the same as the in-enclave compression)
+static const int TRANS_LZ4_ACCELERATION = 3;
+// the second high bit of the chunk size in a chunk batch: the chunk is sent in the LZ4 form,
+// i.e., <chunkSize | CHUNK_COMPRESSED_FLAG, compressedSize, compressed chunk>
+static const uint32_t CHUNK_COMPRESSED_FLAG = 0x40000000;
 static const uint32_t CONTAINER_CAPPING_VALUE = 16;
+// the default number of the in-enclave superfeature workers
+static const uint64_t SF_THREAD_NUM = 3;
+// the max number of base containers loaded by one batch fetch OCALL
+static const uint32_t BASE_FETCH_NUM = 32;
+// the base containers referenced by at most this number of chunks in a batch are not loaded whole,
+// only the base chunk records are read (BASE_FETCH_RANGE in the fetch map)
+static const uint32_t BASE_RANGE_READ_REF_NUM = 1;
+static const uint32_t BASE_FETCH_RANGE = UINT32_MAX;
+// the max number of unreferenced container mappings kept by the container store
+static const uint32_t CONTAINER_STORE_IDLE_NUM = 1024;
+// the max number of container writes in flight, and the number of written containers per fsync batch
+static const uint32_t WRITER_QUEUE_DEPTH = 8;
+static const uint32_t WRITER_FSYNC_BATCH = 64;
+static const uint32_t WRITER_DIRECT_ALIGN = 4096;
+// the max size of a container packfile, and the alignment of the container records in it
+static const uint64_t CONTAINER_PACK_SIZE = 1ULL << 30;
+static const uint32_t CONTAINER_PACK_ALIGN = 4096;
+// the number of recipe batches resolved ahead of the restore decode (their containers are prefetched)
+static const uint32_t RESTORE_LOOKAHEAD_BATCH = 2;
+// the default byte budget (MiB) of the in-enclave cache of decoded base chunks in the restore
+static const uint64_t RESTORE_BASE_CACHE_SIZE = 16;
+// the default size (MiB) of the forward assembly area of the restore, 0: restore by container windows
+static const uint64_t RESTORE_FAA_SIZE = 0;
+// the default number of the in-enclave restore decode workers, 0: decode on the restore thread
+static const uint64_t RESTORE_DECODE_THREAD_NUM = 4;
+// the TCSs of the enclave (keep it equal to TCSNum in src/Enclave/storeEnclave.config.xml): the
+// superfeature and restore decode workers hold up to ENCLAVE_WORKER_TCS_NUM of them for the enclave
+// lifetime, at least ENCLAVE_ECALL_TCS_NUM of the rest are left to the ECALLs of the server threads
+// (both are checked when the enclave is initialized)
+static const uint64_t ENCLAVE_TCS_NUM = 32;
+static const uint64_t ENCLAVE_WORKER_TCS_NUM = 12;
+static const uint64_t ENCLAVE_ECALL_TCS_NUM = 20;
+// a decoded chunk of the restore (e.g., a slot of the forward assembly area): the chunk size and the chunk
+static const uint32_t RESTORE_SLOT_SIZE = sizeof(uint32_t) + MAX_CHUNK_SIZE;
 
 static const uint32_t SGX_PERSISTENCE_BUFFER_SIZE = 2 * 1024 * 1024;
 
@@ -194,6 +294,8 @@ static const uint32_t MAX_SGX_MESSAGE_SIZE = 4 * 1024;
 
 static const uint32_t THREAD_STACK_SIZE = 8 * 1024 * 1024;
 static const uint32_t SESSION_KEY_BUFFER_SIZE = 65;
+// the upload login: fileNameHash + Enc(masterKey) + the transport compression + the fingerprint pre-filter
+static const uint32_t UPLOAD_LOGIN_SIZE = 2 * CHUNK_HASH_SIZE + 2 * sizeof(uint32_t);
 
 enum OPT_TYPE
 {
@@ -0,0 +1,262 @@
+/**
+ * @file containerPack.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the append-only packfiles holding many containers
+ * @version 0.1
+ * @date 2024-03-22
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef CONTAINER_PACK_H
+#define CONTAINER_PACK_H
+
+#include "configure.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <boost/thread/shared_mutex.hpp>
+#include <boost/crc.hpp>
+
+using namespace std;
+
+// a record in a packfile: the head, the container body, then padding to CONTAINER_PACK_ALIGN
+typedef struct {
+    uint32_t magic;
+    uint8_t containerID[CONTAINER_ID_LENGTH];
+    uint8_t type; // the container type, or PACK_RECORD_DELETE + the container type
+    uint32_t size;
+    uint32_t checksum; // the crc32 of the head (with checksum = 0) and the container body
+} PackRecordHead_t;
+
+// an entry of the index footer of a sealed packfile
+typedef struct {
+    uint8_t containerID[CONTAINER_ID_LENGTH];
+    uint8_t type;
+    uint32_t size;
+    uint64_t offset; // the offset of the record head
+} PackIndexEntry_t;
+
+// the end of a sealed packfile
+typedef struct {
+    uint64_t indexOffset;
+    uint32_t entryNum;
+    uint32_t magic;
+} PackFooter_t;
+
+// a reserved record, it is visible after it is committed
+typedef struct {
+    PackRecordHead_t head;
+    uint32_t packID;
+    int fd;
+    uint64_t offset;
+} PackWrite_t;
+
+static const uint32_t PACK_RECORD_MAGIC = 0x4b504244;
+static const uint32_t PACK_FOOTER_MAGIC = 0x58444950;
+// the type of a record that deletes the container in the earlier records (+ the container type)
+static const uint8_t PACK_RECORD_DELETE = 2;
+
+class ContainerPack {
+    private:
+        string myName_ = "ContainerPack";
+        string packDir_;
+        uint64_t packSize_;
+
+        // a packfile, only the last one is appended
+        typedef struct {
+            uint32_t packID;
+            int fd;
+            uint8_t* addr;
+            size_t mapSize;
+            // the end of the reserved records
+            uint64_t writeEnd;
+            // the reserved records which are not committed
+            uint32_t pendingNum;
+            // no more records, write the index footer once the pending records are committed
+            bool full;
+            vector<PackIndexEntry_t> entryList;
+        } Pack_t;
+
+        // the location of the latest record of a container
+        typedef struct {
+            uint32_t packID;
+            uint64_t offset; // the offset of the body
+            uint32_t size;
+            // the latest record deletes the container
+            bool deleted;
+        } PackLocation_t;
+
+        vector<Pack_t*> packList_;
+        Pack_t* activePack_ = NULL;
+        // key: container ID + type
+        unordered_map<string, PackLocation_t> locationMap_;
+        boost::shared_mutex packLck_;
+
+        // statistics
+        uint64_t loadEntryNum_ = 0;
+        uint64_t recoverEntryNum_ = 0;
+        uint64_t tornRecordNum_ = 0;
+        uint64_t appendNum_ = 0;
+        uint64_t sealNum_ = 0;
+
+        /**
+         * @brief get the size of a record in the packfile
+         *
+         * @param size the container size
+         * @return uint64_t the record size (aligned)
+         */
+        inline uint64_t RecordSize(uint32_t size) {
+            return (sizeof(PackRecordHead_t) + size + CONTAINER_PACK_ALIGN - 1) /
+                CONTAINER_PACK_ALIGN * CONTAINER_PACK_ALIGN;
+        }
+
+        /**
+         * @brief compute the checksum of a record
+         *
+         * @param head the record head (the checksum field is not covered)
+         * @param body the container body
+         * @return uint32_t the checksum
+         */
+        uint32_t RecordChecksum(const PackRecordHead_t& head, const uint8_t* body);
+
+        /**
+         * @brief get the key of a container in the location map
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @return string the key
+         */
+        inline string LocationKey(const uint8_t* containerID, uint8_t type) {
+            string key((char*)containerID, CONTAINER_ID_LENGTH);
+            key.push_back((char)type);
+            return key;
+        }
+
+        /**
+         * @brief get the file name of a packfile
+         *
+         * @param packID the pack ID
+         * @return string the file name
+         */
+        string PackFileName(uint32_t packID);
+
+        /**
+         * @brief open and map a packfile
+         *
+         * @param packID the pack ID
+         * @param createFlag create a new packfile
+         * @return Pack_t* the packfile
+         */
+        Pack_t* OpenPack(uint32_t packID, bool createFlag);
+
+        /**
+         * @brief load the index of a packfile from its footer, or scan its records if it is not sealed
+         *
+         * @param pack the packfile
+         * @return true the packfile is sealed
+         * @return false the packfile is not sealed
+         */
+        bool LoadPack(Pack_t* pack);
+
+        /**
+         * @brief apply an index entry to the location map
+         *
+         * @param pack the packfile
+         * @param entry the index entry
+         */
+        void ApplyEntry(Pack_t* pack, PackIndexEntry_t& entry);
+
+        /**
+         * @brief write the index footer of a packfile and close its fd
+         *
+         * @param pack the packfile
+         */
+        void SealPack(Pack_t* pack);
+
+        /**
+         * @brief write a buffer to a file at an offset
+         *
+         * @param fd the fd
+         * @param buffer the buffer
+         * @param size the buffer size
+         * @param offset the file offset
+         */
+        void WriteAll(int fd, const uint8_t* buffer, size_t size, uint64_t offset);
+
+    public:
+        /**
+         * @brief Construct a new Container Pack object, load all packfiles in the dir
+         *
+         * @param packDir the dir of the packfiles
+         * @param packSize the max size of a packfile
+         */
+        ContainerPack(const string& packDir, uint64_t packSize);
+
+        /**
+         * @brief Destroy the Container Pack object
+         *
+         */
+        ~ContainerPack();
+
+        /**
+         * @brief reserve a record in the active packfile
+         *
+         * @param containerID the container ID
+         * @param type the record type
+         * @param body the container body (for the checksum of the record head)
+         * @param size the container size
+         * @param packWrite the reserved record <return>
+         */
+        void Reserve(const uint8_t* containerID, uint8_t type, const uint8_t* body,
+            uint32_t size, PackWrite_t& packWrite);
+
+        /**
+         * @brief make a written record visible
+         *
+         * @param packWrite the reserved record
+         */
+        void Commit(PackWrite_t& packWrite);
+
+        /**
+         * @brief append a container (replace the older one with the same ID)
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @param body the container body
+         * @param size the container size
+         */
+        void Append(const uint8_t* containerID, uint8_t type, const uint8_t* body, uint32_t size);
+
+        /**
+         * @brief delete a container
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         */
+        void Delete(const uint8_t* containerID, uint8_t type);
+
+        /**
+         * @brief find a container
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @param data the mapped container body <return>
+         * @param size the container size <return>
+         * @return true success
+         * @return false the container does not exist
+         */
+        bool Lookup(const uint8_t* containerID, uint8_t type, uint8_t*& data, uint32_t& size);
+
+        /**
+         * @brief list the containers of a type
+         *
+         * @param type the container type
+         * @param containerList the (container ID, size) list <return>
+         */
+        void List(uint8_t type, vector<pair<string, uint32_t>>& containerList);
+};
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ * @file containerStore.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define a read-only store of memory-mapped container files shared by all clients
+ * @version 0.1
+ * @date 2024-03-20
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef CONTAINER_STORE_H
+#define CONTAINER_STORE_H
+
+#include "configure.h"
+#include "chunkStructure.h"
+#include "containerPack.h"
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unordered_set>
+#include <boost/thread/mutex.hpp>
+
+using namespace std;
+
+// a read-only view of a whole container, valid until it is released
+typedef struct {
+    uint8_t* data;
+    uint32_t size;
+    void* mapping;
+} ContainerView_t;
+
+class ContainerStore {
+    private:
+        string myName_ = "ContainerStore";
+
+        // a mapped container file
+        typedef struct {
+            string fileName;
+            uint8_t* addr;
+            size_t size;
+            ino_t ino;
+            struct timespec mtime;
+            uint32_t refCnt;
+            // the file is replaced, unmap it once the last view is released
+            bool stale;
+            list<void*>::iterator idleIter;
+        } Mapping_t;
+
+        // the current mapping of each file
+        unordered_map<string, Mapping_t*> mappingMap_;
+        // the unreferenced mappings in LRU order (front is the oldest)
+        list<void*> idleList_;
+        size_t maxIdleNum_;
+        boost::mutex storeLck_;
+        // the packfiles holding the containers, NULL if each container is a file (the
+        // container files written before the packfiles are still read as a fallback)
+        ContainerPack* containerPack_;
+        string containerSuffix_;
+
+        // statistics
+        uint64_t openNum_ = 0;
+        uint64_t mapNum_ = 0;
+        uint64_t totalPageNum_ = 0;
+        uint64_t residentPageNum_ = 0;
+        size_t pageSize_;
+
+        /**
+         * @brief map a container file
+         *
+         * @param fileName the container file
+         * @param fileStat the stat of the file
+         * @return Mapping_t* the mapping, NULL if fails
+         */
+        Mapping_t* Map(const string& fileName, struct stat& fileStat);
+
+        /**
+         * @brief unmap a container file
+         *
+         * @param mapping the mapping
+         */
+        void Unmap(Mapping_t* mapping);
+
+        /**
+         * @brief count the resident pages of a mapped range and prefetch it if some are missing
+         *
+         * @param addr the start of the range
+         * @param size the size of the range
+         */
+        void CheckResidency(uint8_t* addr, size_t size);
+
+        /**
+         * @brief get the file name of a container
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @return string the file name
+         */
+        string ContainerFileName(const string& containerID, uint8_t type);
+
+        /**
+         * @brief list the container files of a type (unsorted)
+         *
+         * @param type the container type
+         * @param containerList the (container ID, size) list <return>
+         */
+        void ListContainerFile(uint8_t type, vector<pair<string, uint32_t>>& containerList);
+
+    public:
+        /**
+         * @brief Construct a new Container Store object
+         *
+         * @param maxIdleNum the max number of unreferenced mappings kept
+         * @param containerSuffix the suffix of the container files
+         * @param containerPack the packfiles holding the containers (NULL: one file per container)
+         */
+        ContainerStore(size_t maxIdleNum, const string& containerSuffix,
+            ContainerPack* containerPack);
+
+        /**
+         * @brief Destroy the Container Store object
+         *
+         */
+        ~ContainerStore();
+
+        /**
+         * @brief get a view of a container file
+         *
+         * @param fileName the container file
+         * @param view the view <return>
+         * @return true success
+         * @return false the file does not exist
+         */
+        bool Open(const string& fileName, ContainerView_t& view);
+
+        /**
+         * @brief get a view of a container
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @param view the view <return>
+         * @return true success
+         * @return false the container does not exist
+         */
+        bool OpenContainer(const string& containerID, uint8_t type, ContainerView_t& view);
+
+        /**
+         * @brief read the record of a chunk to the same offset of a container buffer
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @param offset the offset of the record in the container
+         * @param length the length of the chunk
+         * @param containerBuffer the container buffer (MAX_CONTAINER_SIZE) <return>
+         * @return true success
+         * @return false the record is not stored
+         */
+        bool ReadRecord(const string& containerID, uint8_t type, uint32_t offset,
+            uint32_t length, uint8_t* containerBuffer);
+
+        /**
+         * @brief write a container (replace the old one), the views of the old one stay valid
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @param body the container body
+         * @param size the container size
+         */
+        void SaveContainer(const string& containerID, uint8_t type, const uint8_t* body,
+            size_t size);
+
+        /**
+         * @brief delete a container
+         *
+         * @param containerID the container ID
+         * @param type the container type
+         * @return true success
+         * @return false the container does not exist
+         */
+        bool DeleteContainer(const string& containerID, uint8_t type);
+
+        /**
+         * @brief list the containers of a type, sorted by the container ID
+         *
+         * @param type the container type
+         * @param containerList the (container ID, size) list <return>
+         */
+        void ListContainer(uint8_t type, vector<pair<string, uint32_t>>& containerList);
+
+        /**
+         * @brief release a view
+         *
+         * @param view the view
+         */
+        void Release(ContainerView_t& view);
+
+        /**
+         * @brief release a list of views and clear the list
+         *
+         * @param viewList the list of views
+         */
+        void Release(vector<ContainerView_t>& viewList);
+};
+
+#endif
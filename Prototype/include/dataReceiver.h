@@ -27,6 +27,7 @@ class DataReceiver {
         sgx_enclave_id_t eidSGX_;
 
         uint64_t batchNum_ = 0;
+        uint64_t fpBatchNum_ = 0;
         uint64_t recipeEndNum_ = 0;
 
         // to pass the data to the index thread
@@ -35,6 +36,17 @@ class DataReceiver {
         // pass the storage core obj
         StorageCore* storageCoreObj_;
 
+        /**
+         * @brief receive the batches of a client into the free recv buffers
+         * 
+         * @param outClient the out-enclave client ptr
+         * @param freeMQ the ids of the free recv buffers
+         * @param readyMQ the ids of the received recv buffers (RECV_BUF_RING_SIZE: connection closed)
+         * @param replyMQ the ids of the recv buffers holding a reply to send back
+         */
+        void RecvThread(ClientVar* outClient, MessageQueue<uint32_t>* freeMQ,
+            MessageQueue<uint32_t>* readyMQ, MessageQueue<uint32_t>* replyMQ);
+
     public:
 
         double backup_onlinetime = 0;
@@ -15,7 +15,9 @@
 #include "configure.h"
 #include "sslConnection.h"
 #include "messageQueue.h"
+#include "chunkPool.h"
 #include "cryptoPrimitive.h"
+#include <lz4.h>
 
 extern Configure config;
 
@@ -28,6 +30,10 @@ class DataSender {
         // config
         uint64_t sendChunkBatchSize_ = 0;
         uint32_t clientID_;
+        // 1: send the fingerprint batch first, only send the bodies of non-duplicate chunks
+        uint64_t fpPrefilter_ = 0;
+        // the transport compression: requested by the config, then accepted by the server
+        uint64_t transCompress_ = TRANS_COMPRESS_NONE;
 
         // for security channel encryption
         CryptoPrimitive* cryptoObj_;
@@ -36,11 +42,21 @@ class DataSender {
         EVP_MD_CTX* mdCtx_;
 
         uint64_t batchNum_ = 0;
+        uint64_t prefilterChunkNum_ = 0;
+        uint64_t prefilterDataSize_ = 0;
+        uint64_t transCompressChunkNum_ = 0;
+        uint64_t transSaveSize_ = 0;
         
         // the sender buffer 
         SendMsgBuffer_t sendChunkBuf_;
         SendMsgBuffer_t sendEncBuffer_;
+        // the fingerprints of the chunks in the send chunk buffer (for the pre-filter)
+        uint8_t* fpBuffer_ = NULL;
+        // the compressed payload of the send chunk buffer (for the transport compression)
+        uint8_t* compBuffer_ = NULL;
         MessageQueue<Data_t>* inputMQ_;
+        // the chunk buffers referred by the chunks in the MQ
+        ChunkPool* chunkPoolObj_;
 
         double totalTime_ = 0;
 
@@ -74,11 +90,24 @@ class DataSender {
         void ProcessRecipeEnd(FileRecipeHead_t& recipeHead);
 
         /**
-         * @brief process a chunk
+         * @brief process a chunk, and release its buffer to the chunk pool
          * 
          * @param inputChunk the input chunk
          */
-        void ProcessChunk(Chunk_t& inputChunk);
+        void ProcessChunk(ChunkRef_t& inputChunk);
+
+        /**
+         * @brief query the fingerprints of the send chunk buffer, and replace the body of
+         * each duplicate chunk with its fingerprint
+         * 
+         */
+        void PrefilterChunks();
+
+        /**
+         * @brief compress each chunk body of the send chunk buffer to the compressed buffer
+         * 
+         */
+        void CompressChunks();
 
         /**
          * @brief send a batch of chunks
@@ -143,6 +172,16 @@ class DataSender {
             inputMQ_ = inputMQ;
             return ;
         }
+
+        /**
+         * @brief Set the Chunk Pool object
+         * 
+         * @param chunkPoolObj the pool of chunk buffers
+         */
+        void SetChunkPool(ChunkPool* chunkPoolObj) {
+            chunkPoolObj_ = chunkPoolObj;
+            return ;
+        }
 };
 
 #endif
\ No newline at end of file
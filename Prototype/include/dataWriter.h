@@ -15,9 +15,15 @@
 #include "messageQueue.h"
 #include "configure.h"
 #include "chunkStructure.h"
+#include "containerPack.h"
 
 #include <string>
 #include <bits/stdc++.h>
+#include <fcntl.h>
+#include <unistd.h>
+#if (IO_URING_WRITER == 1)
+#include <liburing.h>
+#endif
 
 using namespace std;
 
@@ -33,6 +39,9 @@ class DataWriter {
         // the tail of the container path
         string containerNameTail_;
 
+        // the packfiles of the containers (CONTAINER_PACK)
+        ContainerPack* containerPack_ = NULL;
+
 #if (DATAWRITER_BREAKDOWN == 1)
         // the time of writing container
         double writeTime_ = 0;
@@ -40,6 +49,84 @@ class DataWriter {
         double totalTime_ = 0;
         // ThreadPool* threadPool_;
 
+        // a container write in flight
+        typedef struct {
+            Container_t* container;
+            uint8_t* writeBuffer; // the container body, the aligned copy for O_DIRECT, or the pack record
+            uint32_t writeSize;
+            uint32_t writtenSize;
+            int fd;
+            uint64_t fileOffset;
+            PackWrite_t packWrite;
+        } WriteSlot_t;
+
+        WriteSlot_t slotArr_[WRITER_QUEUE_DEPTH];
+        vector<uint32_t> freeSlotList_;
+        // the written container files waiting for the batched fsync
+        vector<int> syncFdList_;
+        // the packfiles of syncFdList_ (CONTAINER_PACK)
+        vector<uint32_t> syncPackList_;
+        // the number of written containers waiting for the batched fsync
+        uint32_t syncPendingNum_ = 0;
+        // the number of writes and fsyncs in flight
+        uint32_t inflightNum_ = 0;
+        uint32_t syncInflightNum_ = 0;
+        uint64_t syncBatchNum_ = 0;
+
+#if (IO_URING_WRITER == 1)
+        struct io_uring ring_;
+#endif
+
+        /**
+         * @brief open the file of a container
+         * 
+         * @param newContainer the container
+         * @param flags the extra open flags
+         * @return int the fd
+         */
+        int OpenContainerFile(Container_t& newContainer, int flags);
+
+        /**
+         * @brief start the write of the container in a slot
+         * 
+         * @param slotID the slot id
+         */
+        void SubmitWrite(uint32_t slotID);
+
+        /**
+         * @brief issue the remaining part of the write of a slot
+         * 
+         * @param slotID the slot id
+         */
+        void IssueWrite(uint32_t slotID);
+
+        /**
+         * @brief handle a finished write round of a slot
+         * 
+         * @param slotID the slot id
+         * @param res the written size of this round, or -errno
+         */
+        void CompleteWrite(uint32_t slotID, int res);
+
+        /**
+         * @brief start the fsync of all written container files
+         * 
+         */
+        void SubmitSync();
+
+        /**
+         * @brief reap the finished writes and fsyncs
+         * 
+         * @param wait wait until at least one is finished
+         */
+        void ReapCompletion(bool wait);
+
+        /**
+         * @brief wait for all writes, fsync all written containers and the container dirs
+         * 
+         */
+        void FlushEpoch();
+
     public:
         // the num of the written containers 
         uint64_t containerNum_ = 0;
@@ -57,11 +144,20 @@ class DataWriter {
         ~DataWriter();
 
         /**
-         * @brief the main process of data writer
+         * @brief Set the packfiles of the containers
+         * 
+         * @param containerPack the packfiles
+         */
+        void SetContainerPack(ContainerPack* containerPack);
+
+        /**
+         * @brief the main process of data writer, the containers of this epoch (one backup)
+         * are durable before epochDone is called
          * 
          * @param inputMQ the input MQ
+         * @param epochDone the callback after the epoch is durable (can be NULL)
          */
-        void Run(MessageQueue<Container_t>* inputMQ);
+        void Run(MessageQueue<Container_t>* inputMQ, std::function<void()> epochDone);
 
         /**
          * @brief write the container to the storage backend 
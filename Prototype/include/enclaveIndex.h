@@ -48,6 +48,14 @@ class EnclaveIndex : public AbsIndex {
          */
         void ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf, UpOutSGX_t* upOutSGX);
 
+        /**
+         * @brief answer a fingerprint batch with the duplicate bitmap
+         * 
+         * @param recvFpBuf the recv fingerprint buffer, the bitmap is written back to it
+         * @param upOutSGX the structure to store the enclave related variable
+         */
+        void ProcessFpBatch(SendMsgBuffer_t* recvFpBuf, UpOutSGX_t* upOutSGX);
+
         /**
          * @brief process the tail segment
          * 
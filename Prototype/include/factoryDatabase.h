@@ -15,10 +15,12 @@
 #include "absDatabase.h"
 #include "leveldbDatabase.h"
 #include "inMemoryDatabase.h"
+#include "flatMemoryDatabase.h"
 
 #define LEVEL_DB 1
 #define ROCKS_DB 2
 #define IN_MEMORY 3
+#define FLAT_MEMORY 4
 
 
 
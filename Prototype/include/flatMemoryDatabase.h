@@ -0,0 +1,197 @@
+/**
+ * @file flatMemoryDatabase.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement a in-memory index with a flat open-addressing fp table
+ * @version 0.1
+ * @date 2024-03-08
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef FLAT_MEMORY_INDEX_H
+#define FLAT_MEMORY_INDEX_H
+
+#include "inMemoryDatabase.h"
+#include "tagHash.h"
+
+// the initial number of slots (power of 2)
+static const uint64_t FLAT_INIT_CAPACITY = (1 << 16);
+// grow the table once it is 4/5 full
+static const uint64_t FLAT_LOAD_NUM = 4;
+static const uint64_t FLAT_LOAD_DEN = 5;
+// how many keys ahead QueryBatch prefetches
+static const size_t FLAT_PREFETCH_DIST = 8;
+
+class FlatMemoryDatabase : public InMemoryDatabase {
+    private:
+        string myName_ = "FlatMemoryDatabase";
+
+        // the fixed layout of a slot
+        static constexpr size_t FLAT_KEY_SIZE = CHUNK_HASH_SIZE;
+        static constexpr size_t FLAT_VALUE_SIZE = sizeof(RecipeEntry_t);
+
+        // one tag per slot: 0 is empty, otherwise the high bits of the hash with the MSB set
+        uint8_t* tagArr_ = NULL;
+        // the keys and values are inline, the arrays are cache-line aligned
+        uint8_t* keyArr_ = NULL;
+        uint8_t* valueArr_ = NULL;
+
+        uint64_t capacity_ = 0;
+        uint64_t mask_ = 0;
+        uint64_t itemNum_ = 0;
+
+        /**
+         * @brief allocate an empty table
+         *
+         * @param capacity the number of slots (power of 2)
+         */
+        void AllocTable(uint64_t capacity);
+
+        /**
+         * @brief free the table
+         *
+         */
+        void FreeTable();
+
+        /**
+         * @brief double the table and re-insert all items
+         *
+         */
+        void Grow();
+
+        /**
+         * @brief find the slot of a key
+         *
+         * @param key the key buffer
+         * @param hash the hash of the key
+         * @param slot the slot of the key, or the empty slot to insert it
+         * @return true the key exists
+         * @return false the key does not exist
+         */
+        bool FindSlot(const uint8_t* key, uint64_t hash, uint64_t& slot);
+
+        /**
+         * @brief insert or overwrite a fixed-size item in the table
+         *
+         * @param key the key buffer (FLAT_KEY_SIZE)
+         * @param value the value buffer (FLAT_VALUE_SIZE)
+         */
+        void PutItem(const uint8_t* key, const uint8_t* value);
+
+        /**
+         * @brief query a fixed-size item from the table
+         *
+         * @param key the key buffer (FLAT_KEY_SIZE)
+         * @return uint8_t* the value in the table, NULL if not exists
+         */
+        uint8_t* GetItem(const uint8_t* key);
+
+    protected:
+        /**
+         * @brief persist the fp index to the db file (same format as InMemoryDatabase)
+         *
+         */
+        void PersistFPIndex();
+
+    public:
+        /**
+         * @brief Construct a new Flat Memory Database object
+         *
+         * @param dbName the path of the db file
+         */
+        FlatMemoryDatabase(std::string dbName);
+
+        /**
+         * @brief Destroy the Flat Memory Database object
+         *
+         */
+        ~FlatMemoryDatabase();
+
+        /**
+         * @brief open a database
+         *
+         * @param dbName the db path
+         * @return true success
+         * @return false fails
+         */
+        bool OpenDB(std::string dbName);
+
+        /**
+         * @brief execute query over database
+         *
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Query(const std::string& key, std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         *
+         * @param key key
+         * @param value value
+         * @return true success
+         * @return false fail
+         */
+        bool Insert(const std::string& key, const std::string& value);
+
+        /**
+         * @brief insert the (key, value) pair
+         *
+         * @param key
+         * @param buffer
+         * @param bufferSize
+         * @return true
+         * @return false
+         */
+        bool InsertBuffer(const std::string& key, const char* buffer, size_t bufferSize);
+
+        /**
+         * @brief insert the (key, value) pair, the pairs that do not fit a slot go to the map
+         *
+         * @param key
+         * @param keySize
+         * @param buffer
+         * @param bufferSize
+         * @return true
+         * @return false
+         */
+        bool InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+            size_t bufferSize);
+
+        /**
+         * @brief query the (key, value) pair
+         *
+         * @param key
+         * @param keySize
+         * @param value
+         * @return true
+         * @return false
+         */
+        bool QueryBuffer(const char* key, size_t keySize, std::string& value);
+
+        /**
+         * @brief query a batch of (CHUNK_HASH_SIZE key, sizeof(RecipeEntry_t) value) pairs,
+         * the slots of the following keys are prefetched
+         *
+         * @param keys the first key, the i-th key is at keys + i * keyStride
+         * @param n the number of keys
+         * @param keyStride the distance between two keys
+         * @param values the first value, the i-th value is written to values + i * valueStride
+         * @param valueStride the distance between two values
+         * @param found the query result of each key
+         */
+        void QueryBatch(const uint8_t* keys, size_t n, size_t keyStride,
+            uint8_t* values, size_t valueStride, uint8_t* found);
+
+        /**
+         * @brief get size of all Indexes
+         * @return true
+         * @return false
+         */
+        bool GetIndexSize();
+};
+
+#endif
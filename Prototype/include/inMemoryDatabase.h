@@ -14,12 +14,53 @@
 
 #include "absDatabase.h"
 #include "configure.h"
+#include "sfIndex.h"
 
 class InMemoryDatabase : public AbsDatabase {
     protected:
         /*data*/
         unordered_map<string, string> indexObj_;
-        unordered_map<string,vector<string>>* sfObj_;
+        // one sf index per superfeature
+        SFIndex* sfObj_ = NULL;
+
+        // set once the fp index is written back, so that the derived index can persist its own
+        bool fpIndexPersisted_ = false;
+
+        /**
+         * @brief write a (key, value) item to the db file
+         * 
+         * @param dbFile the db file
+         * @param key the key buffer
+         * @param keySize the key size
+         * @param value the value buffer
+         * @param valueSize the value size
+         */
+        void WriteItem(ofstream& dbFile, const char* key, int keySize,
+            const char* value, int valueSize);
+
+        /**
+         * @brief load the fp index from the db file, the items are inserted via InsertBothBuffer
+         * 
+         */
+        void LoadFPIndex();
+
+        /**
+         * @brief persist the fp index to the db file
+         * 
+         */
+        virtual void PersistFPIndex();
+
+        /**
+         * @brief load the sf index from the sfdb file
+         * 
+         */
+        void LoadSFIndex();
+
+        /**
+         * @brief persist the sf index to the sfdb file
+         * 
+         */
+        void PersistSFIndex();
 
     public:
         /**
@@ -0,0 +1,71 @@
+/**
+ * @file mappedFile.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the read-only mmap of an input file, the chunkers slice it without copy
+ * @version 0.1
+ * @date 2024-03-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include "define.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+using namespace std;
+
+class MappedFile {
+    private:
+        string myName_ = "MappedFile";
+        int fd_;
+        // the mapped file, NULL for an empty file
+        uint8_t* data_ = NULL;
+        uint64_t size_ = 0;
+
+    public:
+        /**
+         * @brief Construct a new Mapped File object, map the whole file for the sequential read
+         *
+         * @param path the file path
+         */
+        MappedFile(string path);
+
+        /**
+         * @brief Destroy the Mapped File object, unmap the file
+         *
+         */
+        ~MappedFile();
+
+        /**
+         * @brief ask the kernel to read a range of the file ahead
+         *
+         * @param offset the range offset
+         * @param length the range length
+         */
+        void WillNeed(uint64_t offset, uint64_t length);
+
+        /**
+         * @brief Get the mapped file
+         *
+         * @return uint8_t* the file data
+         */
+        inline uint8_t* GetData() {
+            return data_;
+        }
+
+        /**
+         * @brief Get the file size
+         *
+         * @return uint64_t the file size
+         */
+        inline uint64_t GetSize() {
+            return size_;
+        }
+};
+
+#endif
@@ -19,6 +19,8 @@
 #include <boost/lockfree/queue.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/thread.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/chrono.hpp>
 
 
 template <class T>
@@ -30,6 +32,73 @@ class MessageQueue {
         // moodycamel::ConcurrentQueue<T>* lockFreeQueue_;
         moodycamel::ReaderWriterQueue<T>* lockFreeQueue_;
 
+        // the wait strategy (MQ_WAIT_TYPE)
+        int waitType_;
+
+        // for parking the consumer (wait data) and the producer (wait space)
+        boost::mutex parkMutex_;
+        boost::condition_variable notEmptyCond_;
+        boost::condition_variable notFullCond_;
+        boost::atomic<bool> consumerParked_;
+        boost::atomic<bool> producerParked_;
+
+        /**
+         * @brief wait until ready() succeeds: spin, then yield, then park (by the wait type)
+         * 
+         * @param ready the try operation
+         * @param parked the parked flag of the caller side
+         * @param cond the cond of the caller side
+         * @param timeoutUs the max wait time (us)
+         * @return true ready() succeeds
+         * @return false timeout
+         */
+        template <class F>
+        bool WaitReady(F ready, boost::atomic<bool>& parked, boost::condition_variable& cond,
+            int64_t timeoutUs) {
+            boost::chrono::steady_clock::time_point deadline = 
+                boost::chrono::steady_clock::now() + boost::chrono::microseconds(timeoutUs);
+            uint64_t round = 0;
+            while (true) {
+                if (ready()) {
+                    return true;
+                }
+                round++;
+                if (waitType_ == MQ_WAIT_PARK && round > MQ_SPIN_NUM + MQ_YIELD_NUM) {
+                    boost::unique_lock<boost::mutex> lock(parkMutex_);
+                    parked.store(true);
+                    boost::atomic_thread_fence(boost::memory_order_seq_cst);
+                    if (ready()) {
+                        parked.store(false);
+                        return true;
+                    }
+                    cond.wait_until(lock, deadline);
+                    parked.store(false);
+                } else if (waitType_ != MQ_WAIT_SPIN && round > MQ_SPIN_NUM) {
+                    boost::this_thread::yield();
+                }
+                if ((round % MQ_SPIN_NUM) == 0 || round > MQ_SPIN_NUM + MQ_YIELD_NUM) {
+                    if (boost::chrono::steady_clock::now() >= deadline) {
+                        return ready();
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief wake up the other side if it is parked
+         * 
+         * @param parked the parked flag of the other side
+         * @param cond the cond of the other side
+         */
+        inline void Notify(boost::atomic<bool>& parked, boost::condition_variable& cond) {
+            boost::atomic_thread_fence(boost::memory_order_seq_cst);
+            if (parked.load()) {
+                boost::lock_guard<boost::mutex> lock(parkMutex_);
+                cond.notify_one();
+            }
+            return ;
+        }
+
     public:
         // to show whether the whole process is done
         boost::atomic<bool> done_;
@@ -37,11 +106,16 @@ class MessageQueue {
         /**
          * @brief Construct a new Message Queue object
          * 
+         * @param maxQueueSize the queue capacity
+         * @param waitType the wait strategy (MQ_WAIT_TYPE)
          */
-        MessageQueue(uint32_t maxQueueSize) {
+        MessageQueue(uint32_t maxQueueSize, int waitType = MQ_DEFAULT_WAIT) {
             // testpointer = new boost::lockfree::queue<T>(1);
             // lockFreeQueue_ = new moodycamel::ConcurrentQueue<T>(QUEUE_SIZE);
             lockFreeQueue_ = new moodycamel::ReaderWriterQueue<T>(maxQueueSize);
+            waitType_ = waitType;
+            consumerParked_ = false;
+            producerParked_ = false;
             done_ = false;
         }
 
@@ -61,7 +135,7 @@ class MessageQueue {
         }
 
         /**
-         * @brief push data to the queue
+         * @brief push data to the queue, wait if the queue is full
          * 
          * @param data the original data
          * @return true success
@@ -69,9 +143,11 @@ class MessageQueue {
          */
         bool Push(T& data) {
             // while (!lockFreeQueue_.push(data)) {
-            while (!lockFreeQueue_->try_enqueue(data)) {
+            while (!WaitReady([&]() {return lockFreeQueue_->try_enqueue(data);},
+                producerParked_, notFullCond_, MQ_WAIT_TIMEOUT_US)) {
                 ;
             }
+            Notify(consumerParked_, notEmptyCond_);
             return true;
         }
 
@@ -84,7 +160,28 @@ class MessageQueue {
          */
         bool Pop(T& data) {
             // return lockFreeQueue_.pop(data);
-            return lockFreeQueue_->try_dequeue(data);
+            if (lockFreeQueue_->try_dequeue(data)) {
+                Notify(producerParked_, notFullCond_);
+                return true;
+            }
+            return false;
+        }
+
+        /**
+         * @brief pop data from the queue, wait (by the wait type) if the queue is empty
+         * 
+         * @param data the original data
+         * @param timeoutUs the max wait time (us)
+         * @return true success
+         * @return false the queue is still empty after timeoutUs
+         */
+        bool PopWait(T& data, int64_t timeoutUs = MQ_WAIT_TIMEOUT_US) {
+            if (WaitReady([&]() {return lockFreeQueue_->try_dequeue(data);},
+                consumerParked_, notEmptyCond_, timeoutUs)) {
+                Notify(producerParked_, notFullCond_);
+                return true;
+            }
+            return false;
         }
 
         /**
@@ -14,6 +14,7 @@
 
 #include "configure.h"
 #include "lruCache.h"
+#include <boost/thread/mutex.hpp>
 
 using namespace std;
 
@@ -24,16 +25,57 @@ class ReadCache {
         // the cache pointer
         // boost::compute::detail::lru_cache<string, string>* readCache_;
         // <container-ID, index of container pool>
-        lru11::Cache<string, uint32_t> trueCache_ = lru11::Cache<string, uint32_t>(64, 0);
+        // unbounded, the capacity is managed by cacheSize_
+        lru11::Cache<string, uint32_t> trueCache_ = lru11::Cache<string, uint32_t>(0, 0);
         lru11::Cache<string, uint32_t>* readCache_ = &trueCache_;
 
         // container cache space pointer
         uint8_t** containerPool_;
+        // the pin count of each container of the pool, a pinned container is not evicted
+        vector<uint32_t> pinCntList_;
 
         // container cache size
         uint64_t cacheSize_ = 0;
 
         size_t currentIndex_ = 0;
+
+        // the cache is shared by the restore thread and the prefetch thread
+        boost::mutex cacheLck_;
+
+        // the known future accesses of each container (positions in the access sequence),
+        // used to evict the container whose next access is the farthest
+        unordered_map<string, deque<uint64_t>> futureMap_;
+        // the position of the next access
+        uint64_t accessPos_ = 0;
+
+        /**
+         * @brief get the position of the next access of a container
+         * 
+         * @param name id of the container
+         * @return uint64_t the position, UINT64_MAX if it is not accessed again
+         */
+        uint64_t NextAccess(const string& name);
+
+        /**
+         * @brief find the unpinned container whose next access is the farthest (the LRU one on ties)
+         * 
+         * @param victimName id of the container <return>
+         * @param victimIndex the pool index of the container <return>
+         * @param victimPos the position of its next access <return>
+         * @return true find a victim
+         * @return false all cached containers are pinned
+         */
+        bool FindVictim(string& victimName, uint32_t& victimIndex, uint64_t& victimPos);
+
+        /**
+         * @brief check whether a new container is accessed earlier than the victim
+         * 
+         * @param name id of the new container
+         * @param victimPos the position of the next access of the victim
+         * @return true cache the new container
+         * @return false the new container should not be cached
+         */
+        bool Admit(const string& name, uint64_t victimPos);
     public:
         /**
          * @brief Construct a new Read Cache object
@@ -75,6 +117,45 @@ class ReadCache {
          */
         uint8_t* ReadFromCache(string& name);
 
+        /**
+         * @brief pin a cached container, it is not evicted until it is unpinned
+         * 
+         * @param name id of the container
+         * @param index the pool index of the container <return>
+         * @return uint8_t* the container data, NULL if it is not cached
+         */
+        uint8_t* PinFromCache(string& name, uint32_t& index);
+
+        /**
+         * @brief unpin a list of containers and clear the list
+         * 
+         * @param pinList the pool indexes of the pinned containers
+         */
+        void Unpin(vector<uint32_t>& pinList);
+
+        /**
+         * @brief add a known future access of a container (the eviction hint)
+         * 
+         * @param name id of the container
+         * @param pos the position in the access sequence
+         */
+        void AddFutureAccess(const string& name, uint64_t pos);
+
+        /**
+         * @brief the restore accesses a container, drop its earliest future access
+         * 
+         * @param name id of the container
+         */
+        void ConsumeAccess(const string& name);
+
+        /**
+         * @brief check whether a container would be cached if it is inserted now
+         * 
+         * @param name id of the container
+         * @return true it would be cached
+         * @return false it would be rejected (or it is cached already)
+         */
+        bool WouldAdmit(const string& name);
 };
 
 #endif // !BASICDEDUP_READCACHE_H
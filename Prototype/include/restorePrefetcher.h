@@ -0,0 +1,86 @@
+/**
+ * @file restorePrefetcher.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the read-ahead of the containers of a restore, driven by the resolved file recipe
+ * @version 0.1
+ * @date 2024-03-26
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef RESTORE_PREFETCHER_H
+#define RESTORE_PREFETCHER_H
+
+#include "configure.h"
+#include "readCache.h"
+#include "containerStore.h"
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+using namespace std;
+
+class RestorePrefetcher {
+    private:
+        string myName_ = "RestorePrefetcher";
+        ContainerStore* containerStore_;
+        ReadCache* readCache_;
+        // the max distance (in container accesses) of the read-ahead
+        uint64_t lookaheadNum_;
+
+        // the container accesses to prefetch: (container ID, position in the access sequence)
+        deque<pair<string, uint64_t>> jobList_;
+        // the position of the next posted access and the next restore access
+        uint64_t postPos_ = 0;
+        uint64_t accessPos_ = 0;
+        bool done_ = false;
+        boost::mutex prefetchLck_;
+        boost::condition_variable jobCond_;
+        boost::thread* worker_;
+
+        // statistics
+        uint64_t postNum_ = 0;
+        uint64_t prefetchNum_ = 0;
+        uint64_t skipNum_ = 0;
+
+        /**
+         * @brief the main loop of the prefetch thread
+         *
+         */
+        void Run();
+
+    public:
+        /**
+         * @brief Construct a new Restore Prefetcher object, start the prefetch thread
+         *
+         * @param containerStore the container store
+         * @param readCache the container cache of the client
+         * @param lookaheadNum the max distance (in container accesses) of the read-ahead
+         */
+        RestorePrefetcher(ContainerStore* containerStore, ReadCache* readCache,
+            uint64_t lookaheadNum);
+
+        /**
+         * @brief Destroy the Restore Prefetcher object, stop the prefetch thread
+         *
+         */
+        ~RestorePrefetcher();
+
+        /**
+         * @brief post the containers of a future load, in the access order
+         *
+         * @param idBuffer the container IDs
+         * @param idNum the number of container IDs
+         */
+        void Post(const uint8_t* idBuffer, uint32_t idNum);
+
+        /**
+         * @brief the restore accesses a container
+         *
+         * @param containerID the container ID
+         */
+        void Consume(const string& containerID);
+};
+
+#endif
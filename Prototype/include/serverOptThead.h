@@ -23,6 +23,7 @@
 #include "absDatabase.h"
 #include "configure.h"
 #include "clientVar.h"
+#include "containerStore.h"
 #include "raUtil.h"
 
 // for restore
@@ -55,6 +56,11 @@ class ServerOptThread {
         // for restore
         EnclaveRecvDecoder* recvDecoderObj_;
 
+        // the containers shared by all clients
+        ContainerStore* containerStoreObj_;
+        // the container packfiles (NULL if each container is a file)
+        ContainerPack* containerPackObj_ = NULL;
+
         // for SGX related
         sgx_enclave_id_t eidSGX_;
 
@@ -0,0 +1,191 @@
+/**
+ * @file sfIndex.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define a compact superfeature index (sf -> list of base chunk fp)
+ * @version 0.1
+ * @date 2024-03-10
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef SF_INDEX_H
+#define SF_INDEX_H
+
+#include "configure.h"
+#include <functional>
+#include "tagHash.h"
+
+// the initial number of buckets (power of 2)
+static const uint64_t SF_INDEX_INIT_CAPACITY = (1 << 16);
+// the number of value slots in a slab
+static const uint32_t SF_SLAB_SLOT_NUM = (1 << 16);
+// the end of a slot list
+static const uint32_t SF_SLOT_NIL = UINT32_MAX;
+
+class SFIndex {
+    private:
+        // a bucket of the directory, the fp list is [head, ..., tail] with num slots
+        typedef struct {
+            uint8_t key[CHUNK_HASH_SIZE];
+            uint32_t head;
+            uint32_t tail;
+            uint32_t num;
+        } SFBucket_t;
+
+        // a value slot, next links the fp list or the free list
+        typedef struct {
+            uint8_t fp[CHUNK_HASH_SIZE];
+            uint32_t next;
+        } SFSlot_t;
+
+        // one tag per bucket: 0 is empty, otherwise the high bits of the hash with the MSB set
+        uint8_t* tagArr_ = NULL;
+        SFBucket_t* bucketArr_ = NULL;
+        uint64_t capacity_ = 0;
+        uint64_t mask_ = 0;
+        uint64_t keyNum_ = 0;
+
+        // the value slots
+        vector<SFSlot_t*> slabList_;
+        uint32_t freeHead_ = SF_SLOT_NIL;
+        uint64_t slotNum_ = 0;
+
+        /**
+         * @brief get a value slot by its id
+         *
+         * @param id the slot id
+         * @return SFSlot_t* the slot
+         */
+        inline SFSlot_t* GetSlot(uint32_t id) {
+            return slabList_[id / SF_SLAB_SLOT_NUM] + (id % SF_SLAB_SLOT_NUM);
+        }
+
+        /**
+         * @brief allocate an empty directory
+         *
+         * @param capacity the number of buckets (power of 2)
+         */
+        void AllocTable(uint64_t capacity);
+
+        /**
+         * @brief double the directory and re-insert all buckets
+         *
+         */
+        void Grow();
+
+        /**
+         * @brief find the bucket of a key
+         *
+         * @param key the key buffer
+         * @param hash the hash of the key
+         * @param pos the bucket of the key, or the empty bucket to insert it
+         * @return true the key exists
+         * @return false the key does not exist
+         */
+        bool FindBucket(const uint8_t* key, uint64_t hash, uint64_t& pos);
+
+        /**
+         * @brief take a slot from the free list (or a new slab)
+         *
+         * @param fp the fp stored in the slot
+         * @return uint32_t the slot id
+         */
+        uint32_t AllocSlot(const uint8_t* fp);
+
+        /**
+         * @brief return a list of slots to the free list
+         *
+         * @param head the first slot
+         * @param tail the last slot
+         * @param num the number of slots in the list
+         */
+        void FreeSlotList(uint32_t head, uint32_t tail, uint64_t num);
+
+        /**
+         * @brief remove a bucket by shifting back the following buckets (no tombstone)
+         *
+         * @param pos the bucket
+         */
+        void RemoveBucket(uint64_t pos);
+
+    public:
+        /**
+         * @brief Construct a new SFIndex object
+         *
+         */
+        SFIndex();
+
+        /**
+         * @brief Destroy the SFIndex object
+         *
+         */
+        ~SFIndex();
+
+        /**
+         * @brief append a fp to the list of a sf
+         *
+         * @param key the sf (CHUNK_HASH_SIZE)
+         * @param fp the base chunk fp (CHUNK_HASH_SIZE)
+         */
+        void Insert(const uint8_t* key, const uint8_t* fp);
+
+        /**
+         * @brief replace the list of a sf with a single fp in place
+         *
+         * @param key the sf (CHUNK_HASH_SIZE)
+         * @param fp the base chunk fp (CHUNK_HASH_SIZE)
+         */
+        void Replace(const uint8_t* key, const uint8_t* fp);
+
+        /**
+         * @brief remove a sf and its list
+         *
+         * @param key the sf (CHUNK_HASH_SIZE)
+         */
+        void Erase(const uint8_t* key);
+
+        /**
+         * @brief query the first fp of a sf
+         *
+         * @param key the sf (CHUNK_HASH_SIZE)
+         * @param fp the first base chunk fp (CHUNK_HASH_SIZE) <return>
+         * @return true the sf exists
+         * @return false the sf does not exist
+         */
+        bool Query(const uint8_t* key, uint8_t* fp);
+
+        /**
+         * @brief visit all (sf, fp) pairs in list order
+         *
+         * @param visitor the visitor
+         */
+        void Traverse(const std::function<void(const uint8_t*, const uint8_t*)>& visitor);
+
+        /**
+         * @brief get the number of sf
+         *
+         * @return uint64_t the number of sf
+         */
+        inline uint64_t GetKeyNum() {
+            return keyNum_;
+        }
+
+        /**
+         * @brief get the number of (sf, fp) pairs
+         *
+         * @return uint64_t the number of pairs
+         */
+        inline uint64_t GetValueNum() {
+            return slotNum_;
+        }
+
+        /**
+         * @brief get the exact allocated memory of the index
+         *
+         * @return uint64_t the memory size (bytes)
+         */
+        uint64_t GetMemoryUsage();
+};
+
+#endif
@@ -37,6 +37,15 @@ class StorageCore {
          */
         void UpdateRecipeToFile(const uint8_t* recipeBuffer, size_t recipeEntryNum, ofstream& fileRecipeHandler);
 
+        /**
+         * @brief publish the uploaded recipe: persist <recipe>.tmp and rename it to the recipe,
+         * called after all its containers are durable
+         * 
+         * @param recipePath the recipe path
+         * @param finalized whether the recipe end is written (otherwise the upload is dropped)
+         */
+        void PublishRecipe(const string& recipePath, bool finalized);
+
         /**
          * @brief Construct a new Storage Core object
          * 
@@ -0,0 +1,45 @@
+/**
+ * @file tagHash.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the hash of the open-addressing tables with a tag byte per slot
+ * (the flat fp index and the sf index)
+ * @version 0.1
+ * @date 2024-03-08
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef TAG_HASH_H
+#define TAG_HASH_H
+
+#include <stdint.h>
+#include <string.h>
+
+namespace tool {
+    /**
+     * @brief hash a key, the key is a chunk fingerprint (or a superfeature) and already uniform
+     *
+     * @param key the key buffer (at least 8 bytes)
+     * @return uint64_t the hash
+     */
+    inline uint64_t HashKey(const uint8_t* key) {
+        uint64_t hash;
+        memcpy(&hash, key, sizeof(hash));
+        hash *= 0x9e3779b97f4a7c15ULL;
+        return hash ^ (hash >> 32);
+    }
+
+    /**
+     * @brief get the tag of a hash: 0 is an empty slot, otherwise the high bits of the
+     * hash with the MSB set
+     *
+     * @param hash the hash
+     * @return uint8_t the tag
+     */
+    inline uint8_t HashTag(uint64_t hash) {
+        return (uint8_t)(hash >> 57) | 0x80;
+    }
+}
+
+#endif
@@ -171,6 +171,10 @@ int main(int argc, char* argv[]) {
             MessageQueue<Data_t>* chunker2SenderMQ = new MessageQueue<Data_t>(CHUNK_QUEUE_SIZE);
             chunkerObj->SetOutputMQ(chunker2SenderMQ);
             dataSenderObj->SetInputMQ(chunker2SenderMQ);
+            // the MQ only carries the references to the pooled chunk buffers
+            ChunkPool* chunkPoolObj = new ChunkPool(CHUNK_POOL_SIZE);
+            chunkerObj->SetChunkPool(chunkPoolObj);
+            dataSenderObj->SetChunkPool(chunkPoolObj);
 
             dataSenderObj->UploadLogin(config.GetLocalSecret(), fileNameHash, optType);
 
@@ -204,6 +208,7 @@ int main(int argc, char* argv[]) {
             delete chunkerObj;
             delete dataSenderObj;
             delete chunker2SenderMQ;
+            delete chunkPoolObj;
             thList.clear();
             break;
         }
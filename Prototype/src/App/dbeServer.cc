@@ -131,7 +131,7 @@ int main(int argc, char* argv[]) {
     boost::thread_attributes attrs;
     attrs.set_stack_size(THREAD_STACK_SIZE);
     
-    fp2ChunkDB = dbFactory.CreateDatabase(IN_MEMORY, config.GetFp2ChunkDBName());
+    fp2ChunkDB = dbFactory.CreateDatabase(FLAT_MEMORY, config.GetFp2ChunkDBName());
     dataSecurityChannelObj = new SSLConnection(config.GetStorageServerIP(), 
         config.GetStoragePort(), IN_SERVERSIDE);
 
@@ -160,6 +160,10 @@ int main(int argc, char* argv[]) {
     enclaveConfig.sendChunkBatchSize = config.GetSendChunkBatchSize();
     enclaveConfig.sendRecipeBatchSize = config.GetSendRecipeBatchSize();
     enclaveConfig.topKParam = config.GetTopKParam();
+    enclaveConfig.sfThreadNum = config.GetSFThreadNum();
+    enclaveConfig.baseCacheSize = config.GetBaseCacheSize();
+    enclaveConfig.faaSize = config.GetFAASize();
+    enclaveConfig.decodeThreadNum = config.GetDecodeThreadNum();
     Ecall_Enclave_Init(eidSGX, &enclaveConfig);
 
     // init 
@@ -11,6 +11,15 @@
 #include <stdio.h>
 #include <sys/time.h>
 #include "../../include/chunker.h"
+
+// the SIMD kernel is selected by the client build flags (see CDC_SIMD in src/Client/CMakeLists.txt)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CDC_SIMD_AVX2 1
+// the number of bytes hashed and tested per kernel step (4 x 64-bit lanes, 8 bytes per lane)
+static const uint32_t CDC_SIMD_BLOCK_SIZE = 32;
+#endif
+
 struct timeval sTimeChunking;
 struct timeval eTimeChunking;
 struct timeval sTimeMQ;
@@ -23,18 +32,17 @@ struct timeval eTimeMQ;
  * @param storageCoreObj refer to the storageCore MQ 
  */
 Chunker::Chunker(std::string path) {
-    LoadChunkFile(path);
-    ChunkerInit(path);
     compressGenObj_ = new CompressGen(3.0, 3.0, 1);
+    ChunkerInit();
+    LoadChunkFile(path);
     tool::Logging(myName_.c_str(), "init the chunker.\n");
 }
 
 /**
- * @brief initialize the chunker inputstream
+ * @brief initialize the chunker settings
  * 
- * @param path 
  */
-void Chunker::ChunkerInit(string path) {
+void Chunker::ChunkerInit() {
     // get the chunking method type
     chunkerType_ = config.GetChunkingType();
     avgChunkSize_ = config.GetAvgChunkSize();
@@ -47,14 +55,6 @@ void Chunker::ChunkerInit(string path) {
     switch (chunkerType_) {
         case FIXED_SIZE_CHUNKING: {
             tool::Logging(myName_.c_str(), "using fixed size chunking.\n");
-            waitingForChunkingBuffer_ = (uint8_t*) calloc(readSize_, sizeof(uint8_t));
-            chunkBuffer_ = (uint8_t*) calloc(maxChunkSize_ , sizeof(uint8_t));
-
-            if ((!waitingForChunkingBuffer_) || (!chunkBuffer_)) {
-                tool::Logging(myName_.c_str(), "memory malloc error.\n");
-                exit(EXIT_FAILURE);
-            }
-
             if (minChunkSize_ >= avgChunkSize_ || minChunkSize_ >= maxChunkSize_) {
                 tool::Logging(myName_.c_str(), "minChunkSize_ setting error.\n");
                 exit(EXIT_FAILURE);
@@ -68,14 +68,6 @@ void Chunker::ChunkerInit(string path) {
         }
         case FAST_CDC: {
             tool::Logging(myName_.c_str(), "using FastCDC chunking.\n");
-            waitingForChunkingBuffer_ = (uint8_t*) calloc(readSize_, sizeof(uint8_t));
-            pos_ = 0;
-
-            if (!waitingForChunkingBuffer_) {
-                tool::Logging(myName_.c_str(), "memory malloc error.\n");
-                exit(EXIT_FAILURE);
-            }
-
             if (minChunkSize_ >= avgChunkSize_ || minChunkSize_ >= maxChunkSize_) {
                 tool::Logging(myName_.c_str(), "minChunkSize_ setting error.\n");
                 exit(EXIT_FAILURE);
@@ -90,16 +82,27 @@ void Chunker::ChunkerInit(string path) {
             uint32_t bits = (uint32_t) round(log2(static_cast<double>(avgChunkSize_))); 
             maskS_ = GenerateFastCDCMask(bits + 1);
             maskL_ = GenerateFastCDCMask(bits - 1);
+
+            chunkingThreadNum_ = config.GetChunkingThreadNum();
+            segmentSize_ = config.GetChunkingSegmentSize();
+            if (chunkingThreadNum_ > 1) {
+                if (segmentSize_ <= maxChunkSize_) {
+                    tool::Logging(myName_.c_str(), "chunkingSegmentSize_ setting error.\n");
+                    exit(EXIT_FAILURE);
+                }
+                tool::Logging(myName_.c_str(), "using %lu chunking threads.\n",
+                    chunkingThreadNum_);
+            }
             break;
         }
         case FSL_TRACE: {
             tool::Logging(myName_.c_str(), "using FSL trace chunking.\n");
-            chunkBuffer_ = (uint8_t*) calloc(maxChunkSize_, sizeof(uint8_t));
+            traceFpSize_ = FSL_TRACE_FP_SIZE;
             break;
         }
         case UBC_TRACE: {
             tool::Logging(myName_.c_str(), "using FSL trace chunking.\n");
-            chunkBuffer_ = (uint8_t*) calloc(maxChunkSize_, sizeof(uint8_t));
+            traceFpSize_ = UBC_TRACE_FP_SIZE;
             break;
         }
         default: {
@@ -116,33 +119,17 @@ void Chunker::ChunkerInit(string path) {
  */
 Chunker::~Chunker() {
     delete compressGenObj_;
-    switch (chunkerType_) {
-        case FIXED_SIZE_CHUNKING: {
-            free(chunkBuffer_);
-            free(waitingForChunkingBuffer_);
-            break;
-        }
-        case FAST_CDC: {
-            free(waitingForChunkingBuffer_);
-            break;
-        }
-        case FSL_TRACE: {
-            free(chunkBuffer_);
-            break;
-        }
-        case UBC_TRACE: {
-            free(chunkBuffer_);
-            break;
-        }
-    }
-    if (chunkingFile_.is_open()) {
-        chunkingFile_.close();
+    if (inputFile_ != NULL) {
+        delete inputFile_;
     }
 
     fprintf(stderr, "========Chunker Info========\n");
     fprintf(stderr, "total file size: %lu\n", _recipe.recipeHead.fileSize);
     fprintf(stderr, "total chunk num: %lu\n", _recipe.recipeHead.totalChunkNum);
     fprintf(stderr, "total thread running time: %lf\n", totalTime_);
+    if (chunkerType_ == FAST_CDC && chunkingThreadNum_ > 1) {
+        fprintf(stderr, "segment seam re-chunked chunk num: %lu\n", seamChunkNum_);
+    }
 #if (CHUNKING_BREAKDOWN == 1)
     fprintf(stderr, "total MQ insert time: %lf\n", insertTime_);
     fprintf(stderr, "total chunking time: %lf\n", (totalTime_ - insertTime_));
@@ -164,15 +151,16 @@ void Chunker::Chunking() {
             break;
         }
         case FAST_CDC: {
-            FastCDC();
-            break;
-        }
-        case FSL_TRACE: {
-            FSLChunking();
+            if (chunkingThreadNum_ > 1) {
+                ParallelFastCDC();
+            } else {
+                FastCDC();
+            }
             break;
         }
+        case FSL_TRACE:
         case UBC_TRACE: {
-            UBCChunking();
+            TraceChunking();
             break;
         }
         default: {
@@ -190,16 +178,23 @@ void Chunker::Chunking() {
  * @param path the path of the chunking file
  */
 void Chunker::LoadChunkFile(string path) {
-    if (chunkingFile_.is_open()) {
-        chunkingFile_.close();
+    chunkingPath_ = path;
+    if (chunkerType_ == FIXED_SIZE_CHUNKING || chunkerType_ == FAST_CDC) {
+        inputFile_ = new MappedFile(path);
+        return ;
     }
 
-    chunkingFile_.open(path, ios_base::in | ios::binary);
-    if (!chunkingFile_.is_open()) {
+    // the trace: use the pre-parsed one if it is up to date
+    struct stat traceStat;
+    if (stat(path.c_str(), &traceStat) != 0) {
         tool::Logging(myName_.c_str(), "open file: %s error.\n", 
             path.c_str());
         exit(EXIT_FAILURE);
     }
+    string binPath = path + TRACE_BIN_SUFFIX;
+    if (!this->LoadBinaryTrace(binPath, traceStat)) {
+        this->ParseTrace(path, binPath, traceStat);
+    }
     return ;
 }
 
@@ -209,55 +204,21 @@ void Chunker::LoadChunkFile(string path) {
  */
 void Chunker::fixSizeChunking() {
     uint64_t chunkIDCnt = 0;
-    memset(chunkBuffer_, 0, sizeof(uint8_t) * avgChunkSize_);
     uint64_t fileSize = 0;
-    bool end = false;
+    uint8_t* fileData = inputFile_->GetData();
+    uint64_t fileLen = inputFile_->GetSize();
 
-    // start chunking
-    while(!end) {
-        memset((char*)waitingForChunkingBuffer_, 0, sizeof(uint8_t) * readSize_);
-        chunkingFile_.read((char*)waitingForChunkingBuffer_, sizeof(uint8_t) * readSize_);
-        end = chunkingFile_.eof();
-        size_t len = chunkingFile_.gcount();
-        size_t chunkedSize = 0;
-        if (len == 0) {
-            break;
-        }
+    // start chunking, the tail of each read window is a short chunk
+    for (uint64_t windowOffset = 0; windowOffset < fileLen; windowOffset += readSize_) {
+        inputFile_->WillNeed(windowOffset + readSize_, readSize_);
+        uint64_t len = std::min(readSize_, fileLen - windowOffset);
         fileSize += len;
-        
-        size_t remainSize = len;
+
+        uint64_t chunkedSize = 0;
         while (chunkedSize < len) {
-            Data_t tempChunk;
-            memset(chunkBuffer_, 0, sizeof(uint8_t) * avgChunkSize_);
-            if (remainSize > avgChunkSize_) {
-                // direct copy avgChunkSize
-                memcpy(chunkBuffer_, waitingForChunkingBuffer_ + chunkedSize,
-                    avgChunkSize_);
-                tempChunk.chunk.chunkSize = avgChunkSize_;
-                memcpy(tempChunk.chunk.data, chunkBuffer_, avgChunkSize_);
-                chunkedSize += avgChunkSize_;
-                remainSize -= avgChunkSize_;
-            } else {
-                // copy the tail chunk
-                memcpy(chunkBuffer_, waitingForChunkingBuffer_ + chunkedSize,
-                    remainSize);
-                tempChunk.chunk.chunkSize = remainSize;
-                memcpy(tempChunk.chunk.data, chunkBuffer_, remainSize);
-                chunkedSize += remainSize;
-                remainSize -= remainSize;
-            }
-            tempChunk.dataType = DATA_CHUNK;
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&sTimeMQ, NULL);
-#endif
-            if (!outputMQ_->Push(tempChunk)) {
-                tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-                exit(EXIT_FAILURE);
-            }
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&eTimeMQ, NULL);
-            insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
+            uint32_t size = std::min(len - chunkedSize, avgChunkSize_);
+            this->InsertChunk(fileData + windowOffset + chunkedSize, size);
+            chunkedSize += size;
             chunkIDCnt++;
         }
     }
@@ -276,70 +237,29 @@ void Chunker::fixSizeChunking() {
 }
 
 /**
- * @brief FSL trace-driven chunking
+ * @brief FSL/UBC trace-driven chunking, replay the pre-parsed trace records
  * 
  */
-void Chunker::FSLChunking() {
+void Chunker::TraceChunking() {
     uint64_t chunkIDCnt = 0;
     uint64_t fileSize = 0;
-    char readBuffer[256]; // suppose read size <= 256 bytes
-    string readLineStr;
-
-    normal_distribution<double> distribution(avgCompressRatio_, stdCompressRatio_);
-    double compressionRatio = 0;
     gettimeofday(&sTimeChunking, NULL);
 
     // start chunking
-    while (true) {
-        // read the fingerprint recipe
-        getline(chunkingFile_, readLineStr);
-        if (readLineStr.size() == 0) {
-            break;
-        }
-        if (chunkingFile_.eof()) {
-            break;
-        }
-        memset(readBuffer, 0, 256);
-        memcpy(readBuffer, readLineStr.c_str(), readLineStr.length());
-
-        uint8_t chunkFp[7];
-        memset(chunkFp, 0, 7);
-        char* item;
-        item = strtok(readBuffer, ":\t\n ");
-        for (size_t index = 0; item != NULL && index < 6; index++) {
-            chunkFp[index] = strtol(item, NULL, 16);
-            item = strtok(NULL, ":\t\n ");
-        }
-        chunkFp[6] = '\0';
-
-        // get the size of this chunk
-        uint32_t size = atoi(item);
-        memset(chunkBuffer_, 0, sizeof(uint8_t) * maxChunkSize_);
+    for (uint64_t i = 0; i < traceRecordNum_; i++) {
+        const TraceRecord_t* record = &traceRecordList_[i];
+        uint32_t size = record->size;
         if (size > maxChunkSize_) {
             size = maxChunkSize_;
         }
 
-        // compute the fp seed
-        uint64_t seed = 0;
-        memcpy(&seed, chunkFp, 6);
-        
-        // compte the compression ratio
-        default_random_engine shuffler(seed);
-        distribution.reset();
-        compressionRatio = distribution(shuffler);
-        if (compressionRatio <= 1) {
-            // ensure the data is compressible
-            compressionRatio += 1;
-        }
-        uint32_t compressionInt = static_cast<uint32_t>(round(compressionRatio / 0.1));
-
-        // generate the chunk
-        compressGenObj_->GenerateChunkFromCanditdateSet(chunkBuffer_, compressionInt, size);
-        memcpy(chunkBuffer_, chunkFp, 6);
-
+        // generate the chunk in the chunk buffer
         Data_t tempChunk;
+        tempChunk.chunk.data = chunkPoolObj_->Acquire();
         tempChunk.chunk.chunkSize = size;
-        memcpy(tempChunk.chunk.data, chunkBuffer_, size);
+        compressGenObj_->GenerateChunkFromCanditdateSet(tempChunk.chunk.data, 
+            record->compressionInt, size);
+        memcpy(tempChunk.chunk.data, record->chunkFp, traceFpSize_);
         tempChunk.dataType = DATA_CHUNK;
 
 #if (CHUNKING_BREAKDOWN == 1)
@@ -356,7 +276,6 @@ void Chunker::FSLChunking() {
         
         chunkIDCnt++;
         fileSize += size;
-        memset(chunkBuffer_, 0, MAX_CHUNK_SIZE);
     }
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
@@ -375,86 +294,177 @@ void Chunker::FSLChunking() {
 }
 
 /**
- * @brief UBC trace-driven chunking
+ * @brief load the pre-parsed (binary) trace if it matches the text trace
  * 
+ * @param binPath the path of the binary trace
+ * @param traceStat the stat of the text trace
+ * @return true the binary trace is loaded
+ * @return false the binary trace is missing or stale
  */
-void Chunker::UBCChunking() {
-    uint64_t chunkIDCnt = 0;
-    uint64_t fileSize = 0;
+bool Chunker::LoadBinaryTrace(string binPath, const struct stat& traceStat) {
+    struct stat binStat;
+    if (stat(binPath.c_str(), &binStat) != 0 || 
+        static_cast<uint64_t>(binStat.st_size) < sizeof(TraceHead_t)) {
+        return false;
+    }
+
+    MappedFile* binFile = new MappedFile(binPath);
+    TraceHead_t* traceHead = (TraceHead_t*)binFile->GetData();
+    TraceHead_t expectHead;
+    this->FillTraceHead(traceStat, expectHead);
+    // a regenerated trace of fixed-width records can keep its size, check its mtime too
+    if (traceHead->magic != expectHead.magic || traceHead->traceType != expectHead.traceType ||
+        traceHead->traceSize != expectHead.traceSize ||
+        traceHead->traceMtimeSec != expectHead.traceMtimeSec ||
+        traceHead->traceMtimeNsec != expectHead.traceMtimeNsec ||
+        traceHead->avgCompressRatio != expectHead.avgCompressRatio ||
+        traceHead->stdCompressRatio != expectHead.stdCompressRatio ||
+        binFile->GetSize() != sizeof(TraceHead_t) + 
+        traceHead->recordNum * sizeof(TraceRecord_t)) {
+        tool::Logging(myName_.c_str(), "the binary trace %s is stale, parse the text trace.\n",
+            binPath.c_str());
+        delete binFile;
+        return false;
+    }
+
+    inputFile_ = binFile;
+    traceRecordList_ = (const TraceRecord_t*)(binFile->GetData() + sizeof(TraceHead_t));
+    traceRecordNum_ = traceHead->recordNum;
+    tool::Logging(myName_.c_str(), "load the binary trace: %s, record num: %lu\n",
+        binPath.c_str(), traceRecordNum_);
+    return true;
+}
+
+/**
+ * @brief fill the head of the binary trace of the current text trace and config
+ * 
+ * @param traceStat the stat of the text trace
+ * @param traceHead the head (without the record num) <return>
+ */
+void Chunker::FillTraceHead(const struct stat& traceStat, TraceHead_t& traceHead) {
+    memset(&traceHead, 0, sizeof(TraceHead_t));
+    traceHead.magic = TRACE_BIN_MAGIC;
+    traceHead.traceType = chunkerType_;
+    traceHead.traceSize = traceStat.st_size;
+    traceHead.traceMtimeSec = traceStat.st_mtim.tv_sec;
+    traceHead.traceMtimeNsec = traceStat.st_mtim.tv_nsec;
+    traceHead.avgCompressRatio = avgCompressRatio_;
+    traceHead.stdCompressRatio = stdCompressRatio_;
+    return ;
+}
+
+/**
+ * @brief parse the text trace, and save the records as the binary trace for the next runs
+ * 
+ * @param path the path of the text trace
+ * @param binPath the path of the binary trace
+ * @param traceStat the stat of the text trace
+ */
+void Chunker::ParseTrace(string path, string binPath, const struct stat& traceStat) {
+    ifstream traceFile;
+    traceFile.open(path, ios_base::in | ios::binary);
+    if (!traceFile.is_open()) {
+        tool::Logging(myName_.c_str(), "open file: %s error.\n", 
+            path.c_str());
+        exit(EXIT_FAILURE);
+    }
+
     char readBuffer[256]; // suppose read size <= 256 bytes
     string readLineStr;
-
-    normal_distribution<double> distribution(avgCompressRatio_, stdCompressRatio_); 
+    normal_distribution<double> distribution(avgCompressRatio_, stdCompressRatio_);
     double compressionRatio = 0;
-    gettimeofday(&sTimeChunking, NULL);
-
-    // start chunking
+    TraceRecord_t record;
+    parsedTrace_.clear();
     while (true) {
         // read the fingerprint recipe
-        getline(chunkingFile_, readLineStr);
+        getline(traceFile, readLineStr);
         if (readLineStr.size() == 0) {
             break;
         }
-        if (chunkingFile_.eof()) {
+        if (traceFile.eof()) {
             break;
         }
         memset(readBuffer, 0, 256);
-        memcpy(readBuffer, readLineStr.c_str(), readLineStr.length());
+        memcpy(readBuffer, readLineStr.c_str(), std::min(readLineStr.length(), 
+            sizeof(readBuffer) - 1));
 
-        uint8_t chunkFp[6];
-        memset(chunkFp, 0, 6);
+        memset(&record, 0, sizeof(TraceRecord_t));
         char* item;
         item = strtok(readBuffer, ":\t\n ");
-        for (size_t index = 0; item != NULL && index < 5; index++) {
-            chunkFp[index] = strtol(item, NULL, 16);
+        for (size_t index = 0; item != NULL && index < traceFpSize_; index++) {
+            record.chunkFp[index] = strtol(item, NULL, 16);
             item = strtok(NULL, ":\t\n ");
         }
-        chunkFp[5] = '\0';
 
         // get the size of this chunk
-        uint32_t size = atoi(item);
-        memset(chunkBuffer_, 0, sizeof(uint8_t) * maxChunkSize_);
-        if (size > maxChunkSize_) {
-            size = maxChunkSize_;
-        }
+        record.size = atoi(item);
 
         // compute the fp seed
         uint64_t seed = 0;
-        memcpy(&seed, chunkFp, 5);
+        memcpy(&seed, record.chunkFp, traceFpSize_);
 
         // compute the compression ratio
         default_random_engine shuffler(seed);
         distribution.reset();
         compressionRatio = distribution(shuffler);
-        if (compressionRatio < 1) {
+        if ((chunkerType_ == FSL_TRACE && compressionRatio <= 1) ||
+            (chunkerType_ == UBC_TRACE && compressionRatio < 1)) {
             // ensure the data is compressible
             compressionRatio += 1;
         }
-        uint32_t compressionInt = static_cast<uint32_t>(round(compressionRatio / 0.1));
-
-        // generate the chunk
-        compressGenObj_->GenerateChunkFromCanditdateSet(chunkBuffer_, compressionInt, size);
-        memcpy(chunkBuffer_, chunkFp, 5);
+        record.compressionInt = static_cast<uint32_t>(round(compressionRatio / 0.1));
+        parsedTrace_.push_back(record);
+    }
+    traceFile.close();
+    traceRecordList_ = parsedTrace_.data();
+    traceRecordNum_ = parsedTrace_.size();
+    tool::Logging(myName_.c_str(), "parse the text trace: %s, record num: %lu\n",
+        path.c_str(), traceRecordNum_);
+
+    // save the binary trace, write a temp file and rename it to never leave a partial one
+    TraceHead_t traceHead;
+    this->FillTraceHead(traceStat, traceHead);
+    traceHead.recordNum = traceRecordNum_;
+    string tmpPath = binPath + ".tmp";
+    ofstream binFile;
+    binFile.open(tmpPath, ios_base::out | ios_base::trunc | ios::binary);
+    if (binFile.is_open()) {
+        binFile.write((char*)&traceHead, sizeof(TraceHead_t));
+        binFile.write((char*)parsedTrace_.data(), traceRecordNum_ * sizeof(TraceRecord_t));
+        binFile.close();
+        if (!binFile.fail() && rename(tmpPath.c_str(), binPath.c_str()) == 0) {
+            return ;
+        }
+        remove(tmpPath.c_str());
+    }
+    tool::Logging(myName_.c_str(), "cannot save the binary trace: %s\n", binPath.c_str());
+    return ;
+}
 
-        Data_t tempChunk;
-        tempChunk.chunk.chunkSize = size;
-        memcpy(tempChunk.chunk.data, chunkBuffer_, size);
-        tempChunk.dataType = DATA_CHUNK;
+/**
+ * @brief use FastCDC to do the chunking 
+ * 
+ */
+void Chunker::FastCDC() {
+    uint64_t fileSize = 0;
+    uint64_t chunkIDCnt = 0;
+    uint8_t* fileData = inputFile_->GetData();
+    uint64_t fileLen = inputFile_->GetSize();
+    uint64_t offset = 0;
+    uint64_t readAheadOffset = 0;
+    gettimeofday(&sTimeChunking, NULL);
 
-#if (CHUNKING_BREAKDOWN == 1)
-        gettimeofday(&sTimeMQ, NULL);
-#endif
-        if (!outputMQ_->Push(tempChunk)) {
-            tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-            exit(EXIT_FAILURE);
+    while (offset < fileLen) {
+        if (offset + readSize_ > readAheadOffset) {
+            // keep one read window ahead
+            inputFile_->WillNeed(readAheadOffset, readSize_);
+            readAheadOffset += readSize_;
         }
-#if (CHUNKING_BREAKDOWN == 1)
-        gettimeofday(&eTimeMQ, NULL);
-        insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
-        
+        uint32_t cp = CutPoint(fileData + offset, std::min(fileLen - offset, maxChunkSize_));
+        this->InsertChunk(fileData + offset, cp);
+        offset += cp;
+        fileSize += cp;
         chunkIDCnt++;
-        fileSize += size;
     }
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
@@ -473,51 +483,93 @@ void Chunker::UBCChunking() {
 }
 
 /**
- * @brief use FastCDC to do the chunking 
+ * @brief use FastCDC to do the chunking with multiple threads, the segments are
+ * chunked in parallel and merged in order, the chunks are the same as FastCDC()
  * 
  */
-void Chunker::FastCDC() {
+void Chunker::ParallelFastCDC() {
     uint64_t fileSize = 0;
     uint64_t chunkIDCnt = 0;
-    size_t totalOffset = 0;
-    bool end = false;
     gettimeofday(&sTimeChunking, NULL);
 
-    while (!end) {
-        memset((char*)waitingForChunkingBuffer_, 0, sizeof(uint8_t) * readSize_);
-        chunkingFile_.read((char*)waitingForChunkingBuffer_, sizeof(uint8_t) * readSize_);
-        end = chunkingFile_.eof();
-        size_t len = chunkingFile_.gcount();
-        if (len == 0) {
-            break;
-        }
-        size_t localOffset = 0;
-        while (((len - localOffset) >= maxChunkSize_) || (end && (localOffset < len))) {
-            uint32_t cp = CutPoint(waitingForChunkingBuffer_ + localOffset, len - localOffset);
-            Data_t tempChunk;
-            tempChunk.chunk.chunkSize = cp;
-            memcpy(tempChunk.chunk.data, waitingForChunkingBuffer_ + localOffset, cp);
-            tempChunk.dataType = DATA_CHUNK;
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&sTimeMQ, NULL);
-#endif
-            if (!outputMQ_->Push(tempChunk)) {
-                tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
-                exit(EXIT_FAILURE);
+    segmentNum_ = (inputFile_->GetSize() + segmentSize_ - 1) / segmentSize_;
+    nextSegment_ = 0;
+    mergedSegment_ = 0;
+
+    // two in-flight segments per thread, the threads go on while a segment is merged
+    segmentList_.resize(chunkingThreadNum_ * 2);
+    for (auto& segment : segmentList_) {
+        segment.ready = false;
+    }
+    vector<boost::thread*> thList;
+    for (size_t i = 0; i < chunkingThreadNum_; i++) {
+        thList.push_back(new boost::thread(boost::bind(&Chunker::SegmentChunking, this)));
+    }
+
+    // the end offset of the last merged chunk
+    uint64_t pos = 0;
+    for (uint64_t segmentID = 0; segmentID < segmentNum_; segmentID++) {
+        ChunkingSegment_t& segment = segmentList_[segmentID % segmentList_.size()];
+        {
+            boost::mutex::scoped_lock lock(segmentLck_);
+            while (!segment.ready) {
+                segmentCond_.wait(lock);
             }
-#if (CHUNKING_BREAKDOWN == 1)
-            gettimeofday(&eTimeMQ, NULL);
-            insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
-#endif
-            localOffset += cp;
+        }
+
+        // the last chunk of the previous segment ends in the first max chunk size of this
+        // segment, as a chunk only depends on its start offset, the speculative cut points
+        // are the same as the sequential ones after the first common cut point
+        uint64_t localPos = pos - segment.offset;
+        auto cutIter = std::lower_bound(segment.cutList.begin(), segment.cutList.end(),
+            localPos);
+        bool sync = (localPos == 0);
+        if (cutIter != segment.cutList.end() && *cutIter == localPos) {
+            sync = true;
+            cutIter++;
+        }
+        while (!sync && localPos < segment.size) {
+            // re-chunk the seam from the last cut point
+            uint32_t cp = CutPoint(segment.buffer + localPos, 
+                std::min(segment.bufferSize - localPos, maxChunkSize_));
+            this->InsertChunk(segment.buffer + localPos, cp);
+            localPos += cp;
             fileSize += cp;
             chunkIDCnt++;
+            seamChunkNum_++;
+            while (cutIter != segment.cutList.end() && *cutIter < localPos) {
+                cutIter++;
+            }
+            if (cutIter != segment.cutList.end() && *cutIter == localPos) {
+                sync = true;
+                cutIter++;
+            }
         }
-        pos_ += localOffset;
-        totalOffset += localOffset;
-    
-        chunkingFile_.seekg(totalOffset, std::ios_base::beg);
+        if (sync) {
+            for (; cutIter != segment.cutList.end(); cutIter++) {
+                uint32_t cp = *cutIter - localPos;
+                this->InsertChunk(segment.buffer + localPos, cp);
+                localPos += cp;
+                fileSize += cp;
+                chunkIDCnt++;
+            }
+        }
+        pos = segment.offset + localPos;
+
+        {
+            boost::mutex::scoped_lock lock(segmentLck_);
+            segment.ready = false;
+            mergedSegment_++;
+        }
+        segmentCond_.notify_all();
+    }
+
+    for (auto it : thList) {
+        it->join();
+        delete it;
     }
+    segmentList_.clear();
+
     _recipe.recipeHead.totalChunkNum = chunkIDCnt;
     _recipe.recipeHead.fileSize = fileSize;
     _recipe.dataType = RECIPE_END;
@@ -534,6 +586,80 @@ void Chunker::FastCDC() {
     return ;
 }
 
+/**
+ * @brief the chunking thread of the parallel FastCDC, chunk the segments from
+ * their start offsets
+ * 
+ */
+void Chunker::SegmentChunking() {
+    uint8_t* fileData = inputFile_->GetData();
+    uint64_t fileLen = inputFile_->GetSize();
+    while (true) {
+        uint64_t segmentID;
+        {
+            boost::mutex::scoped_lock lock(segmentLck_);
+            while (nextSegment_ < segmentNum_ && 
+                nextSegment_ >= mergedSegment_ + segmentList_.size()) {
+                // wait for a free slot
+                segmentCond_.wait(lock);
+            }
+            if (nextSegment_ == segmentNum_) {
+                break;
+            }
+            segmentID = nextSegment_;
+            nextSegment_++;
+        }
+
+        ChunkingSegment_t& segment = segmentList_[segmentID % segmentList_.size()];
+        segment.offset = segmentID * segmentSize_;
+        segment.size = std::min(segmentSize_, fileLen - segment.offset);
+        segment.bufferSize = std::min(segment.size + maxChunkSize_, fileLen - segment.offset);
+        segment.buffer = fileData + segment.offset;
+        inputFile_->WillNeed(segment.offset, segment.bufferSize);
+
+        // chunk as if a chunk starts at the segment offset
+        segment.cutList.clear();
+        uint64_t localPos = 0;
+        while (localPos < segment.size) {
+            localPos += CutPoint(segment.buffer + localPos, 
+                std::min(segment.bufferSize - localPos, maxChunkSize_));
+            segment.cutList.push_back(localPos);
+        }
+
+        {
+            boost::mutex::scoped_lock lock(segmentLck_);
+            segment.ready = true;
+        }
+        segmentCond_.notify_all();
+    }
+    return ;
+}
+
+/**
+ * @brief insert a chunk of the mapped input file to the output MQ without copy
+ * 
+ * @param data the chunk data
+ * @param size the chunk size
+ */
+void Chunker::InsertChunk(uint8_t* data, uint32_t size) {
+    Data_t tempChunk;
+    tempChunk.chunk.data = data;
+    tempChunk.chunk.chunkSize = size;
+    tempChunk.dataType = DATA_CHUNK;
+#if (CHUNKING_BREAKDOWN == 1)
+    gettimeofday(&sTimeMQ, NULL);
+#endif
+    if (!outputMQ_->Push(tempChunk)) {
+        tool::Logging(myName_.c_str(), "insert chunk to output MQ error.\n");
+        exit(EXIT_FAILURE);
+    }
+#if (CHUNKING_BREAKDOWN == 1)
+    gettimeofday(&eTimeMQ, NULL);
+    insertTime_ += tool::GetTimeDiff(sTimeMQ, eTimeMQ);
+#endif
+    return ;
+}
+
 /**
  * @brief compute the normal size 
  * 
@@ -567,6 +693,55 @@ uint32_t Chunker::GenerateFastCDCMask(uint32_t bits) {
     return tmp;
 }
 
+#if defined(CDC_SIMD_AVX2)
+/**
+ * @brief advance the gear hash over a block of 32 bytes and test the mask at each byte
+ * 
+ * with g_j the gear value of the j-th byte after a known hash fp, the hash after the k-th
+ * byte is exactly (fp + sum_{j<=k} g_j * 2^(j+1)) >> (k+1), so the weighted sums do not
+ * depend on fp and the serial (fp >> 1) + g chain is broken. Each 64-bit lane walks its own
+ * 8 bytes of the block, and only the 4 lane start hashes are chained in scalar.
+ * 
+ * @param src the input bytes of the block
+ * @param fp the hash before the block <return: the hash after the block if there is no cut>
+ * @param maskVec the cut mask in each 64-bit lane
+ * @return true there is a cut point in the block, fp is unchanged
+ * @return false there is no cut point in the block
+ */
+static inline bool GearBlock(const uint8_t* src, uint32_t& fp, __m256i maskVec) {
+    const uint32_t laneSize = CDC_SIMD_BLOCK_SIZE / 4;
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sumList[laneSize];
+    __m256i sum = zero;
+    for (uint32_t k = 0; k < laneSize; k++) {
+        __m256i gearVec = _mm256_set_epi64x(GEAR[src[3 * laneSize + k]],
+            GEAR[src[2 * laneSize + k]], GEAR[src[laneSize + k]], GEAR[src[k]]);
+        sum = _mm256_add_epi64(sum, _mm256_slli_epi64(gearVec, k + 1));
+        sumList[k] = sum;
+    }
+
+    // chain the start hash of each lane
+    uint64_t laneSum[4];
+    _mm256_storeu_si256((__m256i*)laneSum, sum);
+    uint64_t fp0 = fp;
+    uint64_t fp1 = (fp0 + laneSum[0]) >> laneSize;
+    uint64_t fp2 = (fp1 + laneSum[1]) >> laneSize;
+    uint64_t fp3 = (fp2 + laneSum[2]) >> laneSize;
+    __m256i fpVec = _mm256_set_epi64x(fp3, fp2, fp1, fp0);
+
+    __m256i hit = zero;
+    for (uint32_t k = 0; k < laneSize; k++) {
+        __m256i hash = _mm256_srli_epi64(_mm256_add_epi64(sumList[k], fpVec), k + 1);
+        hit = _mm256_or_si256(hit, _mm256_cmpeq_epi64(_mm256_and_si256(hash, maskVec), zero));
+    }
+    if (!_mm256_testz_si256(hit, hit)) {
+        return true;
+    }
+    fp = (fp3 + laneSum[3]) >> laneSize;
+    return false;
+}
+#endif
+
 /**
  * @brief To get the offset of chunks for a given buffer  
  * 
@@ -578,8 +753,18 @@ uint32_t Chunker::CutPoint(const uint8_t* src, const uint32_t len) {
     uint32_t n;
     uint32_t fp = 0;
     uint32_t i;
+    // the bytes before the min chunk size can never be a cut point, skip them without hashing
     i = std::min(len, static_cast<uint32_t>(minChunkSize_)); 
     n = std::min(normalSize_, len);
+#if defined(CDC_SIMD_AVX2)
+    __m256i maskVec = _mm256_set1_epi64x(maskS_);
+    for (; i + CDC_SIMD_BLOCK_SIZE <= n; i += CDC_SIMD_BLOCK_SIZE) {
+        if (GearBlock(src + i, fp, maskVec)) {
+            // locate the cut point in this block byte by byte
+            break;
+        }
+    }
+#endif
     for (; i < n; i++) {
         fp = (fp >> 1) + GEAR[src[i]];
         if (!(fp & maskS_)) {
@@ -588,6 +773,15 @@ uint32_t Chunker::CutPoint(const uint8_t* src, const uint32_t len) {
     }
 
     n = std::min(static_cast<uint32_t>(maxChunkSize_), len);
+#if defined(CDC_SIMD_AVX2)
+    maskVec = _mm256_set1_epi64x(maskL_);
+    for (; i + CDC_SIMD_BLOCK_SIZE <= n; i += CDC_SIMD_BLOCK_SIZE) {
+        if (GearBlock(src + i, fp, maskVec)) {
+            // locate the cut point in this block byte by byte
+            break;
+        }
+    }
+#endif
     for (; i < n; i++) {
         fp = (fp >> 1) + GEAR[src[i]];
         if (!(fp & maskL_)) {
@@ -20,6 +20,8 @@ DataSender::DataSender(SSLConnection* dataSecureChannel) {
     // set up the configuration
     clientID_ = config.GetClientID();
     sendChunkBatchSize_ = config.GetSendChunkBatchSize();
+    fpPrefilter_ = config.GetFpPrefilter();
+    transCompress_ = config.GetTransCompress();
     dataSecureChannel_ = dataSecureChannel;
     
     // init the send chunk buffer: header + <chunkSize, chunk content>
@@ -39,6 +41,13 @@ DataSender::DataSender(SSLConnection* dataSecureChannel) {
     sendEncBuffer_.header->dataSize = 0;
     sendEncBuffer_.dataBuffer = sendEncBuffer_.sendBuffer + sizeof(NetworkHead_t);
 
+    if (fpPrefilter_) {
+        fpBuffer_ = (uint8_t*) malloc(sendChunkBatchSize_ * CHUNK_HASH_SIZE);
+    }
+    if (transCompress_ != TRANS_COMPRESS_NONE) {
+        compBuffer_ = (uint8_t*) malloc(sendChunkBatchSize_ * sizeof(Chunk_t));
+    }
+
     // prepare the crypto tool
     cryptoObj_ = new CryptoPrimitive(CIPHER_TYPE, HASH_TYPE);
     cipherCtx_ = EVP_CIPHER_CTX_new();
@@ -53,11 +62,25 @@ DataSender::DataSender(SSLConnection* dataSecureChannel) {
 DataSender::~DataSender() {
     free(sendEncBuffer_.sendBuffer);
     free(sendChunkBuf_.sendBuffer);
+    if (fpBuffer_ != NULL) {
+        free(fpBuffer_);
+    }
+    if (compBuffer_ != NULL) {
+        free(compBuffer_);
+    }
     EVP_CIPHER_CTX_free(cipherCtx_);
     EVP_MD_CTX_free(mdCtx_);
     delete cryptoObj_;
     fprintf(stderr, "========DataSender Info========\n");
     fprintf(stderr, "total send batch num: %lu\n", batchNum_);
+    if (fpPrefilter_) {
+        fprintf(stderr, "pre-filtered chunk num: %lu\n", prefilterChunkNum_);
+        fprintf(stderr, "pre-filtered data size: %lu\n", prefilterDataSize_);
+    }
+    if (transCompress_ != TRANS_COMPRESS_NONE) {
+        fprintf(stderr, "trans-compressed chunk num: %lu\n", transCompressChunkNum_);
+        fprintf(stderr, "trans-compression saved size: %lu\n", transSaveSize_);
+    }
     fprintf(stderr, "total thread running time: %lf\n", totalTime_);
     fprintf(stderr, "===============================\n");
 }
@@ -74,10 +97,11 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash, int OPT_
     cryptoObj_->GenerateHash(mdCtx_, (uint8_t*)&localSecret[0], localSecret.size(),
         masterKey);
 
-    // header + fileNameHash + Enc(masterKey)
+    // header + fileNameHash + Enc(masterKey) + the requested transport compression
+    // + the requested fingerprint pre-filter
     SendMsgBuffer_t msgBuf;
     msgBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + 
-        CHUNK_HASH_SIZE + CHUNK_HASH_SIZE);
+        CHUNK_HASH_SIZE + CHUNK_HASH_SIZE + 2 * sizeof(uint32_t));
     msgBuf.header = (NetworkHead_t*) msgBuf.sendBuffer;
     msgBuf.header->clientID = clientID_;
     msgBuf.header->dataSize = 0;
@@ -94,6 +118,14 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash, int OPT_
     cryptoObj_->SessionKeyEnc(cipherCtx_, masterKey, CHUNK_HASH_SIZE, 
         sessionKey_, msgBuf.dataBuffer + CHUNK_HASH_SIZE);
     msgBuf.header->dataSize += CHUNK_HASH_SIZE;
+    uint32_t transCompress = transCompress_;
+    memcpy(msgBuf.dataBuffer + msgBuf.header->dataSize, &transCompress,
+        sizeof(uint32_t));
+    msgBuf.header->dataSize += sizeof(uint32_t);
+    uint32_t fpPrefilter = (fpPrefilter_ != 0) ? 1 : 0;
+    memcpy(msgBuf.dataBuffer + msgBuf.header->dataSize, &fpPrefilter,
+        sizeof(uint32_t));
+    msgBuf.header->dataSize += sizeof(uint32_t);
 
     // send the upload login request
     if (!dataSecureChannel_->SendData(conChannelRecord_.second, 
@@ -118,6 +150,29 @@ void DataSender::UploadLogin(string localSecret, uint8_t* fileNameHash, int OPT_
         exit(EXIT_FAILURE);
     }
 
+    // the server replies the accepted transport compression
+    transCompress = TRANS_COMPRESS_NONE;
+    if (msgBuf.header->dataSize >= sizeof(uint32_t)) {
+        memcpy(&transCompress, msgBuf.dataBuffer, sizeof(uint32_t));
+    }
+    if (transCompress != transCompress_) {
+        tool::Logging(myName_.c_str(), "the server does not accept the transport "
+            "compression, send the raw chunks.\n");
+        transCompress_ = transCompress;
+    }
+
+    // the server replies whether it accepts the fingerprint pre-filter (an older server
+    // does not reply it, and cannot answer the fingerprint batches)
+    fpPrefilter = 0;
+    if (msgBuf.header->dataSize >= 2 * sizeof(uint32_t)) {
+        memcpy(&fpPrefilter, msgBuf.dataBuffer + sizeof(uint32_t), sizeof(uint32_t));
+    }
+    if (fpPrefilter_ && fpPrefilter == 0) {
+        tool::Logging(myName_.c_str(), "the server does not accept the fingerprint "
+            "pre-filter, send every chunk body.\n");
+        fpPrefilter_ = 0;
+    }
+
     free(msgBuf.sendBuffer);
     return ;
 }
@@ -140,7 +195,7 @@ void DataSender::Run() {
             jobDoneFlag = true;
         }
 
-        if (inputMQ_->Pop(tmpChunk)) {
+        if (inputMQ_->PopWait(tmpChunk)) {
             switch (tmpChunk.dataType) {
                 case DATA_CHUNK: {
                     // this is a normal chunk
@@ -198,11 +253,16 @@ void DataSender::ProcessRecipeEnd(FileRecipeHead_t& recipeHead) {
 }
 
 /**
- * @brief process a chunk
+ * @brief process a chunk, and release its buffer to the chunk pool
  * 
  * @param inputChunk the input chunk
  */
-void DataSender::ProcessChunk(Chunk_t& inputChunk) {
+void DataSender::ProcessChunk(ChunkRef_t& inputChunk) {
+    if (fpPrefilter_) {
+        cryptoObj_->GenerateHash(mdCtx_, inputChunk.data, inputChunk.chunkSize,
+            fpBuffer_ + sendChunkBuf_.header->currentItemNum * CHUNK_HASH_SIZE);
+    }
+
     // update the send chunk buffer
     memcpy(sendChunkBuf_.dataBuffer + sendChunkBuf_.header->dataSize,
         &inputChunk.chunkSize, sizeof(uint32_t));
@@ -211,6 +271,7 @@ void DataSender::ProcessChunk(Chunk_t& inputChunk) {
         inputChunk.data, inputChunk.chunkSize);
     sendChunkBuf_.header->dataSize += inputChunk.chunkSize;
     sendChunkBuf_.header->currentItemNum++;
+    chunkPoolObj_->Release(inputChunk.data);
 
     if (sendChunkBuf_.header->currentItemNum % sendChunkBatchSize_ == 0) {
         this->SendChunks();
@@ -224,10 +285,18 @@ void DataSender::ProcessChunk(Chunk_t& inputChunk) {
  * @param chunkBuffer the chunk buffer
  */
 void DataSender::SendChunks() {
+    if (fpPrefilter_) {
+        this->PrefilterChunks();
+    }
     sendChunkBuf_.header->messageType = CLIENT_UPLOAD_CHUNK;
+    uint8_t* payload = sendChunkBuf_.dataBuffer;
+    if (transCompress_ == TRANS_COMPRESS_LZ4) {
+        this->CompressChunks();
+        payload = compBuffer_;
+    }
 
     // encrypt the payload with the session key
-    cryptoObj_->SessionKeyEnc(cipherCtx_, sendChunkBuf_.dataBuffer,
+    cryptoObj_->SessionKeyEnc(cipherCtx_, payload,
         sendChunkBuf_.header->dataSize, sessionKey_,
         sendEncBuffer_.dataBuffer);
 
@@ -247,4 +316,122 @@ void DataSender::SendChunks() {
     batchNum_++;
 
     return ;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief query the fingerprints of the send chunk buffer, and replace the body of
+ * each duplicate chunk with its fingerprint
+ * 
+ */
+void DataSender::PrefilterChunks() {
+    uint32_t chunkNum = sendChunkBuf_.header->currentItemNum;
+
+    // send the fingerprint batch (encrypted with the session key)
+    sendEncBuffer_.header->messageType = CLIENT_UPLOAD_FP;
+    sendEncBuffer_.header->clientID = clientID_;
+    sendEncBuffer_.header->currentItemNum = chunkNum;
+    sendEncBuffer_.header->dataSize = chunkNum * CHUNK_HASH_SIZE;
+    cryptoObj_->SessionKeyEnc(cipherCtx_, fpBuffer_, sendEncBuffer_.header->dataSize,
+        sessionKey_, sendEncBuffer_.dataBuffer);
+    if (!dataSecureChannel_->SendData(conChannelRecord_.second, 
+        sendEncBuffer_.sendBuffer, 
+        sizeof(NetworkHead_t) + sendEncBuffer_.header->dataSize)) {
+        tool::Logging(myName_.c_str(), "send the fingerprint batch error.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // wait the duplicate bitmap
+    uint32_t recvSize = 0;
+    uint32_t bitmapSize = (chunkNum + 7) / 8;
+    if (!dataSecureChannel_->ReceiveData(conChannelRecord_.second, 
+        sendEncBuffer_.sendBuffer, recvSize)) {
+        tool::Logging(myName_.c_str(), "recv the fingerprint bitmap error.\n");
+        exit(EXIT_FAILURE);
+    }
+    if (sendEncBuffer_.header->messageType != SERVER_FP_BITMAP ||
+        sendEncBuffer_.header->dataSize != bitmapSize) {
+        tool::Logging(myName_.c_str(), "wrong fingerprint bitmap.\n");
+        exit(EXIT_FAILURE);
+    }
+    vector<uint8_t> bitmap(bitmapSize);
+    cryptoObj_->SessionKeyDec(cipherCtx_, sendEncBuffer_.dataBuffer, bitmapSize,
+        sessionKey_, bitmap.data());
+
+    // compact the send chunk buffer in place: <chunkSize | CHUNK_FP_ONLY_FLAG, fp> for
+    // a duplicate chunk, a chunk not larger than its fp is still sent as it is
+    uint8_t* dataBuffer = sendChunkBuf_.dataBuffer;
+    uint32_t readOffset = 0;
+    uint32_t writeOffset = 0;
+    uint32_t chunkSize;
+    uint32_t fpOnlySize;
+    for (size_t i = 0; i < chunkNum; i++) {
+        memcpy(&chunkSize, dataBuffer + readOffset, sizeof(uint32_t));
+        if ((bitmap[i / 8] & (1 << (i % 8))) && chunkSize > CHUNK_HASH_SIZE) {
+            fpOnlySize = chunkSize | CHUNK_FP_ONLY_FLAG;
+            memcpy(dataBuffer + writeOffset, &fpOnlySize, sizeof(uint32_t));
+            memcpy(dataBuffer + writeOffset + sizeof(uint32_t),
+                fpBuffer_ + i * CHUNK_HASH_SIZE, CHUNK_HASH_SIZE);
+            writeOffset += sizeof(uint32_t) + CHUNK_HASH_SIZE;
+            prefilterChunkNum_++;
+            prefilterDataSize_ += chunkSize;
+        } else {
+            if (writeOffset != readOffset) {
+                memmove(dataBuffer + writeOffset, dataBuffer + readOffset,
+                    sizeof(uint32_t) + chunkSize);
+            }
+            writeOffset += sizeof(uint32_t) + chunkSize;
+        }
+        readOffset += sizeof(uint32_t) + chunkSize;
+    }
+    sendChunkBuf_.header->dataSize = writeOffset;
+    return ;
+}
+
+/**
+ * @brief compress each chunk body of the send chunk buffer to the compressed buffer
+ * 
+ */
+void DataSender::CompressChunks() {
+    uint32_t chunkNum = sendChunkBuf_.header->currentItemNum;
+    uint8_t* dataBuffer = sendChunkBuf_.dataBuffer;
+    uint32_t readOffset = 0;
+    uint32_t writeOffset = 0;
+    uint32_t chunkSize;
+    uint32_t bodySize;
+    int compressedSize;
+    for (size_t i = 0; i < chunkNum; i++) {
+        memcpy(&chunkSize, dataBuffer + readOffset, sizeof(uint32_t));
+        if (chunkSize & CHUNK_FP_ONLY_FLAG) {
+            bodySize = CHUNK_HASH_SIZE;
+        } else {
+            bodySize = chunkSize;
+            // <chunkSize | CHUNK_COMPRESSED_FLAG, compressedSize, compressed chunk>, only
+            // if it is smaller than the raw chunk
+            compressedSize = 0;
+            if (chunkSize > 2 * sizeof(uint32_t)) {
+                compressedSize = LZ4_compress_fast(
+                    (char*)dataBuffer + readOffset + sizeof(uint32_t),
+                    (char*)compBuffer_ + writeOffset + 2 * sizeof(uint32_t),
+                    chunkSize, chunkSize - sizeof(uint32_t) - 1,
+                    TRANS_LZ4_ACCELERATION);
+            }
+            if (compressedSize > 0) {
+                uint32_t flagSize = chunkSize | CHUNK_COMPRESSED_FLAG;
+                memcpy(compBuffer_ + writeOffset, &flagSize, sizeof(uint32_t));
+                memcpy(compBuffer_ + writeOffset + sizeof(uint32_t), &compressedSize,
+                    sizeof(uint32_t));
+                writeOffset += 2 * sizeof(uint32_t) + compressedSize;
+                readOffset += sizeof(uint32_t) + chunkSize;
+                transCompressChunkNum_++;
+                transSaveSize_ += chunkSize - sizeof(uint32_t) - compressedSize;
+                continue;
+            }
+        }
+        memcpy(compBuffer_ + writeOffset, dataBuffer + readOffset,
+            sizeof(uint32_t) + bodySize);
+        writeOffset += sizeof(uint32_t) + bodySize;
+        readOffset += sizeof(uint32_t) + bodySize;
+    }
+    sendChunkBuf_.header->dataSize = writeOffset;
+    return ;
+}
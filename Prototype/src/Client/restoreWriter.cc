@@ -59,7 +59,7 @@ void RestoreWriter::Run() {
             jobDoneFlag = true;
         }
 
-        if (inputMQ_->Pop(newData)) {
+        if (inputMQ_->PopWait(newData)) {
 #if (RESTORE_WRITER_BREAKDOWN == 1)
             gettimeofday(&sRestoreTime_, NULL);
 #endif 
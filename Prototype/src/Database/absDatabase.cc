@@ -19,3 +19,25 @@
 AbsDatabase::AbsDatabase() {
     // fprintf(stderr, "AbsDatabase: Initial an abstract database.\n");
 }
+
+/**
+ * @brief query a batch of (CHUNK_HASH_SIZE key, sizeof(RecipeEntry_t) value) pairs
+ * 
+ * @param keys the first key, the i-th key is at keys + i * keyStride
+ * @param n the number of keys
+ * @param keyStride the distance between two keys
+ * @param values the first value, the i-th value is written to values + i * valueStride
+ * @param valueStride the distance between two values
+ * @param found the query result of each key
+ */
+void AbsDatabase::QueryBatch(const uint8_t* keys, size_t n, size_t keyStride,
+    uint8_t* values, size_t valueStride, uint8_t* found) {
+    string value;
+    for (size_t i = 0; i < n; i++) {
+        found[i] = this->QueryBuffer((const char*)keys + i * keyStride, CHUNK_HASH_SIZE, value);
+        if (found[i]) {
+            memcpy(values + i * valueStride, &value[0], min(value.size(), sizeof(RecipeEntry_t)));
+        }
+    }
+    return ;
+}
@@ -22,6 +22,10 @@ AbsDatabase* DatabaseFactory::CreateDatabase(int type, string path) {
             fprintf(stderr, "Database: using In-Memory Index.\n");
             return new InMemoryDatabase(path);
             break;
+        case FLAT_MEMORY:
+            fprintf(stderr, "Database: using Flat In-Memory Index.\n");
+            return new FlatMemoryDatabase(path);
+            break;
         default:
             break;
     }
@@ -0,0 +1,329 @@
+/**
+ * @file flatMemoryDatabase.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the interface of the in-memory index with a flat fp table
+ * @version 0.1
+ * @date 2024-03-08
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/flatMemoryDatabase.h"
+
+/**
+ * @brief Construct a new Flat Memory Database object
+ *
+ * @param dbName the path of the db file
+ */
+FlatMemoryDatabase::FlatMemoryDatabase(std::string dbName) {
+    this->AllocTable(FLAT_INIT_CAPACITY);
+    this->OpenDB(dbName);
+}
+
+/**
+ * @brief Destroy the Flat Memory Database object
+ *
+ */
+FlatMemoryDatabase::~FlatMemoryDatabase() {
+    // the sf index is persisted by InMemoryDatabase
+    this->PersistFPIndex();
+    this->FreeTable();
+}
+
+/**
+ * @brief open a database
+ *
+ * @param dbName the db path
+ * @return true success
+ * @return false fails
+ */
+bool FlatMemoryDatabase::OpenDB(std::string dbName) {
+    InMemoryDatabase::OpenDB(dbName);
+    fprintf(stderr, "%s: loaded flat FP index size: %lu, capacity: %lu\n",
+        myName_.c_str(), itemNum_, capacity_);
+    return true;
+}
+
+/**
+ * @brief allocate an empty table
+ *
+ * @param capacity the number of slots (power of 2)
+ */
+void FlatMemoryDatabase::AllocTable(uint64_t capacity) {
+    capacity_ = capacity;
+    mask_ = capacity - 1;
+    itemNum_ = 0;
+    tagArr_ = (uint8_t*)aligned_alloc(64, capacity_);
+    keyArr_ = (uint8_t*)aligned_alloc(64, capacity_ * FLAT_KEY_SIZE);
+    valueArr_ = (uint8_t*)aligned_alloc(64, capacity_ * FLAT_VALUE_SIZE);
+    if (tagArr_ == NULL || keyArr_ == NULL || valueArr_ == NULL) {
+        fprintf(stderr, "%s: cannot allocate the table with %lu slots.\n", myName_.c_str(), capacity_);
+        exit(EXIT_FAILURE);
+    }
+    memset(tagArr_, 0, capacity_);
+    return ;
+}
+
+/**
+ * @brief free the table
+ *
+ */
+void FlatMemoryDatabase::FreeTable() {
+    free(tagArr_);
+    free(keyArr_);
+    free(valueArr_);
+    tagArr_ = NULL;
+    keyArr_ = NULL;
+    valueArr_ = NULL;
+    return ;
+}
+
+/**
+ * @brief double the table and re-insert all items
+ *
+ */
+void FlatMemoryDatabase::Grow() {
+    uint8_t* oldTagArr = tagArr_;
+    uint8_t* oldKeyArr = keyArr_;
+    uint8_t* oldValueArr = valueArr_;
+    uint64_t oldCapacity = capacity_;
+
+    this->AllocTable(oldCapacity << 1);
+    uint64_t slot;
+    for (uint64_t i = 0; i < oldCapacity; i++) {
+        if (oldTagArr[i] == 0) {
+            continue;
+        }
+        const uint8_t* key = oldKeyArr + i * FLAT_KEY_SIZE;
+        uint64_t hash = tool::HashKey(key);
+        this->FindSlot(key, hash, slot);
+        tagArr_[slot] = oldTagArr[i];
+        memcpy(keyArr_ + slot * FLAT_KEY_SIZE, key, FLAT_KEY_SIZE);
+        memcpy(valueArr_ + slot * FLAT_VALUE_SIZE, oldValueArr + i * FLAT_VALUE_SIZE,
+            FLAT_VALUE_SIZE);
+        itemNum_++;
+    }
+
+    free(oldTagArr);
+    free(oldKeyArr);
+    free(oldValueArr);
+    return ;
+}
+
+/**
+ * @brief find the slot of a key
+ *
+ * @param key the key buffer
+ * @param hash the hash of the key
+ * @param slot the slot of the key, or the empty slot to insert it
+ * @return true the key exists
+ * @return false the key does not exist
+ */
+bool FlatMemoryDatabase::FindSlot(const uint8_t* key, uint64_t hash, uint64_t& slot) {
+    uint8_t tag = tool::HashTag(hash);
+    uint64_t i = hash & mask_;
+    while (tagArr_[i] != 0) {
+        if (tagArr_[i] == tag && memcmp(keyArr_ + i * FLAT_KEY_SIZE, key, FLAT_KEY_SIZE) == 0) {
+            slot = i;
+            return true;
+        }
+        i = (i + 1) & mask_;
+    }
+    slot = i;
+    return false;
+}
+
+/**
+ * @brief insert or overwrite a fixed-size item in the table
+ *
+ * @param key the key buffer (FLAT_KEY_SIZE)
+ * @param value the value buffer (FLAT_VALUE_SIZE)
+ */
+void FlatMemoryDatabase::PutItem(const uint8_t* key, const uint8_t* value) {
+    if ((itemNum_ + 1) * FLAT_LOAD_DEN > capacity_ * FLAT_LOAD_NUM) {
+        this->Grow();
+    }
+    uint64_t hash = tool::HashKey(key);
+    uint64_t slot;
+    if (!this->FindSlot(key, hash, slot)) {
+        tagArr_[slot] = tool::HashTag(hash);
+        memcpy(keyArr_ + slot * FLAT_KEY_SIZE, key, FLAT_KEY_SIZE);
+        itemNum_++;
+    }
+    memcpy(valueArr_ + slot * FLAT_VALUE_SIZE, value, FLAT_VALUE_SIZE);
+    return ;
+}
+
+/**
+ * @brief query a fixed-size item from the table
+ *
+ * @param key the key buffer (FLAT_KEY_SIZE)
+ * @return uint8_t* the value in the table, NULL if not exists
+ */
+uint8_t* FlatMemoryDatabase::GetItem(const uint8_t* key) {
+    uint64_t slot;
+    if (this->FindSlot(key, tool::HashKey(key), slot)) {
+        return valueArr_ + slot * FLAT_VALUE_SIZE;
+    }
+    return NULL;
+}
+
+/**
+ * @brief persist the fp index to the db file (same format as InMemoryDatabase)
+ *
+ */
+void FlatMemoryDatabase::PersistFPIndex() {
+    ofstream dbFile;
+    dbFile.open(dbName_, ios_base::trunc | ios_base::binary);
+    for (uint64_t i = 0; i < capacity_; i++) {
+        if (tagArr_[i] != 0) {
+            this->WriteItem(dbFile, (char*)keyArr_ + i * FLAT_KEY_SIZE, FLAT_KEY_SIZE,
+                (char*)valueArr_ + i * FLAT_VALUE_SIZE, FLAT_VALUE_SIZE);
+        }
+    }
+    for (auto it = indexObj_.begin(); it != indexObj_.end(); it++) {
+        this->WriteItem(dbFile, it->first.c_str(), it->first.size(),
+            it->second.c_str(), it->second.size());
+    }
+    dbFile.close();
+    fpIndexPersisted_ = true;
+    return ;
+}
+
+/**
+ * @brief execute query over database
+ *
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool FlatMemoryDatabase::Query(const std::string& key, std::string& value) {
+    return this->QueryBuffer(key.c_str(), key.size(), value);
+}
+
+/**
+ * @brief insert the (key, value) pair
+ *
+ * @param key key
+ * @param value value
+ * @return true success
+ * @return false fail
+ */
+bool FlatMemoryDatabase::Insert(const std::string& key, const std::string& value) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), value.c_str(), value.size());
+}
+
+/**
+ * @brief insert the (key, value) pair
+ *
+ * @param key
+ * @param buffer
+ * @param bufferSize
+ * @return true
+ * @return false
+ */
+bool FlatMemoryDatabase::InsertBuffer(const std::string& key, const char* buffer,
+    size_t bufferSize) {
+    return this->InsertBothBuffer(key.c_str(), key.size(), buffer, bufferSize);
+}
+
+/**
+ * @brief insert the (key, value) pair, the pairs that do not fit a slot go to the map
+ *
+ * @param key
+ * @param keySize
+ * @param buffer
+ * @param bufferSize
+ * @return true
+ * @return false
+ */
+bool FlatMemoryDatabase::InsertBothBuffer(const char* key, size_t keySize, const char* buffer,
+    size_t bufferSize) {
+    if (keySize == FLAT_KEY_SIZE && bufferSize == FLAT_VALUE_SIZE) {
+        this->PutItem((const uint8_t*)key, (const uint8_t*)buffer);
+        return true;
+    }
+    return InMemoryDatabase::InsertBothBuffer(key, keySize, buffer, bufferSize);
+}
+
+/**
+ * @brief query the (key, value) pair
+ *
+ * @param key
+ * @param keySize
+ * @param value
+ * @return true
+ * @return false
+ */
+bool FlatMemoryDatabase::QueryBuffer(const char* key, size_t keySize, std::string& value) {
+    if (keySize == FLAT_KEY_SIZE) {
+        uint8_t* slotValue = this->GetItem((const uint8_t*)key);
+        if (slotValue != NULL) {
+            value.assign((char*)slotValue, FLAT_VALUE_SIZE);
+            return true;
+        }
+    }
+    if (indexObj_.empty()) {
+        return false;
+    }
+    return InMemoryDatabase::QueryBuffer(key, keySize, value);
+}
+
+/**
+ * @brief query a batch of (CHUNK_HASH_SIZE key, sizeof(RecipeEntry_t) value) pairs,
+ * the slots of the following keys are prefetched
+ *
+ * @param keys the first key, the i-th key is at keys + i * keyStride
+ * @param n the number of keys
+ * @param keyStride the distance between two keys
+ * @param values the first value, the i-th value is written to values + i * valueStride
+ * @param valueStride the distance between two values
+ * @param found the query result of each key
+ */
+void FlatMemoryDatabase::QueryBatch(const uint8_t* keys, size_t n, size_t keyStride,
+    uint8_t* values, size_t valueStride, uint8_t* found) {
+    uint64_t slot;
+    // warm up the first slots
+    for (size_t i = 0; i < min(n, FLAT_PREFETCH_DIST); i++) {
+        slot = tool::HashKey(keys + i * keyStride) & mask_;
+        __builtin_prefetch(tagArr_ + slot);
+        __builtin_prefetch(keyArr_ + slot * FLAT_KEY_SIZE);
+    }
+
+    string value;
+    for (size_t i = 0; i < n; i++) {
+        if (i + FLAT_PREFETCH_DIST < n) {
+            slot = tool::HashKey(keys + (i + FLAT_PREFETCH_DIST) * keyStride) & mask_;
+            __builtin_prefetch(tagArr_ + slot);
+            __builtin_prefetch(keyArr_ + slot * FLAT_KEY_SIZE);
+        }
+
+        const uint8_t* key = keys + i * keyStride;
+        if (this->FindSlot(key, tool::HashKey(key), slot)) {
+            memcpy(values + i * valueStride, valueArr_ + slot * FLAT_VALUE_SIZE, FLAT_VALUE_SIZE);
+            found[i] = 1;
+        } else if (!indexObj_.empty() &&
+            InMemoryDatabase::QueryBuffer((const char*)key, FLAT_KEY_SIZE, value)) {
+            memcpy(values + i * valueStride, &value[0], min(value.size(), FLAT_VALUE_SIZE));
+            found[i] = 1;
+        } else {
+            found[i] = 0;
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief get size of all Indexes
+ * @return true
+ * @return false
+ */
+bool FlatMemoryDatabase::GetIndexSize() {
+    InMemoryDatabase::GetIndexSize();
+    // the exact size of the table and the estimation of the map
+    fpindexsize = capacity_ * (1 + FLAT_KEY_SIZE + FLAT_VALUE_SIZE)
+        + indexObj_.size() * (CHUNK_HASH_SIZE + 48);
+    return true;
+}
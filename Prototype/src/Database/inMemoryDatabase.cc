@@ -27,58 +27,95 @@ InMemoryDatabase::InMemoryDatabase(std::string dbName) {
  */
 InMemoryDatabase::~InMemoryDatabase() {
     // perisistent the indexFile to the disk
+    if (!fpIndexPersisted_) {
+        this->PersistFPIndex();
+    }
+    this->PersistSFIndex();
+    delete[] sfObj_;
+}
+
+/**
+ * @brief open a database
+ * 
+ * @param dbName the db path
+ * @return true success
+ * @return false fails
+ */
+bool InMemoryDatabase::OpenDB(std::string dbName) {
+    dbName_ = dbName;
+    this->LoadFPIndex();
+    this->LoadSFIndex();
+    return true;
+}
+
+/**
+ * @brief write a (key, value) item to the db file
+ * 
+ * @param dbFile the db file
+ * @param key the key buffer
+ * @param keySize the key size
+ * @param value the value buffer
+ * @param valueSize the value size
+ */
+void InMemoryDatabase::WriteItem(ofstream& dbFile, const char* key, int keySize,
+    const char* value, int valueSize) {
+    // write the key
+    dbFile.write((char*)&keySize, sizeof(keySize));
+    dbFile.write(key, keySize);
+
+    // write the value
+    dbFile.write((char*)&valueSize, sizeof(valueSize));
+    dbFile.write(value, valueSize);
+    return ;
+}
+
+/**
+ * @brief persist the fp index to the db file
+ * 
+ */
+void InMemoryDatabase::PersistFPIndex() {
     ofstream dbFile;
     dbFile.open(dbName_, ios_base::trunc | ios_base::binary);
-    int itemSize = 0;
     for (auto it = indexObj_.begin(); it != indexObj_.end(); it++) {
-        // write the key
-        itemSize = it->first.size();
-        dbFile.write((char*)&itemSize, sizeof(itemSize));
-        dbFile.write(it->first.c_str(), itemSize);
-
-        // write the value
-        itemSize = it->second.size();
-        dbFile.write((char*)&itemSize, sizeof(itemSize));
-        dbFile.write(it->second.c_str(), itemSize);
+        this->WriteItem(dbFile, it->first.c_str(), it->first.size(),
+            it->second.c_str(), it->second.size());
     }
     dbFile.close();
+    fpIndexPersisted_ = true;
+    return ;
+}
 
-
+/**
+ * @brief persist the sf index to the sfdb file
+ * 
+ */
+void InMemoryDatabase::PersistSFIndex() {
     sfdbName_ = dbName_+"_sf1";
     ofstream sfdbFile;
     sfdbFile.open(sfdbName_, ios_base::trunc | ios_base::binary);
-    itemSize = 0;
+    // the head: the magic and the superfeature function of the index
+    sfdbFile.write((char*)&SF_INDEX_MAGIC, sizeof(SF_INDEX_MAGIC));
+    sfdbFile.write((char*)&SF_FUNCTION, sizeof(SF_FUNCTION));
     int sf_version = 0; //sf_version
     for(int i = 0 ;i<3;i++){
         sf_version = i;
-        for(auto it = sfObj_[i].begin();it != sfObj_[i].end();it++){
-            for(int j = 0;j < it->second.size();j++){
+        sfObj_[i].Traverse([&](const uint8_t* key, const uint8_t* fp) {
             //write sf_version
             sfdbFile.write((char*)&sf_version,sizeof(sf_version));
-            //write the key
-            itemSize = it->first.size();
-            sfdbFile.write((char*)&itemSize, sizeof(itemSize));
-            sfdbFile.write(it->first.c_str(), itemSize);
-            //write the value
-            itemSize = it->second[j].size();
-            sfdbFile.write((char*)&itemSize, sizeof(itemSize));
-            sfdbFile.write(it->second[j].c_str(), itemSize);
-            }
-        }
-
+            //write the (key, value)
+            this->WriteItem(sfdbFile, (const char*)key, CHUNK_HASH_SIZE,
+                (const char*)fp, CHUNK_HASH_SIZE);
+        });
     }
     sfdbFile.close();
+    return ;
 }
 
 /**
- * @brief open a database
+ * @brief load the fp index from the db file, the items are inserted via InsertBothBuffer
  * 
- * @param dbName the db path
- * @return true success
- * @return false fails
  */
-bool InMemoryDatabase::OpenDB(std::string dbName) {
-    dbName_ = dbName;
+void InMemoryDatabase::LoadFPIndex() {
     // check whether there exists the index
     ifstream dbFile;
     dbFile.open(dbName_, ios_base::in | ios_base::binary);
@@ -116,7 +153,7 @@ bool InMemoryDatabase::OpenDB(std::string dbName) {
             dbFile.read((char*)&value[0], itemSize);
             
             // update the index
-            indexObj_.insert(make_pair(key, value));
+            this->InsertBothBuffer(key.c_str(), key.size(), value.c_str(), value.size());
             itemSize = 0;
             // update the read flag
             isEnd = dbFile.eof();
@@ -124,12 +161,18 @@ bool InMemoryDatabase::OpenDB(std::string dbName) {
     }
     dbFile.close();
     fprintf(stderr, "InMemoryDatabase: loaded FP index size: %lu\n", indexObj_.size());
+    return ;
+}
 
-
-    sfObj_ = new unordered_map<string,vector<string>>[3];
+/**
+ * @brief load the sf index from the sfdb file
+ * 
+ */
+void InMemoryDatabase::LoadSFIndex() {
+    sfObj_ = new SFIndex[3];
     fprintf(stderr, "InMemoryDatabase: sfdb_index is created\n");
 
-    sfdbName_ = dbName+"_sf1";
+    sfdbName_ = dbName_+"_sf1";
     ifstream sfdbFile;
     sfdbFile.open(sfdbName_, ios_base::in | ios_base::binary);
     if (!sfdbFile.is_open()) {
@@ -142,8 +185,23 @@ bool InMemoryDatabase::OpenDB(std::string dbName) {
     if (filesfSize == 0) {
         fprintf(stderr, "InMemoryDatabase: sfdb_file file is empty, create a new one.\n");
     } else {
-        // db file exist, load
+        // db file exist, check the superfeature function of the index
         sfdbFile.seekg(0, ios_base::beg);
+        uint32_t sfMagic = 0;
+        uint32_t sfFunction = SF_FUNCTION_RABIN;
+        sfdbFile.read((char*)&sfMagic, sizeof(sfMagic));
+        if (sfMagic == SF_INDEX_MAGIC) {
+            sfdbFile.read((char*)&sfFunction, sizeof(sfFunction));
+        } else {
+            // a file without the head is built by the rabin-karp features
+            sfdbFile.seekg(0, ios_base::beg);
+        }
+        if (sfFunction != SF_FUNCTION) {
+            fprintf(stderr, "InMemoryDatabase: the sf index is built by sf function %u, "
+                "but the server is built with %u (SF_GEAR_HASH).\n", sfFunction, SF_FUNCTION);
+            exit(EXIT_FAILURE);
+        }
+
         bool isEnd = false;
         int itemSize = 0;
         int sf_version =0;
@@ -167,17 +225,18 @@ bool InMemoryDatabase::OpenDB(std::string dbName) {
             sfdbFile.read((char*)&value[0], itemSize);
             
             // update the index
-            sfObj_[sf_version][key].push_back(value);
+            if (key.size() == CHUNK_HASH_SIZE && value.size() == CHUNK_HASH_SIZE) {
+                sfObj_[sf_version].Insert((uint8_t*)&key[0], (uint8_t*)&value[0]);
+            }
             itemSize = 0;
             // update the read flag
             isEnd = sfdbFile.eof();
         }
     }
     sfdbFile.close();
-    int sfObj_size = sfObj_[0].size()+sfObj_[1].size()+sfObj_[2].size();
+    int sfObj_size = sfObj_[0].GetKeyNum()+sfObj_[1].GetKeyNum()+sfObj_[2].GetKeyNum();
     fprintf(stderr, "InMemoryDatabase: loaded SF size: %d\n",sfObj_size);
-
-    return true;
+    return ;
 }
 
 /**
@@ -283,21 +342,16 @@ bool InMemoryDatabase::QueryBuffer(const char* key, size_t keySize, std::string&
  */
 bool InMemoryDatabase::InsertSF(const char* key, size_t keySize, const char* buffer,
     size_t bufferSize, uint8_t updateflag) {
-    string keyStr;
-    string valueStr;
     for(int i =0;i<3;i++){
-        keyStr.assign(key+i*CHUNK_HASH_SIZE, CHUNK_HASH_SIZE);
-        valueStr.assign(buffer, CHUNK_HASH_SIZE);
+        const uint8_t* sfKey = (const uint8_t*)key + i * CHUNK_HASH_SIZE;
         if(updateflag == 0){
-            sfObj_[i][keyStr].push_back(valueStr);
+            sfObj_[i].Insert(sfKey, (const uint8_t*)buffer);
         }else if(updateflag == 1){
-            //fprintf(stderr, "update\n");
-            sfObj_[i].erase(keyStr);
-            sfObj_[i][keyStr].push_back(valueStr);
+            // replace the base chunk in place
+            sfObj_[i].Replace(sfKey, (const uint8_t*)buffer);
         }else if(updateflag == 2){
-            sfObj_[i].erase(keyStr);
+            sfObj_[i].Erase(sfKey);
         }
-        //sfObj_[i][keyStr].push_back(valueStr);
     }
     return true;
 }
@@ -313,17 +367,11 @@ bool InMemoryDatabase::InsertSF(const char* key, size_t keySize, const char* buf
  * @return false 
  */
 bool InMemoryDatabase::QuerySF(const char* key, size_t keySize, std::string& value){
-    string keyStr;
-
+    value.resize(CHUNK_HASH_SIZE);
     for(int i=0;i<3;i++){
-        keyStr.assign(key+CHUNK_HASH_SIZE*i, CHUNK_HASH_SIZE);
-        if(sfObj_[i].count(keyStr)){
-            //fprintf(stderr, "the %d size\n",sfObj_[i][keyStr].size());
-        value=sfObj_[i][keyStr].front();
-        //
-        return true;
+        if(sfObj_[i].Query((const uint8_t*)key + CHUNK_HASH_SIZE * i, (uint8_t*)&value[0])){
+            return true;
         }
-        // it exists in the index
     }
     return false;
 }
@@ -380,7 +428,7 @@ bool InMemoryDatabase::GetIndexSize()
     fpindexsize = indexObj_.size() * (CHUNK_HASH_SIZE + 48);
     tmpSize = 0;
     for(int i = 0;i < 3;i++){
-        tmpSize += sfObj_[i].size()*2*CHUNK_HASH_SIZE;
+        tmpSize += sfObj_[i].GetMemoryUsage();
     }
     sfindexsize = tmpSize;
     return true;
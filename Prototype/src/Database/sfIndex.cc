@@ -0,0 +1,283 @@
+/**
+ * @file sfIndex.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the compact superfeature index
+ * @version 0.1
+ * @date 2024-03-10
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/sfIndex.h"
+
+/**
+ * @brief Construct a new SFIndex object
+ *
+ */
+SFIndex::SFIndex() {
+    this->AllocTable(SF_INDEX_INIT_CAPACITY);
+}
+
+/**
+ * @brief Destroy the SFIndex object
+ *
+ */
+SFIndex::~SFIndex() {
+    free(tagArr_);
+    free(bucketArr_);
+    for (auto slab : slabList_) {
+        free(slab);
+    }
+}
+
+/**
+ * @brief allocate an empty directory
+ *
+ * @param capacity the number of buckets (power of 2)
+ */
+void SFIndex::AllocTable(uint64_t capacity) {
+    capacity_ = capacity;
+    mask_ = capacity - 1;
+    keyNum_ = 0;
+    tagArr_ = (uint8_t*)malloc(capacity_);
+    bucketArr_ = (SFBucket_t*)malloc(capacity_ * sizeof(SFBucket_t));
+    if (tagArr_ == NULL || bucketArr_ == NULL) {
+        fprintf(stderr, "SFIndex: cannot allocate the directory with %lu buckets.\n", capacity_);
+        exit(EXIT_FAILURE);
+    }
+    memset(tagArr_, 0, capacity_);
+    return ;
+}
+
+/**
+ * @brief double the directory and re-insert all buckets
+ *
+ */
+void SFIndex::Grow() {
+    uint8_t* oldTagArr = tagArr_;
+    SFBucket_t* oldBucketArr = bucketArr_;
+    uint64_t oldCapacity = capacity_;
+
+    this->AllocTable(oldCapacity << 1);
+    uint64_t pos;
+    for (uint64_t i = 0; i < oldCapacity; i++) {
+        if (oldTagArr[i] == 0) {
+            continue;
+        }
+        this->FindBucket(oldBucketArr[i].key, tool::HashKey(oldBucketArr[i].key), pos);
+        tagArr_[pos] = oldTagArr[i];
+        bucketArr_[pos] = oldBucketArr[i];
+        keyNum_++;
+    }
+
+    free(oldTagArr);
+    free(oldBucketArr);
+    return ;
+}
+
+/**
+ * @brief find the bucket of a key
+ *
+ * @param key the key buffer
+ * @param hash the hash of the key
+ * @param pos the bucket of the key, or the empty bucket to insert it
+ * @return true the key exists
+ * @return false the key does not exist
+ */
+bool SFIndex::FindBucket(const uint8_t* key, uint64_t hash, uint64_t& pos) {
+    uint8_t tag = tool::HashTag(hash);
+    uint64_t i = hash & mask_;
+    while (tagArr_[i] != 0) {
+        if (tagArr_[i] == tag && memcmp(bucketArr_[i].key, key, CHUNK_HASH_SIZE) == 0) {
+            pos = i;
+            return true;
+        }
+        i = (i + 1) & mask_;
+    }
+    pos = i;
+    return false;
+}
+
+/**
+ * @brief take a slot from the free list (or a new slab)
+ *
+ * @param fp the fp stored in the slot
+ * @return uint32_t the slot id
+ */
+uint32_t SFIndex::AllocSlot(const uint8_t* fp) {
+    if (freeHead_ == SF_SLOT_NIL) {
+        // carve a new slab into the free list
+        SFSlot_t* slab = (SFSlot_t*)malloc(SF_SLAB_SLOT_NUM * sizeof(SFSlot_t));
+        if (slab == NULL) {
+            fprintf(stderr, "SFIndex: cannot allocate a new slab.\n");
+            exit(EXIT_FAILURE);
+        }
+        uint32_t base = slabList_.size() * SF_SLAB_SLOT_NUM;
+        for (uint32_t i = 0; i < SF_SLAB_SLOT_NUM - 1; i++) {
+            slab[i].next = base + i + 1;
+        }
+        slab[SF_SLAB_SLOT_NUM - 1].next = SF_SLOT_NIL;
+        slabList_.push_back(slab);
+        freeHead_ = base;
+    }
+
+    uint32_t id = freeHead_;
+    SFSlot_t* slot = this->GetSlot(id);
+    freeHead_ = slot->next;
+    memcpy(slot->fp, fp, CHUNK_HASH_SIZE);
+    slot->next = SF_SLOT_NIL;
+    slotNum_++;
+    return id;
+}
+
+/**
+ * @brief return a list of slots to the free list
+ *
+ * @param head the first slot
+ * @param tail the last slot
+ * @param num the number of slots in the list
+ */
+void SFIndex::FreeSlotList(uint32_t head, uint32_t tail, uint64_t num) {
+    this->GetSlot(tail)->next = freeHead_;
+    freeHead_ = head;
+    slotNum_ -= num;
+    return ;
+}
+
+/**
+ * @brief remove a bucket by shifting back the following buckets (no tombstone)
+ *
+ * @param pos the bucket
+ */
+void SFIndex::RemoveBucket(uint64_t pos) {
+    uint64_t hole = pos;
+    uint64_t i = (pos + 1) & mask_;
+    while (tagArr_[i] != 0) {
+        uint64_t home = tool::HashKey(bucketArr_[i].key) & mask_;
+        // move the bucket back if the hole is on its probe path
+        if (((i - home) & mask_) >= ((i - hole) & mask_)) {
+            tagArr_[hole] = tagArr_[i];
+            bucketArr_[hole] = bucketArr_[i];
+            hole = i;
+        }
+        i = (i + 1) & mask_;
+    }
+    tagArr_[hole] = 0;
+    keyNum_--;
+    return ;
+}
+
+/**
+ * @brief append a fp to the list of a sf
+ *
+ * @param key the sf (CHUNK_HASH_SIZE)
+ * @param fp the base chunk fp (CHUNK_HASH_SIZE)
+ */
+void SFIndex::Insert(const uint8_t* key, const uint8_t* fp) {
+    // grow the directory once it is 4/5 full
+    if ((keyNum_ + 1) * 5 > capacity_ * 4) {
+        this->Grow();
+    }
+    uint64_t hash = tool::HashKey(key);
+    uint64_t pos;
+    uint32_t id = this->AllocSlot(fp);
+    if (this->FindBucket(key, hash, pos)) {
+        this->GetSlot(bucketArr_[pos].tail)->next = id;
+        bucketArr_[pos].tail = id;
+        bucketArr_[pos].num++;
+    } else {
+        tagArr_[pos] = tool::HashTag(hash);
+        memcpy(bucketArr_[pos].key, key, CHUNK_HASH_SIZE);
+        bucketArr_[pos].head = id;
+        bucketArr_[pos].tail = id;
+        bucketArr_[pos].num = 1;
+        keyNum_++;
+    }
+    return ;
+}
+
+/**
+ * @brief replace the list of a sf with a single fp in place
+ *
+ * @param key the sf (CHUNK_HASH_SIZE)
+ * @param fp the base chunk fp (CHUNK_HASH_SIZE)
+ */
+void SFIndex::Replace(const uint8_t* key, const uint8_t* fp) {
+    uint64_t pos;
+    if (!this->FindBucket(key, tool::HashKey(key), pos)) {
+        this->Insert(key, fp);
+        return ;
+    }
+    SFBucket_t* bucket = &bucketArr_[pos];
+    SFSlot_t* headSlot = this->GetSlot(bucket->head);
+    if (bucket->num > 1) {
+        // release the rest of the list
+        this->FreeSlotList(headSlot->next, bucket->tail, bucket->num - 1);
+        headSlot->next = SF_SLOT_NIL;
+        bucket->tail = bucket->head;
+        bucket->num = 1;
+    }
+    memcpy(headSlot->fp, fp, CHUNK_HASH_SIZE);
+    return ;
+}
+
+/**
+ * @brief remove a sf and its list
+ *
+ * @param key the sf (CHUNK_HASH_SIZE)
+ */
+void SFIndex::Erase(const uint8_t* key) {
+    uint64_t pos;
+    if (!this->FindBucket(key, tool::HashKey(key), pos)) {
+        return ;
+    }
+    this->FreeSlotList(bucketArr_[pos].head, bucketArr_[pos].tail, bucketArr_[pos].num);
+    this->RemoveBucket(pos);
+    return ;
+}
+
+/**
+ * @brief query the first fp of a sf
+ *
+ * @param key the sf (CHUNK_HASH_SIZE)
+ * @param fp the first base chunk fp (CHUNK_HASH_SIZE) <return>
+ * @return true the sf exists
+ * @return false the sf does not exist
+ */
+bool SFIndex::Query(const uint8_t* key, uint8_t* fp) {
+    uint64_t pos;
+    if (!this->FindBucket(key, tool::HashKey(key), pos)) {
+        return false;
+    }
+    memcpy(fp, this->GetSlot(bucketArr_[pos].head)->fp, CHUNK_HASH_SIZE);
+    return true;
+}
+
+/**
+ * @brief visit all (sf, fp) pairs in list order
+ *
+ * @param visitor the visitor
+ */
+void SFIndex::Traverse(const std::function<void(const uint8_t*, const uint8_t*)>& visitor) {
+    for (uint64_t i = 0; i < capacity_; i++) {
+        if (tagArr_[i] == 0) {
+            continue;
+        }
+        for (uint32_t id = bucketArr_[i].head; id != SF_SLOT_NIL; id = this->GetSlot(id)->next) {
+            visitor(bucketArr_[i].key, this->GetSlot(id)->fp);
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief get the exact allocated memory of the index
+ *
+ * @return uint64_t the memory size (bytes)
+ */
+uint64_t SFIndex::GetMemoryUsage() {
+    return capacity_ * (sizeof(uint8_t) + sizeof(SFBucket_t))
+        + slabList_.size() * SF_SLAB_SLOT_NUM * sizeof(SFSlot_t)
+        + slabList_.capacity() * sizeof(SFSlot_t*);
+}
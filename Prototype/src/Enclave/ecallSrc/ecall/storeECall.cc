@@ -119,6 +119,17 @@ void Ecall_ProcChunkBatch(SendMsgBuffer_t* recvChunkBuf, UpOutSGX_t* upOutSGX) {
     return ;
 }
 
+/**
+ * @brief answer a batch of chunk fingerprints with the duplicate bitmap
+ * 
+ * @param recvFpBuf the recv fingerprint buffer
+ * @param upOutSGX the pointer to enclave-needed structure
+ */
+void Ecall_ProcFpBatch(SendMsgBuffer_t* recvFpBuf, UpOutSGX_t* upOutSGX) {
+    enclaveBaseObj_->ProcessFpBatch(recvFpBuf, upOutSGX);
+    return ;
+}
+
 /**
  * @brief process the tail batch 
  * 
@@ -201,6 +212,35 @@ void Ecall_Enclave_Init(EnclaveConfig_t* enclaveConfig) {
     sendChunkBatchSize_ = enclaveConfig->sendChunkBatchSize;
     sendRecipeBatchSize_ = enclaveConfig->sendRecipeBatchSize;
     topKParam_ = enclaveConfig->topKParam;
+    sfThreadNum_ = enclaveConfig->sfThreadNum;
+    baseCacheSize_ = enclaveConfig->baseCacheSize;
+    faaSlotNum_ = enclaveConfig->faaSize / RESTORE_SLOT_SIZE;
+    decodeThreadNum_ = enclaveConfig->decodeThreadNum;
+
+    // the workers hold their TCSs until the enclave is destroyed, the superfeature workers
+    // (at least one) go first, the restore decode workers get the rest of the budget
+    if (sfThreadNum_ == 0) {
+        sfThreadNum_ = 1;
+    }
+    if (sfThreadNum_ + decodeThreadNum_ > ENCLAVE_WORKER_TCS_NUM) {
+        sfThreadNum_ = min(sfThreadNum_, ENCLAVE_WORKER_TCS_NUM - 1);
+        decodeThreadNum_ = ENCLAVE_WORKER_TCS_NUM - sfThreadNum_;
+        Logging("EnclaveInit", "cap the workers to %lu TCSs: %lu superfeature, %lu decode.\n",
+            ENCLAVE_WORKER_TCS_NUM, sfThreadNum_, decodeThreadNum_);
+    }
+    if (ENCLAVE_WORKER_TCS_NUM >= ENCLAVE_TCS_NUM ||
+        ENCLAVE_TCS_NUM - sfThreadNum_ - decodeThreadNum_ < ENCLAVE_ECALL_TCS_NUM) {
+        Ocall_SGX_Exit_Error("EnclaveInit: the workers leave too few TCSs for the ECALLs, "
+            "check ENCLAVE_TCS_NUM and ENCLAVE_WORKER_TCS_NUM.");
+    }
+
+    // build the superfeature tables once
+    sfEngineObj_ = new EcallSuperFeature();
+#if (SF_SINGLE_THREAD == 0)
+    // start the superfeature workers once, they live until the enclave is destroyed
+    sfPoolObj_ = new EcallWorkerPool("EcallSFPool", sfThreadNum_,
+        EcallSuperFeature::poolHandler_, sfEngineObj_);
+#endif
 
     // check the file 
     size_t readFileSize = 0;
@@ -249,6 +289,10 @@ void Ecall_Enclave_Destroy() {
     // free the enclave key, index query key and the global secret
     free(enclaveKey_); 
     free(indexQueryKey_);
+    if (sfPoolObj_ != NULL) {
+        delete sfPoolObj_;
+    }
+    delete sfEngineObj_;
     return ;
 }
 
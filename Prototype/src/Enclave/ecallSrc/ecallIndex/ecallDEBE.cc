@@ -74,6 +74,17 @@ void EcallDEBE::UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFre
     return ;
 }
 
+/**
+ * @brief check whether a chunk is in the top-k index
+ * 
+ * @param chunkFp the chunk fp
+ * @return true it is in the index
+ * @return false it is not in the index
+ */
+bool EcallDEBE::CheckInsideIndex(const string& chunkFp) {
+    return insideDedupIndex_->Contains(chunkFp);
+}
+
 /**
  * @brief process the tailed batch when received the end of the recipe flag
  * 
@@ -275,7 +286,6 @@ void EcallDEBE::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
     InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
     OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
@@ -286,9 +296,8 @@ void EcallDEBE::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     string tmpHashStr;
     tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
 
-    // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    // decrypt the received data with the session key (and decompress it)
+    recvBuffer = this->DecryptBatch(recvChunkBuf, sgxClient);
     
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
@@ -296,15 +305,11 @@ void EcallDEBE::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     // compute the hash of each chunk
     InQueryEntry_t* inQueryEntry = inQueryBase;
     size_t currentOffset = 0;
+    uint32_t fpOnlyNum = 0;
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
-        memcpy(&inQueryEntry->chunkSize, recvBuffer + currentOffset,
-            sizeof(uint32_t));
-        currentOffset += sizeof(uint32_t);
-
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset,
-            inQueryEntry->chunkSize, inQueryEntry->chunkHash);
-        currentOffset += inQueryEntry->chunkSize;
+        if (!this->ParseChunk(mdCtx, recvBuffer, currentOffset, inQueryEntry)) {
+            fpOnlyNum++;
+        }
         inQueryEntry++;
     }
 
@@ -418,18 +423,20 @@ void EcallDEBE::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         _Inline_Ocall++;
         _Inline_FPOcall++;
     }
+    if (fpOnlyNum != 0) {
+        this->CheckChunkBody(inQueryBase, upOutSGX->outQuery->outQueryBase, chunkNum);
+    }
 
     // process the unique chunks and update the metadata
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
     string tmpChunkAddr;
     tmpChunkAddr.resize(sizeof(RecipeEntry_t), 0);
     InQueryEntry_t* tmpQueryEntry;
     uint32_t tmpChunkSize;
     for (size_t i = 0; i < chunkNum; i++) {
         tmpChunkSize = inQueryEntry->chunkSize;
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         switch (inQueryEntry->dedupFlag) {
             case DUPLICATE: {
                 // it is duplicate for the min-heap
@@ -468,7 +475,8 @@ void EcallDEBE::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
                         // it also unique for the out-enclave index
                         //outQueryEntry->offlineFlag = 1;
                         this->ProcessUniqueChunk(&inQueryEntry->chunkAddr,
-                            recvBuffer + currentOffset, tmpChunkSize, upOutSGX);
+                            recvBuffer + currentOffset, tmpChunkSize, upOutSGX,
+                            inQueryEntry->compressedChunk, inQueryEntry->compressedSize);
 
                         _lz4SaveSize += (tmpChunkSize - inQueryEntry->chunkAddr.length);
                         _baseChunkNum++;
@@ -509,7 +517,6 @@ void EcallDEBE::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
             }
         }
         this->UpdateFileRecipe(tmpChunkAddr, inRecipe, upOutSGX, &inQueryEntry->chunkHash[0]);
-        currentOffset += tmpChunkSize;
         inQueryEntry++;
 
         // update the statistic
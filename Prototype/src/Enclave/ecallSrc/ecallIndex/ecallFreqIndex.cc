@@ -11,30 +11,6 @@
 
 #include "../../include/ecallFreqIndex.h"
 
-
-struct Param
-{
-    int thread_id;
-    unsigned char *ptr;
-    EVP_MD_CTX *mdCtx;
-    uint8_t *SF;
-    EcallCrypto *cryptoObj_;
-    int chunksize;
-};
-
-struct GetSFTask{
-    int begin{0};
-    int end{0};
-    int thread_id;
-};
-
-pthread_mutex_t mutex2;
-pthread_t test_pthread[4];
-
-#define INIT(L, R, OFF) L = 0x6c078965 * ((R) ^ (R >> 30u)) + (OFF)
-
-vector<Param> param_list;
-
 int delta_find = 0;
 /**
  * @brief Construct a new Ecall Frequency Index object
@@ -96,133 +72,18 @@ EcallFreqIndex::~EcallFreqIndex() {
     Enclave::Logging(myName_.c_str(), "===================================\n");
 }
 
-uint32_t* EcallFreqIndex::mt_n_get(uint32_t seed, int n) {
-    //uint32_t *head_arr = (uint32_t *) malloc(sizeof(uint32_t) * (n + 1));
-    auto *head_arr = new uint32_t[n + 1];
-    auto *last_arr = new uint32_t[n + 1];
-    auto *result = new uint32_t[n];
-    head_arr[0] = seed;
-    for (int i = 1; i < n + 1; i++)
-        INIT(head_arr[i], head_arr[i - 1], i);
-    uint32_t temp = head_arr[n];
-    for (int i = n; i < 397; i++)
-        INIT(temp, temp, i + 1);
-    last_arr[0] = temp;
-    for (int i = 1; i < n + 1; ++i)
-        INIT(last_arr[i], last_arr[i - 1], i + 397);
-    for (int i = 0; i < n; i++) {
-        temp = (head_arr[i] & 0x80000000) + (head_arr[i + 1] & 0x7fffffffu);
-        head_arr[i] = (temp >> 1u) ^ last_arr[i];
-        if (temp % 2 != 0)
-            head_arr[i] = head_arr[i] ^ 0x9908b0df;
-    }
-    for (int i = 0; i < n;
-         ++i) {
-        uint32_t y = head_arr[i];
-        y = y ^ y >> 11u;
-        y = y ^ y << 7u & 2636928640u;
-        y = y ^ y << 15u & 4022730752u;
-        y = y ^ y >> 18u;
-        result[i] = y;
-    }
-    delete [] head_arr;
-    delete [] last_arr;
-    return result;
-}
-
+/**
+ * @brief calculating superfeatures for chunk
+ * 
+ * @param ptr the pointer of chunk content 
+ * @param mdCtx the hasher ctx (owned by the calling thread)
+ * @param SF the buffer of superfeature
+ * @param cryptoObj_ the crypto obj
+ * @param chunkSize the chunk size
+ */
 void EcallFreqIndex::getSF2(unsigned char *ptr, EVP_MD_CTX *mdCtx, uint8_t *SF, EcallCrypto *cryptoObj_, int chunkSize) {
-    
- 
-  EVP_MD_CTX *mdCtx_ = mdCtx;
-  int BLOCK_SIZE;
-
-  BLOCK_SIZE = chunkSize;
-
-  constexpr auto WINDOW_SIZE = 48;
-  constexpr auto SF_NUM = 3;
-  constexpr auto FEATURE_NUM = 12;
-  const auto A = 37u, MOD = 1000000007u;
-  uint64_t Apower = 1;  uint32_t TRANSPOSE_M[FEATURE_NUM];
-  uint32_t TRANSPOSE_A[FEATURE_NUM];
-  int subchunkIndex[FEATURE_NUM + 1];
-
-  uint32_t feature[FEATURE_NUM];
-  uint64_t superfeature[SF_NUM];
-  subchunkIndex[0] = 0;
-  for (int i = 0; i < FEATURE_NUM; ++i) {
-    subchunkIndex[i + 1] = (BLOCK_SIZE * (i + 1)) / FEATURE_NUM;
-  }
-  auto *rds = mt_n_get(922,FEATURE_NUM * 2);
-  for (int i = 0; i < FEATURE_NUM; ++i) {
-    TRANSPOSE_M[i] = ((rds[i << 1] >> 1) << 1) + 1;
-    TRANSPOSE_A[i] = rds[(i <<1) + 1];
-  }
-  delete[] rds;
-  for (int i = 0; i < WINDOW_SIZE - 1; ++i) {
-    Apower *= A;
-    Apower %= MOD;
-  }
-  
-  memset(feature,0,FEATURE_NUM * sizeof(uint32_t));
-  memset(superfeature,0,SF_NUM  *sizeof(uint64_t));
-
-  
-  for (int i = 0; i < FEATURE_NUM; ++i) {
-    int64_t fp = 0;
-    for (int j = subchunkIndex[i]; j < subchunkIndex[i] + WINDOW_SIZE; ++j) {
-      fp *= A;
-      fp += (unsigned char)ptr[j];
-      fp %= MOD;
-    }
-
-    for (int j = subchunkIndex[i]; j < subchunkIndex[i + 1] - WINDOW_SIZE + 1;
-         ++j) {
-      if (fp > feature[i])
-        feature[i] = fp;
-      fp -= (ptr[j] * Apower) % MOD;
-      while (fp < 0)
-        fp += MOD;
-      if (j != subchunkIndex[i + 1] - WINDOW_SIZE) {
-        fp *= A;
-        fp += ptr[j + WINDOW_SIZE];
-        fp %= MOD;
-      }
-    }
-  }
-  
-  for (int i = 0; i < FEATURE_NUM / SF_NUM; ++i) {
-    std::sort(feature + i * SF_NUM, feature + (i + 1) * SF_NUM);
-  }
-
- 
-  int offset = 0;
-  for (int i = 0; i < SF_NUM; ++i) {
-    uint64_t temp[FEATURE_NUM / SF_NUM];
-    for (int j = 0; j < FEATURE_NUM / SF_NUM; ++j) {
-      temp[j] = feature[j * SF_NUM + i];
-    }
-    uint8_t temp3[4 * sizeof(uint64_t)];
-    memcpy(temp3, temp, 4 * sizeof(uint64_t));
-    uint8_t temp2[CHUNK_HASH_SIZE];
-    pthread_mutex_lock(&mutex2);
-    cryptoObj_->GenerateHash(mdCtx, temp3, sizeof(uint64_t) * FEATURE_NUM / SF_NUM, temp2);
-    pthread_mutex_unlock(&mutex2);
-    memcpy(SF + offset, temp2, CHUNK_HASH_SIZE);
-    offset = offset + CHUNK_HASH_SIZE;
-  }
-  
-  
-}
-
-void* EcallFreqIndex::GetSF_thread_func_f(void* arg){
-    auto info = *(GetSFTask*)arg;
-    for(int i = info.begin ; i < info.end; i++){
-        auto param = param_list[i];
-        if(param.SF){
-            getSF2(param.ptr,param.mdCtx,param.SF,param.cryptoObj_,param.chunksize);
-        }
-    }
-    return NULL;
+    Enclave::sfEngineObj_->GenerateSuperFeature(ptr, chunkSize, mdCtx, cryptoObj_, SF);
+    return ;
 }
 
 
@@ -351,6 +212,17 @@ void EcallFreqIndex::UpdateInsideIndexFreq(const string& chunkFp, uint32_t curre
     return ;
 }
 
+/**
+ * @brief check whether a chunk is in the top-k index
+ * 
+ * @param chunkFp the chunk fp
+ * @return true it is in the index
+ * @return false it is not in the index
+ */
+bool EcallFreqIndex::CheckInsideIndex(const string& chunkFp) {
+    return insideDedupIndex_->Contains(chunkFp);
+}
+
 /**
  * @brief process the tailed batch when received the end of the recipe flag
  * 
@@ -555,7 +427,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
     InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
     OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
@@ -577,9 +448,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     string tmpHashStr;
     tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
 
-    // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    // decrypt the received data with the session key (and decompress it)
+    recvBuffer = this->DecryptBatch(recvChunkBuf, sgxClient);
     
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
@@ -587,15 +457,11 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     // compute the hash of each chunk
     InQueryEntry_t* inQueryEntry = inQueryBase;
     size_t currentOffset = 0;
+    uint32_t fpOnlyNum = 0;
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
-        memcpy(&inQueryEntry->chunkSize, recvBuffer + currentOffset,
-            sizeof(uint32_t));
-        currentOffset += sizeof(uint32_t);
-
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset,
-            inQueryEntry->chunkSize, inQueryEntry->chunkHash);
-        currentOffset += inQueryEntry->chunkSize;
+        if (!this->ParseChunk(mdCtx, recvBuffer, currentOffset, inQueryEntry)) {
+            fpOnlyNum++;
+        }
         inQueryEntry++;
     }
 
@@ -725,13 +591,19 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         _Inline_Ocall++;
         _Inline_FPOcall++;
     }
+    if (fpOnlyNum != 0) {
+        this->CheckChunkBody(inQueryBase, upOutSGX->outQuery->outQueryBase, chunkNum);
+    }
 
     //为每一个Unique chunk计算superfeature
+#if(SF_SINGLE_THREAD == 0)
+    vector<Param> paramList;
+    paramList.reserve(chunkNum);
+#endif
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
     for(size_t i = 0; i < chunkNum; i++){
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         if(inQueryEntry->dedupFlag == UNIQUE){
             if(outQueryEntry->dedupFlag == UNIQUE){
 
@@ -743,44 +615,20 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 #else
                 Param test_param;
                 test_param.ptr = recvBuffer + currentOffset;
-                test_param.mdCtx = mdCtx;
                 test_param.SF = (uint8_t *)&inQueryEntry->superfeature;
                 test_param.cryptoObj_ = this->cryptoObj_;
                 test_param.chunksize = inQueryEntry->chunkSize;
-                param_list.push_back(test_param);
+                paramList.push_back(test_param);
 
 #endif
             }
             outQueryEntry++;
         }
-        currentOffset += inQueryEntry->chunkSize;
         inQueryEntry++;
     }
 
 #if(SF_SINGLE_THREAD == 0)
-    const size_t thread_num = 3;
-    int block_len;
-    block_len = param_list.size() / thread_num;
-    pthread_mutex_init(&mutex2,NULL);
-    std::vector<GetSFTask> ts(thread_num,GetSFTask());
-    for(int i = 0;i< thread_num; i++){
-        auto &t = ts[i];
-        t.begin = block_len * i;
-        t.end = block_len * (i+1);
-        t.thread_id = i;
-        if(i == thread_num - 1&&(param_list.size() % thread_num != 0)){
-            t.end = param_list.size();
-        }
-        pthread_create(&test_pthread[i],NULL,GetSF_thread_func_f,&t);
-    }
-
-    for(int i = 0;i< thread_num;i++){
-        pthread_join(test_pthread[i],NULL);
-    }
-
-    pthread_mutex_destroy(&mutex2);
-
-    param_list.clear();
+    Enclave::sfPoolObj_->ProcessBatch(paramList.data(), paramList.size());
 
 #endif
 
@@ -807,7 +655,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     //process the unique chunks and update the metadata
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
     string tmpChunkAddr;
     tmpChunkAddr.resize(sizeof(RecipeEntry_t), 0);
     InQueryEntry_t* tmpQueryEntry;
@@ -817,7 +664,7 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     uint32_t processNum = 0;
     for (size_t i = 0; i < chunkNum; i++) {
         tmpChunkSize = inQueryEntry->chunkSize;
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         switch (inQueryEntry->dedupFlag) {
             case DUPLICATE: {
                 // it is duplicate for the min-heap
@@ -896,7 +743,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 
                         }else if (inQueryEntry->chunkAddr.deltaFlag == NO_DELTA){
                             outQueryEntry->deltaFlag = NO_DELTA;
-                            this->ProcessSheUniqueChunk(&inQueryEntry->chunkAddr,recvBuffer + currentOffset, tmpChunkSize, upOutSGX, (uint8_t *)&inQueryEntry->superfeature, (uint8_t *)&outQueryEntry->chunkHash);
+                            this->ProcessSheUniqueChunk(&inQueryEntry->chunkAddr,recvBuffer + currentOffset, tmpChunkSize, upOutSGX, (uint8_t *)&inQueryEntry->superfeature, (uint8_t *)&outQueryEntry->chunkHash,
+                                inQueryEntry->compressedChunk, inQueryEntry->compressedSize);
 
                             _baseChunkNum++;
                             _baseDataSize += inQueryEntry->chunkAddr.length;
@@ -942,7 +790,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         this->UpdateFileRecipe(tmpChunkAddr, inRecipe,upOutSGX,&inQueryEntry->chunkHash[0]);
 
         inQueryEntry++;
-        currentOffset += tmpChunkSize;
 
         // update the statistic
         _logicalDataSize += tmpChunkSize;
@@ -1035,7 +882,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
     InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
     OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
@@ -1065,9 +911,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     Ocall_GetCurrentTime(&_startTime);
 #endif
 
-    // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    // decrypt the received data with the session key (and decompress it)
+    recvBuffer = this->DecryptBatch(recvChunkBuf, sgxClient);
 
 #if (EDR_BREAKDOWN == 1)
     Ocall_GetCurrentTime(&_endTime);
@@ -1081,24 +926,20 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     // compute the hash of each chunk
     InQueryEntry_t* inQueryEntry = inQueryBase;
     size_t currentOffset = 0;
+    uint32_t fpOnlyNum = 0;
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
-        memcpy(&inQueryEntry->chunkSize, recvBuffer + currentOffset,
-            sizeof(uint32_t));
-        currentOffset += sizeof(uint32_t);
-
 #if (EDR_BREAKDOWN == 1)
         Ocall_GetCurrentTime(&_startTime);
 #endif
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset,
-            inQueryEntry->chunkSize, inQueryEntry->chunkHash);
+        if (!this->ParseChunk(mdCtx, recvBuffer, currentOffset, inQueryEntry)) {
+            fpOnlyNum++;
+        }
 
 #if (EDR_BREAKDOWN == 1)
         Ocall_GetCurrentTime(&_endTime);
         _fingerprintTime += (_endTime - _startTime);
         _fingerprintCount++;
 #endif
-        currentOffset += inQueryEntry->chunkSize;
         inQueryEntry++;
     }
 
@@ -1251,6 +1092,9 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         upOutSGX->outQuery->queryNum = outQueryNum;
         Ocall_QueryOutIndex(upOutSGX->outClient);
     }
+    if (fpOnlyNum != 0) {
+        this->CheckChunkBody(inQueryBase, upOutSGX->outQuery->outQueryBase, chunkNum);
+    }
 
 #if (EDR_BREAKDOWN == 1)
             Ocall_GetCurrentTime(&_endTime);
@@ -1261,9 +1105,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     //为每一个Unique chunk计算superfeature
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
     for(size_t i = 0; i < chunkNum; i++){
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         if(inQueryEntry->dedupFlag == UNIQUE){
             if(outQueryEntry->dedupFlag == UNIQUE){
 
@@ -1284,7 +1127,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
             }
             outQueryEntry++;
         }
-        currentOffset += inQueryEntry->chunkSize;
         inQueryEntry++;
     }
 
@@ -1310,14 +1152,13 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     //process the unique chunks and update the metadata
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
     string tmpChunkAddr;
     tmpChunkAddr.resize(sizeof(RecipeEntry_t), 0);
     InQueryEntry_t* tmpQueryEntry;
     uint32_t tmpChunkSize;
     for (size_t i = 0; i < chunkNum; i++) {
         tmpChunkSize = inQueryEntry->chunkSize;
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         switch (inQueryEntry->dedupFlag) {
             case DUPLICATE: {
                 // it is duplicate for the min-heap
@@ -1417,7 +1258,8 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 
                         }else if (inQueryEntry->chunkAddr.deltaFlag == NO_DELTA){
                             outQueryEntry->deltaFlag = NO_DELTA;
-                            this->ProcessSheUniqueChunk(&inQueryEntry->chunkAddr,recvBuffer + currentOffset, tmpChunkSize, upOutSGX, (uint8_t *)&inQueryEntry->superfeature, (uint8_t *)&outQueryEntry->chunkHash);
+                            this->ProcessSheUniqueChunk(&inQueryEntry->chunkAddr,recvBuffer + currentOffset, tmpChunkSize, upOutSGX, (uint8_t *)&inQueryEntry->superfeature, (uint8_t *)&outQueryEntry->chunkHash,
+                                inQueryEntry->compressedChunk, inQueryEntry->compressedSize);
                             _baseChunkNum++;
                             _baseDataSize += inQueryEntry->chunkAddr.length;
                             _lz4SaveSize += (tmpChunkSize - inQueryEntry->chunkAddr.length);
@@ -1514,7 +1356,6 @@ void EcallFreqIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         //Ocall_PrintfBinary(&inQueryEntry->chunkHash[0],CHUNK_HASH_SIZE);
 
         inQueryEntry++;
-        currentOffset += tmpChunkSize;
 
         // update the statistic
         _logicalDataSize += tmpChunkSize;
@@ -1642,9 +1483,11 @@ void EcallFreqIndex::EntryLoad(InQueryEntry_t *_inQueryEntry, OutQueryEntry_t *_
 
 
 bool EcallFreqIndex::LocalChecker(InQueryEntry_t *_inQueryBase, OutQueryEntry_t *_outQueryBase, UpOutSGX_t *_upOutSGX,uint32_t _chunkNum){
+    EnclaveClient *sgxClient = (EnclaveClient *)_upOutSGX->sgxClient;
     InQueryEntry_t *inQueryEntry = _inQueryBase;
     OutQueryEntry_t *outQueryEntry = _outQueryBase;
     set<string> Batch_ContainerIDset;
+    unordered_map<string, uint32_t> Batch_ContainerRefNum;
     for(size_t i = 0; i < _chunkNum; i++){
         //if the input entry is unique, we need to check if the output entry is also unique
         if(inQueryEntry->dedupFlag == UNIQUE){
@@ -1652,6 +1495,10 @@ bool EcallFreqIndex::LocalChecker(InQueryEntry_t *_inQueryBase, OutQueryEntry_t
             if(outQueryEntry->dedupFlag == UNIQUE){
                 //if the output entry is full, we need to load the input entry into the output entry
                 EntryLoad(inQueryEntry,outQueryEntry,_upOutSGX,Batch_ContainerIDset);
+                if(outQueryEntry->deltaFlag == OUT_DELTA){
+                    //count the base chunks in each container
+                    Batch_ContainerRefNum[string((char*)inQueryEntry->basechunkAddr.containerName, CONTAINER_ID_LENGTH)]++;
+                }
             }
             //if the output entry is not full, we need to move the output entry to the next position
             outQueryEntry++;
@@ -1675,14 +1522,48 @@ bool EcallFreqIndex::LocalChecker(InQueryEntry_t *_inQueryBase, OutQueryEntry_t
     _inline_batch_num++;
 
     //if the batch is full, we need to return true
+    sgxClient->_fetchedBaseMap.clear();
     if(Batch_ContainerIDset.size() >  thresold){
         return true;
     }else{
-        //if the batch is not full, we need to return false
+        //if the batch is not full, load its base containers in one ocall and return false
+        FetchBaseContainers(Batch_ContainerIDset,Batch_ContainerRefNum,_upOutSGX);
         return false;
     }
 }
 
+void EcallFreqIndex::FetchBaseContainers(set<string> &Batch_ContainerIDset, unordered_map<string, uint32_t> &Batch_ContainerRefNum, UpOutSGX_t *_upOutSGX){
+    EnclaveClient *sgxClient = (EnclaveClient *)_upOutSGX->sgxClient;
+    BaseFetch_t *baseFetch = _upOutSGX->baseFetch;
+    uint32_t idNum = 0;
+    for(auto &containerID : Batch_ContainerIDset){
+        if(InContainercache_->ExistsInCache(containerID)){
+            continue;
+        }
+        if(Batch_ContainerRefNum[containerID] <= BASE_RANGE_READ_REF_NUM){
+            // a sparse reference, only read its base chunk record
+            sgxClient->_fetchedBaseMap[containerID] = BASE_FETCH_RANGE;
+            continue;
+        }
+        if(idNum == BASE_FETCH_NUM){
+            // the rest are loaded one by one in OfflinedeltaTure
+            continue;
+        }
+        memcpy(baseFetch->idBuffer + idNum * CONTAINER_ID_LENGTH, containerID.c_str(), CONTAINER_ID_LENGTH);
+        sgxClient->_fetchedBaseMap[containerID] = idNum;
+        idNum++;
+    }
+    if(idNum == 0){
+        return;
+    }
+
+    baseFetch->idNum = idNum;
+    Ocall_FetchBaseContainers(_upOutSGX->outClient);
+    _Inline_Ocall++;
+    _Inline_LoadOcall++;
+    return;
+}
+
 void EcallFreqIndex::OfflinedeltaTure(InQueryEntry_t *_inQueryEntry, OutQueryEntry_t *_outQueryEntry, UpOutSGX_t *_upOutSGX,vector<pair<string,string>> &_batch_map,int &_batch_out_times,bool Local_Flag)
 {
     int container_flag = 1;
@@ -1745,9 +1626,36 @@ void EcallFreqIndex::OfflinedeltaTure(InQueryEntry_t *_inQueryEntry, OutQueryEnt
     {
         string tmpContainerIDStr_1;
         tmpContainerIDStr_1.assign((char *)_outQueryEntry->basechunkAddr.containerName, CONTAINER_ID_LENGTH);
-        Ocall_getRefContainer(_upOutSGX->outClient);
-        _Inline_Ocall++;
-        _Inline_LoadOcall++;
+        auto fetchIter = sgxClient->_fetchedBaseMap.find(tmpContainerIDStr_1);
+        if (fetchIter != sgxClient->_fetchedBaseMap.end() && fetchIter->second == BASE_FETCH_RANGE)
+        {
+            // the record is not a whole container, do not cache it
+            Ocall_getRefChunk(_upOutSGX->outClient);
+            _Inline_Ocall++;
+            _Inline_LoadOcall++;
+            container_flag = 0;
+        }
+        else if (fetchIter != sgxClient->_fetchedBaseMap.end())
+        {
+            // already loaded by the batch fetch in LocalChecker
+            BaseFetch_t *baseFetch = _upOutSGX->baseFetch;
+            if (baseFetch->sizeArray[fetchIter->second] == 0)
+            {
+                _outQueryEntry->deltaFlag = NO_DELTA;
+            }
+            else
+            {
+                _outQueryEntry->containerbuffer = baseFetch->containerArray[fetchIter->second];
+                _outQueryEntry->containersize = baseFetch->sizeArray[fetchIter->second];
+                _outQueryEntry->deltaFlag = DELTA;
+            }
+        }
+        else
+        {
+            Ocall_getRefContainer(_upOutSGX->outClient);
+            _Inline_Ocall++;
+            _Inline_LoadOcall++;
+        }
   
     }
 
@@ -1769,7 +1677,7 @@ void EcallFreqIndex::OfflinedeltaTure(InQueryEntry_t *_inQueryEntry, OutQueryEnt
                 Enclave::inContainerLck_.lock();
 #endif
 
-                InContainercache_->InsertToCache_Offline(tmpContainerIDStr, (char *)_outQueryEntry->containerbuffer,MAX_CONTAINER_SIZE);
+                InContainercache_->InsertToCache_Offline(tmpContainerIDStr, (char *)_outQueryEntry->containerbuffer,_outQueryEntry->containersize);
                 basecontainer_set.insert(tmpContainerIDStr);
 #if(MULTI_CLIENT == 1)
                 Enclave::inContainerLck_.unlock();
@@ -1794,13 +1702,7 @@ uint8_t* EcallFreqIndex::ProcessDeltachunk(InQueryEntry_t *inQueryEntry, OutQuer
     EnclaveClient *sgxClient = (EnclaveClient *)upOutSGX->sgxClient;
     EVP_CIPHER_CTX *cipherCtx = sgxClient->_cipherCtx;
     uint8_t* tmpbuffer;
-    string tmpContainerIDStr_1;
-    tmpContainerIDStr_1.assign((char *)inQueryEntry->basechunkAddr.containerName, CONTAINER_ID_LENGTH);
 
-    bool result = InContainercache_->ExistsInCache(tmpContainerIDStr_1);
-    if(result == 0){
-        Enclave::Logging(myName_.c_str(), "IScontainer:%d\n",result);
-    }
     tmpbuffer = outQueryEntry->containerbuffer; 
     // Enclave::Logging(myName_.c_str(), "before enc base buffer\n");
     memcpy(encBaseBuffer_, 
@@ -14,7 +14,6 @@
 
 
 
-#define INIT(L, R, OFF) L = 0x6c078965 * ((R) ^ (R >> 30u)) + (OFF)
 
 
 /**
@@ -79,130 +78,18 @@ EcallMeGA::~EcallMeGA() {
     Enclave::Logging(myName_.c_str(), "===================================\n");
 }
 
-uint32_t* EcallMeGA::mt_n_get(uint32_t seed, int n) {
-    //uint32_t *head_arr = (uint32_t *) malloc(sizeof(uint32_t) * (n + 1));
-    auto *head_arr = new uint32_t[n + 1];
-    auto *last_arr = new uint32_t[n + 1];
-    auto *result = new uint32_t[n];
-    head_arr[0] = seed;
-    for (int i = 1; i < n + 1; i++)
-        INIT(head_arr[i], head_arr[i - 1], i);
-    uint32_t temp = head_arr[n];
-    for (int i = n; i < 397; i++)
-        INIT(temp, temp, i + 1);
-    last_arr[0] = temp;
-    for (int i = 1; i < n + 1; ++i)
-        INIT(last_arr[i], last_arr[i - 1], i + 397);
-    for (int i = 0; i < n; i++) {
-        temp = (head_arr[i] & 0x80000000) + (head_arr[i + 1] & 0x7fffffffu);
-        head_arr[i] = (temp >> 1u) ^ last_arr[i];
-        if (temp % 2 != 0)
-            head_arr[i] = head_arr[i] ^ 0x9908b0df;
-    }
-    for (int i = 0; i < n;
-         ++i) {
-        uint32_t y = head_arr[i];
-        y = y ^ y >> 11u;
-        y = y ^ y << 7u & 2636928640u;
-        y = y ^ y << 15u & 4022730752u;
-        y = y ^ y >> 18u;
-        result[i] = y;
-    }
-    delete [] head_arr;
-    delete [] last_arr;
-    return result;
-}
-
+/**
+ * @brief calculating superfeatures for chunk
+ * 
+ * @param ptr the pointer of chunk content 
+ * @param mdCtx the hasher ctx (owned by the calling thread)
+ * @param SF the buffer of superfeature
+ * @param cryptoObj_ the crypto obj
+ * @param chunkSize the chunk size
+ */
 void EcallMeGA::getSF2(unsigned char *ptr, EVP_MD_CTX *mdCtx, uint8_t *SF, EcallCrypto *cryptoObj_, int chunkSize) {
-    
- 
-  EVP_MD_CTX *mdCtx_ = mdCtx;
-  int BLOCK_SIZE = chunkSize;
-  constexpr auto WINDOW_SIZE = 48;
-  constexpr auto SF_NUM = 3;
-  constexpr auto FEATURE_NUM = 12;
-  const auto A = 37u, MOD = 1000000007u;
-  uint64_t Apower = 1;  uint32_t TRANSPOSE_M[FEATURE_NUM];
-  uint32_t TRANSPOSE_A[FEATURE_NUM];
-  int subchunkIndex[FEATURE_NUM + 1];
-
-  uint32_t feature[FEATURE_NUM];
-  uint64_t superfeature[SF_NUM];
-  subchunkIndex[0] = 0;
-  for (int i = 0; i < FEATURE_NUM; ++i) {
-    subchunkIndex[i + 1] = (BLOCK_SIZE * (i + 1)) / FEATURE_NUM;
-  }
-  auto *rds = mt_n_get(922,FEATURE_NUM * 2);
-  for (int i = 0; i < FEATURE_NUM; ++i) {
-    TRANSPOSE_M[i] = ((rds[i << 1] >> 1) << 1) + 1;
-    TRANSPOSE_A[i] = rds[(i <<1) + 1];
-  }
-  delete[] rds;
-  for (int i = 0; i < WINDOW_SIZE - 1; ++i) {
-    Apower *= A;
-    Apower %= MOD;
-  }
-  
-  memset(feature,0,FEATURE_NUM * sizeof(uint32_t));
-  memset(superfeature,0,SF_NUM  *sizeof(uint64_t));
-
-  
-  for (int i = 0; i < FEATURE_NUM; ++i) {
-    int64_t fp = 0;
-    for (int j = subchunkIndex[i]; j < subchunkIndex[i] + WINDOW_SIZE; ++j) {
-      fp *= A;
-      fp += (unsigned char)ptr[j];
-      fp %= MOD;
-    }
-
-    for (int j = subchunkIndex[i]; j < subchunkIndex[i + 1] - WINDOW_SIZE + 1;
-         ++j) {
-      if (fp > feature[i])
-        feature[i] = fp;
-      fp -= (ptr[j] * Apower) % MOD;
-      while (fp < 0)
-        fp += MOD;
-      if (j != subchunkIndex[i + 1] - WINDOW_SIZE) {
-        fp *= A;
-        fp += ptr[j + WINDOW_SIZE];
-        fp %= MOD;
-      }
-    }
-  }
-  
-  for (int i = 0; i < FEATURE_NUM / SF_NUM; ++i) {
-    std::sort(feature + i * SF_NUM, feature + (i + 1) * SF_NUM);
-  }
-
- 
-  int offset = 0;
-  for (int i = 0; i < SF_NUM; ++i) {
-    uint64_t temp[FEATURE_NUM / SF_NUM];
-    for (int j = 0; j < FEATURE_NUM / SF_NUM; ++j) {
-      temp[j] = feature[j * SF_NUM + i];
-    }
-    uint8_t temp3[4 * sizeof(uint64_t)];
-    memcpy(temp3, temp, 4 * sizeof(uint64_t));
-    uint8_t temp2[CHUNK_HASH_SIZE];
-    pthread_mutex_lock(&mutex2);
-    cryptoObj_->GenerateHash(mdCtx, temp3, sizeof(uint64_t) * FEATURE_NUM / SF_NUM, temp2);
-    pthread_mutex_unlock(&mutex2);
-    memcpy(SF + offset, temp2, CHUNK_HASH_SIZE);
-    offset = offset + CHUNK_HASH_SIZE;
-  }
-  
-  
-}
-
-void* EcallMeGA::GetSF_thread_func_f(void* arg){
-    auto info = *(GetSFTask*)arg;
-    for(int i = info.begin ; i < info.end; i++){
-        auto param = param_list[i];
-        if(param.SF){
-            getSF2(param.ptr,param.mdCtx,param.SF,param.cryptoObj_,param.chunksize);
-        }
-    }
-    return NULL;
+    Enclave::sfEngineObj_->GenerateSuperFeature(ptr, chunkSize, mdCtx, cryptoObj_, SF);
+    return ;
 }
 
 
@@ -331,6 +218,17 @@ void EcallMeGA::UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFre
     return ;
 }
 
+/**
+ * @brief check whether a chunk is in the top-k index
+ * 
+ * @param chunkFp the chunk fp
+ * @return true it is in the index
+ * @return false it is not in the index
+ */
+bool EcallMeGA::CheckInsideIndex(const string& chunkFp) {
+    return insideDedupIndex_->Contains(chunkFp);
+}
+
 /**
  * @brief process the tailed batch when received the end of the recipe flag
  * 
@@ -541,7 +439,6 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
     EVP_MD_CTX* mdCtx = sgxClient->_mdCtx;
     uint8_t* recvBuffer = sgxClient->_recvBuffer;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     Recipe_t* inRecipe = &sgxClient->_inRecipe;
     InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
     OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
@@ -567,9 +464,8 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     unordered_map<string,int> MeGA_map;
     int batch_out_times = 0;
 
-    // decrypt the received data with the session key
-    cryptoObj_->SessionKeyDec(cipherCtx, recvChunkBuf->dataBuffer,
-        recvChunkBuf->header->dataSize, sessionKey, recvBuffer);
+    // decrypt the received data with the session key (and decompress it)
+    recvBuffer = this->DecryptBatch(recvChunkBuf, sgxClient);
     
     // get the chunk num
     uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
@@ -577,15 +473,11 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     // compute the hash of each chunk
     InQueryEntry_t* inQueryEntry = inQueryBase;
     size_t currentOffset = 0;
+    uint32_t fpOnlyNum = 0;
     for (size_t i = 0; i < chunkNum; i++) {
-        // compute the hash over the plaintext chunk
-        memcpy(&inQueryEntry->chunkSize, recvBuffer + currentOffset,
-            sizeof(uint32_t));
-        currentOffset += sizeof(uint32_t);
-
-        cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset,
-            inQueryEntry->chunkSize, inQueryEntry->chunkHash);
-        currentOffset += inQueryEntry->chunkSize;
+        if (!this->ParseChunk(mdCtx, recvBuffer, currentOffset, inQueryEntry)) {
+            fpOnlyNum++;
+        }
         inQueryEntry++;
     }
 
@@ -708,15 +600,21 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         Ocall_QueryOutIndex(upOutSGX->outClient);
         _Inline_Ocall++;
     }
+    if (fpOnlyNum != 0) {
+        this->CheckChunkBody(inQueryBase, upOutSGX->outQuery->outQueryBase, chunkNum);
+    }
     //Enclave::Logging("DE BUG","Outdedup Down");
     //为每一个Unique chunk计算superfeature
+#if(SF_SINGLE_THREAD == 0)
+    vector<Param> paramList;
+    paramList.reserve(chunkNum);
+#endif
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
 
     //Enclave::Logging("DE BUG","Process In");
     for(size_t i = 0; i < chunkNum; i++){
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         if(inQueryEntry->dedupFlag == UNIQUE){
             if(outQueryEntry->dedupFlag == UNIQUE){
 
@@ -728,44 +626,20 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 #else
                 Param test_param;
                 test_param.ptr = recvBuffer + currentOffset;
-                test_param.mdCtx = mdCtx;
                 test_param.SF = (uint8_t *)&inQueryEntry->superfeature;
                 test_param.cryptoObj_ = this->cryptoObj_;
                 test_param.chunksize = inQueryEntry->chunkSize;
-                param_list.push_back(test_param);
+                paramList.push_back(test_param);
 
 #endif
             }
             outQueryEntry++;
         }
-        currentOffset += inQueryEntry->chunkSize;
         inQueryEntry++;
     }
 
 #if(SF_SINGLE_THREAD == 0)
-    const size_t thread_num = 3;
-    int block_len;
-    block_len = param_list.size() / thread_num;
-    pthread_mutex_init(&mutex2,NULL);
-    std::vector<GetSFTask> ts(thread_num,GetSFTask());
-    for(int i = 0;i< thread_num; i++){
-        auto &t = ts[i];
-        t.begin = block_len * i;
-        t.end = block_len * (i+1);
-        t.thread_id = i;
-        if(i == thread_num - 1&&(param_list.size() % thread_num != 0)){
-            t.end = param_list.size();
-        }
-        pthread_create(&test_pthread[i],NULL,GetSF_thread_func_f,&t);
-    }
-
-    for(int i = 0;i< thread_num;i++){
-        pthread_join(test_pthread[i],NULL);
-    }
-
-    pthread_mutex_destroy(&mutex2);
-    
-    param_list.clear();
+    Enclave::sfPoolObj_->ProcessBatch(paramList.data(), paramList.size());
 
 #endif
 
@@ -783,14 +657,13 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     //process the unique chunks and update the metadata
     inQueryEntry = inQueryBase;
     outQueryEntry = upOutSGX->outQuery->outQueryBase;
-    currentOffset = 0;
     string tmpChunkAddr;
     tmpChunkAddr.resize(sizeof(RecipeEntry_t), 0);
     InQueryEntry_t* tmpQueryEntry;
     uint32_t tmpChunkSize;
     for (size_t i = 0; i < chunkNum; i++) {
         tmpChunkSize = inQueryEntry->chunkSize;
-        currentOffset += sizeof(uint32_t);
+        currentOffset = inQueryEntry->chunkOffset;
         switch (inQueryEntry->dedupFlag) {
             case DUPLICATE: {
                 // it is duplicate for the min-heap
@@ -866,7 +739,8 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
 
                         }else if (inQueryEntry->chunkAddr.deltaFlag == NO_DELTA){
                             outQueryEntry->deltaFlag = NO_DELTA;
-                            this->ProcessSheUniqueChunk(&inQueryEntry->chunkAddr,recvBuffer + currentOffset, tmpChunkSize, upOutSGX, (uint8_t *)&inQueryEntry->superfeature, (uint8_t *)&outQueryEntry->chunkHash);
+                            this->ProcessSheUniqueChunk(&inQueryEntry->chunkAddr,recvBuffer + currentOffset, tmpChunkSize, upOutSGX, (uint8_t *)&inQueryEntry->superfeature, (uint8_t *)&outQueryEntry->chunkHash,
+                                inQueryEntry->compressedChunk, inQueryEntry->compressedSize);
 
                             _baseChunkNum++;
                             _baseDataSize += inQueryEntry->chunkAddr.length;
@@ -915,7 +789,6 @@ void EcallMeGA::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
         //Ocall_PrintfBinary(&inQueryEntry->chunkHash[0],CHUNK_HASH_SIZE);
 
         inQueryEntry++;
-        currentOffset += tmpChunkSize;
 
         // update the statistic
         _logicalDataSize += tmpChunkSize;
@@ -1178,7 +1051,7 @@ void EcallMeGA::MeGAdeltaTure(InQueryEntry_t *_inQueryEntry, OutQueryEntry_t *_o
         {
             if (!InContainercache_->ExistsInCache(tmpContainerIDStr))
             {
-                InContainercache_->InsertToCache_Offline(tmpContainerIDStr, (char *)_outQueryEntry->containerbuffer,MAX_CONTAINER_SIZE);
+                InContainercache_->InsertToCache_Offline(tmpContainerIDStr, (char *)_outQueryEntry->containerbuffer,_outQueryEntry->containersize);
                 basecontainer_set.insert(tmpContainerIDStr);
                 _outQueryEntry->containerbuffer = InContainercache_->ReadFromCache(tmpContainerIDStr);
                 memcpy(&_inQueryEntry->chunkAddr.basechunkHash, &_outQueryEntry->chunkAddr.basechunkHash, CHUNK_HASH_SIZE);
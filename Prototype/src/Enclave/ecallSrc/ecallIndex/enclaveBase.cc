@@ -12,22 +12,6 @@
 #include "../../include/enclaveBase.h"
 
 
-struct Param
-{
-    int thread_id;
-    unsigned char *ptr;
-    EVP_MD_CTX *mdCtx;
-    uint8_t *SF;
-    EcallCrypto *cryptoObj_;
-};
-
-struct GetSFTask{
-    int begin{0};
-    int end{0};
-    int thread_id;
-};
-
-
 /**
  * @brief Construct a new Enclave Base object
  * 
@@ -152,7 +136,8 @@ void EnclaveBase::UpdateFileRecipe(string& chunkAddrStr, Recipe_t* inRecipe,
  * @param upOutSGX the upload out-enclave var
  */
 void EnclaveBase::ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuffer, 
-    uint32_t chunkSize, UpOutSGX_t* upOutSGX) {
+    uint32_t chunkSize, UpOutSGX_t* upOutSGX, uint8_t* compressedChunk,
+    uint32_t compressedSize) {
     EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
     uint8_t* currentIV = sgxClient->PickNewIV();
     EVP_CIPHER_CTX* cipher = sgxClient->_cipherCtx;
@@ -163,7 +148,13 @@ void EnclaveBase::ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuf
 #if (SGX_BREAKDOWN == 1)
     Ocall_GetCurrentTime(&_startTime);
 #endif
-    tmpCompressedChunkSize = LZ4_compress_fast((char*)(chunkBuffer), (char*)tmpCompressedChunk,chunkSize, chunkSize, 3);
+    if (compressedChunk != NULL) {
+        // reuse the LZ4 form sent by the client
+        memcpy(tmpCompressedChunk, compressedChunk, compressedSize);
+        tmpCompressedChunkSize = compressedSize;
+    } else {
+        tmpCompressedChunkSize = LZ4_compress_fast((char*)(chunkBuffer), (char*)tmpCompressedChunk,chunkSize, chunkSize, 3);
+    }
 
 #if (SGX_BREAKDOWN == 1)
     Ocall_GetCurrentTime(&_endTime);
@@ -277,6 +268,280 @@ double EnclaveBase::GetTimeDiffer(uint64_t sTime, uint64_t eTime) {
     return second;
 }
 
+/**
+ * @brief decrypt a received chunk batch with the session key, and decompress the chunks
+ * sent in the LZ4 form (their compressed form is kept in the query entries)
+ * 
+ * @param recvChunkBuf the recv chunk buffer
+ * @param sgxClient the current client
+ * @return uint8_t* the plaintext batch
+ */
+uint8_t* EnclaveBase::DecryptBatch(SendMsgBuffer_t* recvChunkBuf, EnclaveClient* sgxClient) {
+    uint8_t* recvBuffer = sgxClient->_recvBuffer;
+    uint32_t dataSize = recvChunkBuf->header->dataSize;
+    uint32_t chunkNum = recvChunkBuf->header->currentItemNum;
+    if (chunkNum > Enclave::sendChunkBatchSize_ ||
+        dataSize > Enclave::sendChunkBatchSize_ * sizeof(Chunk_t)) {
+        Ocall_SGX_Exit_Error("EnclaveBase: wrong chunk batch size.");
+    }
+
+    // decrypt the received data with the session key
+    cryptoObj_->SessionKeyDec(sgxClient->_cipherCtx, recvChunkBuf->dataBuffer,
+        dataSize, sgxClient->_sessionKey, recvBuffer);
+
+    // find the chunks sent in the LZ4 form
+    InQueryEntry_t* inQueryEntry = sgxClient->_inQueryBase;
+    uint32_t compressedNum = 0;
+    size_t currentOffset = 0;
+    uint32_t chunkSize;
+    uint32_t bodySize;
+    for (size_t i = 0; i < chunkNum; i++) {
+        if (currentOffset + sizeof(uint32_t) > dataSize) {
+            Ocall_SGX_Exit_Error("EnclaveBase: wrong chunk size in the batch.");
+        }
+        memcpy(&chunkSize, recvBuffer + currentOffset, sizeof(uint32_t));
+        if (chunkSize & CHUNK_COMPRESSED_FLAG) {
+            if (currentOffset + 2 * sizeof(uint32_t) > dataSize ||
+                (chunkSize & ~CHUNK_COMPRESSED_FLAG) > MAX_CHUNK_SIZE) {
+                Ocall_SGX_Exit_Error("EnclaveBase: wrong chunk size in the batch.");
+            }
+            memcpy(&bodySize, recvBuffer + currentOffset + sizeof(uint32_t),
+                sizeof(uint32_t));
+            if (bodySize > dataSize) {
+                Ocall_SGX_Exit_Error("EnclaveBase: wrong chunk size in the batch.");
+            }
+            bodySize += sizeof(uint32_t);
+            compressedNum++;
+        } else if (chunkSize & CHUNK_FP_ONLY_FLAG) {
+            bodySize = CHUNK_HASH_SIZE;
+        } else {
+            if (chunkSize > MAX_CHUNK_SIZE) {
+                Ocall_SGX_Exit_Error("EnclaveBase: wrong chunk size in the batch.");
+            }
+            bodySize = chunkSize;
+        }
+        inQueryEntry->compressedChunk = NULL;
+        currentOffset += sizeof(uint32_t) + bodySize;
+        if (currentOffset > dataSize) {
+            Ocall_SGX_Exit_Error("EnclaveBase: wrong chunk size in the batch.");
+        }
+        inQueryEntry++;
+    }
+    if (compressedNum == 0) {
+        return recvBuffer;
+    }
+
+    // rebuild the plaintext batch, the compressed chunks stay in the recv buffer
+    size_t plainBufferSize = Enclave::sendChunkBatchSize_ * sizeof(Chunk_t);
+    if (sgxClient->_plainBuffer == NULL) {
+        sgxClient->_plainBuffer = (uint8_t*) malloc(plainBufferSize);
+        if (sgxClient->_plainBuffer == NULL) {
+            Ocall_SGX_Exit_Error("EnclaveBase: cannot allocate the plaintext batch buffer.");
+        }
+    }
+    uint8_t* plainBuffer = sgxClient->_plainBuffer;
+    inQueryEntry = sgxClient->_inQueryBase;
+    size_t readOffset = 0;
+    size_t writeOffset = 0;
+    uint32_t compressedSize;
+    for (size_t i = 0; i < chunkNum; i++) {
+        memcpy(&chunkSize, recvBuffer + readOffset, sizeof(uint32_t));
+        if (chunkSize & CHUNK_COMPRESSED_FLAG) {
+            chunkSize &= ~CHUNK_COMPRESSED_FLAG;
+            memcpy(&compressedSize, recvBuffer + readOffset + sizeof(uint32_t),
+                sizeof(uint32_t));
+            readOffset += 2 * sizeof(uint32_t);
+            if (writeOffset + sizeof(uint32_t) + chunkSize > plainBufferSize) {
+                Ocall_SGX_Exit_Error("EnclaveBase: the plaintext batch is too large.");
+            }
+            if (chunkSize > MAX_CHUNK_SIZE || compressedSize >= chunkSize ||
+                LZ4_decompress_safe((char*)recvBuffer + readOffset,
+                (char*)plainBuffer + writeOffset + sizeof(uint32_t), compressedSize,
+                chunkSize) != (int)chunkSize) {
+                Ocall_SGX_Exit_Error("EnclaveBase: cannot decompress the chunk.");
+            }
+            memcpy(plainBuffer + writeOffset, &chunkSize, sizeof(uint32_t));
+            inQueryEntry->compressedChunk = recvBuffer + readOffset;
+            inQueryEntry->compressedSize = compressedSize;
+            readOffset += compressedSize;
+            writeOffset += sizeof(uint32_t) + chunkSize;
+        } else {
+            bodySize = (chunkSize & CHUNK_FP_ONLY_FLAG) ? CHUNK_HASH_SIZE : chunkSize;
+            if (writeOffset + sizeof(uint32_t) + bodySize > plainBufferSize) {
+                Ocall_SGX_Exit_Error("EnclaveBase: the plaintext batch is too large.");
+            }
+            memcpy(plainBuffer + writeOffset, recvBuffer + readOffset,
+                sizeof(uint32_t) + bodySize);
+            readOffset += sizeof(uint32_t) + bodySize;
+            writeOffset += sizeof(uint32_t) + bodySize;
+        }
+        inQueryEntry++;
+    }
+    return plainBuffer;
+}
+
+/**
+ * @brief parse a chunk of the received batch: compute the hash over the plaintext chunk,
+ * or take the fingerprint sent instead of the body of a pre-filtered chunk
+ * 
+ * @param mdCtx the hash ctx
+ * @param recvBuffer the decrypted batch
+ * @param currentOffset the offset of the chunk in the batch, moved to the next chunk
+ * @param inQueryEntry the query entry of the chunk
+ * @return true the chunk body is received
+ * @return false only the fingerprint is received
+ */
+bool EnclaveBase::ParseChunk(EVP_MD_CTX* mdCtx, uint8_t* recvBuffer, size_t& currentOffset,
+    InQueryEntry_t* inQueryEntry) {
+    memcpy(&inQueryEntry->chunkSize, recvBuffer + currentOffset,
+        sizeof(uint32_t));
+    currentOffset += sizeof(uint32_t);
+    inQueryEntry->chunkOffset = currentOffset;
+
+    if (inQueryEntry->chunkSize & CHUNK_FP_ONLY_FLAG) {
+        // the enclave reported this chunk as duplicate in the fingerprint batch
+        inQueryEntry->chunkSize &= ~CHUNK_FP_ONLY_FLAG;
+        inQueryEntry->fpOnlyFlag = 1;
+        memcpy(inQueryEntry->chunkHash, recvBuffer + currentOffset, CHUNK_HASH_SIZE);
+        currentOffset += CHUNK_HASH_SIZE;
+        return false;
+    }
+
+    inQueryEntry->fpOnlyFlag = 0;
+    cryptoObj_->GenerateHash(mdCtx, recvBuffer + currentOffset,
+        inQueryEntry->chunkSize, inQueryEntry->chunkHash);
+    currentOffset += inQueryEntry->chunkSize;
+    return true;
+}
+
+/**
+ * @brief check that no unique chunk of the batch is pre-filtered (i.e., has no body)
+ * 
+ * @param inQueryBase the in-enclave query entries of the batch
+ * @param outQueryBase the out-enclave query entries of the batch
+ * @param chunkNum the number of chunks in the batch
+ */
+void EnclaveBase::CheckChunkBody(InQueryEntry_t* inQueryBase, OutQueryEntry_t* outQueryBase,
+    uint32_t chunkNum) {
+    InQueryEntry_t* inQueryEntry = inQueryBase;
+    OutQueryEntry_t* outQueryEntry = outQueryBase;
+    for (size_t i = 0; i < chunkNum; i++) {
+        if (inQueryEntry->dedupFlag == UNIQUE) {
+            if (outQueryEntry->dedupFlag == UNIQUE && inQueryEntry->fpOnlyFlag) {
+                Ocall_SGX_Exit_Error("EnclaveBase: the body of a pre-filtered chunk is missing.");
+            }
+            outQueryEntry++;
+        }
+        inQueryEntry++;
+    }
+    return ;
+}
+
+/**
+ * @brief check whether a chunk is in the in-enclave (top-k) index
+ * 
+ * @param chunkFp the chunk fp
+ * @return true it is in the index
+ * @return false it is not in the index (or there is no in-enclave index)
+ */
+bool EnclaveBase::CheckInsideIndex(const string& chunkFp) {
+    return false;
+}
+
+/**
+ * @brief answer a fingerprint batch with the duplicate bitmap (the indexes are only queried)
+ * 
+ * @param recvFpBuf the recv fingerprint buffer, the encrypted bitmap is written back to it
+ * @param upOutSGX the pointer to enclave-related var
+ */
+void EnclaveBase::ProcessFpBatch(SendMsgBuffer_t* recvFpBuf, UpOutSGX_t* upOutSGX) {
+    // the in-enclave info
+    EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
+    EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
+    uint8_t* recvBuffer = sgxClient->_recvBuffer;
+    uint8_t* sessionKey = sgxClient->_sessionKey;
+    InQueryEntry_t* inQueryBase = sgxClient->_inQueryBase;
+    OutQueryEntry_t* outQueryBase = upOutSGX->outQuery->outQueryBase;
+
+    uint32_t fpNum = recvFpBuf->header->currentItemNum;
+    if (fpNum > Enclave::sendChunkBatchSize_ ||
+        recvFpBuf->header->dataSize != fpNum * CHUNK_HASH_SIZE) {
+        Ocall_SGX_Exit_Error("EnclaveBase: wrong fingerprint batch size.");
+    }
+
+    // decrypt the received fingerprints with the session key
+    cryptoObj_->SessionKeyDec(cipherCtx, recvFpBuf->dataBuffer,
+        recvFpBuf->header->dataSize, sessionKey, recvBuffer);
+
+    // tmp var
+    OutQueryEntry_t* outQueryEntry = outQueryBase;
+    InQueryEntry_t* inQueryEntry = inQueryBase;
+    uint32_t outQueryNum = 0;
+    string tmpHashStr;
+    tmpHashStr.resize(CHUNK_HASH_SIZE, 0);
+
+{
+#if (MULTI_CLIENT == 1)
+    Enclave::topKIndexLck_.lock();
+#endif
+    // check the local batch index and the top-k index
+    for (size_t i = 0; i < fpNum; i++) {
+        tmpHashStr.assign((char*)recvBuffer + i * CHUNK_HASH_SIZE, CHUNK_HASH_SIZE);
+        if (sgxClient->_localIndex.find(tmpHashStr) != sgxClient->_localIndex.end()) {
+            // a repeated fp in this batch, its first copy brings the body (if needed)
+            inQueryEntry->dedupFlag = DUPLICATE;
+        } else {
+            if (this->CheckInsideIndex(tmpHashStr)) {
+                inQueryEntry->dedupFlag = DUPLICATE;
+            } else {
+                // encrypt its fingerprint, write to the outside buffer
+                cryptoObj_->IndexAESCMCEnc(cipherCtx, recvBuffer + i * CHUNK_HASH_SIZE,
+                    CHUNK_HASH_SIZE, Enclave::indexQueryKey_, outQueryEntry->chunkHash);
+                inQueryEntry->dedupFlag = UNIQUE;
+                inQueryEntry->chunkAddr.offset = outQueryNum;
+                outQueryEntry++;
+                outQueryNum++;
+            }
+            sgxClient->_localIndex[tmpHashStr] = i;
+        }
+        inQueryEntry++;
+    }
+#if (MULTI_CLIENT == 1)
+    Enclave::topKIndexLck_.unlock();
+#endif
+}
+
+    // check the out-enclave index
+    if (outQueryNum != 0) {
+        upOutSGX->outQuery->queryNum = outQueryNum;
+        Ocall_QueryOutIndex(upOutSGX->outClient);
+        _Inline_Ocall++;
+        _Inline_FPOcall++;
+    }
+
+    // set the bit of each duplicate chunk
+    uint32_t bitmapSize = (fpNum + 7) / 8;
+    vector<uint8_t> bitmap(bitmapSize, 0);
+    inQueryEntry = inQueryBase;
+    for (size_t i = 0; i < fpNum; i++) {
+        if (inQueryEntry->dedupFlag == DUPLICATE ||
+            outQueryBase[inQueryEntry->chunkAddr.offset].dedupFlag == DUPLICATE) {
+            bitmap[i / 8] |= (1 << (i % 8));
+        }
+        inQueryEntry++;
+    }
+
+    // encrypt the bitmap with the session key, write back to the recv buffer
+    cryptoObj_->SessionKeyEnc(cipherCtx, bitmap.data(), bitmapSize, sessionKey,
+        recvFpBuf->dataBuffer);
+    recvFpBuf->header->dataSize = bitmapSize;
+
+    // nothing to update in the out-enclave index
+    upOutSGX->outQuery->queryNum = 0;
+    sgxClient->_localIndex.clear();
+    return ;
+}
+
 /**
  * @brief reset the value of current segment
  * 
@@ -290,7 +555,8 @@ void EnclaveBase::ResetCurrentSegment(EnclaveClient* sgxClient) {
 }
 
 void EnclaveBase::ProcessSheUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuffer, 
-    uint32_t chunkSize, UpOutSGX_t* upOutSGX, uint8_t* chunksf, uint8_t* chunkfp) {
+    uint32_t chunkSize, UpOutSGX_t* upOutSGX, uint8_t* chunksf, uint8_t* chunkfp,
+    uint8_t* compressedChunk, uint32_t compressedSize) {
     EnclaveClient* sgxClient = (EnclaveClient*)upOutSGX->sgxClient;
     uint8_t* currentIV = sgxClient->PickNewIV();
     EVP_CIPHER_CTX* cipher = sgxClient->_cipherCtx;
@@ -304,7 +570,13 @@ void EnclaveBase::ProcessSheUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunk
 #if (EDR_BREAKDOWN == 1)
     Ocall_GetCurrentTime(&_startTime);
 #endif
-        tmpCompressedChunkSize = LZ4_compress_fast((char*)(chunkBuffer), (char*)tmpCompressedChunk,chunkSize, chunkSize, 3);
+        if (compressedChunk != NULL) {
+            // reuse the LZ4 form sent by the client
+            memcpy(tmpCompressedChunk, compressedChunk, compressedSize);
+            tmpCompressedChunkSize = compressedSize;
+        } else {
+            tmpCompressedChunkSize = LZ4_compress_fast((char*)(chunkBuffer), (char*)tmpCompressedChunk,chunkSize, chunkSize, 3);
+        }
         
 #if (EDR_BREAKDOWN == 1)
     Ocall_GetCurrentTime(&_endTime);
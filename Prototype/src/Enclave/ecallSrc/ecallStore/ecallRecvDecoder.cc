@@ -21,7 +21,6 @@ int lz4_flag = 0;
 int recipe_num = 0;
 
 size_t delta_num_0 =0 ;
-vector<string> Container_list;
 
 /**
  * @brief Construct a new EcallRecvDecoder object
@@ -29,6 +28,11 @@ vector<string> Container_list;
  */
 EcallRecvDecoder::EcallRecvDecoder() {
     cryptoObj_ = new EcallCrypto(CIPHER_TYPE, HASH_TYPE);
+    if (Enclave::decodeThreadNum_ != 0) {
+        // the workers live until the restore enclave is destroyed
+        restorePool_ = new EcallWorkerPool("EcallRestorePool", Enclave::decodeThreadNum_,
+            poolHandler_, this);
+    }
     Enclave::Logging(myName_.c_str(), "init the RecvDecoder.\n");
 }
 
@@ -43,6 +47,9 @@ EcallRecvDecoder::~EcallRecvDecoder() {
     Enclave::Logging(myName_.c_str(), "total restore_time: %lu\n", _restoretime);
     Enclave::Logging(myName_.c_str(), "total delta restore_time: %lu\n", _deltarestoretime);
     Enclave::Logging(myName_.c_str(), "===================================\n"); */
+    if (restorePool_ != NULL) {
+        delete restorePool_;
+    }
     delete(cryptoObj_);
 }
 
@@ -154,37 +161,21 @@ void EcallRecvDecoder::ProcRecipeBatch(uint8_t* recipeBuffer, size_t recipeNum,
     ResOutSGX_t* resOutSGX) {
     // out-enclave info
     Ocall_GetCurrentTime(&_starttime);
-    ReqContainer_t* reqContainer = (ReqContainer_t*)resOutSGX->reqContainer;
-    uint8_t* idBuffer = reqContainer->idBuffer;
-    uint8_t** containerArray = reqContainer->containerArray;
-    SendMsgBuffer_t* sendChunkBuf = resOutSGX->sendChunkBuf;
-
     OutQueryEntry_t *baseQueryBase = resOutSGX->baseQuery->outQueryBase;
     OutQueryEntry_t *baseQueryEntry = baseQueryBase;
-    uint32_t total_batch_size = 0;
-    for(int i = 0;i<resOutSGX->baseQuery->queryNum;i++){
-        baseQueryEntry++;
-    }
     // wj: test get one container
     // ReqOneContainer_t * reqOneContainer =  (ReqOneContainer_t*)resOutSGX->reqOneContainer;
     // uint8_t* ContainerId = reqOneContainer->id;
  
 
-
-    OutQueryEntry_t *tmpEntry;
-    tmpEntry = (OutQueryEntry_t *)malloc(sizeof(OutQueryEntry_t));
-
     // in-enclave info
     EnclaveClient* sgxClient = (EnclaveClient*)resOutSGX->sgxClient;
-    SendMsgBuffer_t* restoreChunkBuf = &sgxClient->_restoreChunkBuffer;
     EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
     uint8_t* masterKey = sgxClient->_masterKey;
+    RestoreWindow_t* openWindow = &sgxClient->_openWindow;
 
     string tmpContainerIDStr;
     string tmpBaseContainerIDStr;
-    unordered_map<string, uint32_t> tmpContainerMap;
-    tmpContainerMap.reserve(CONTAINER_CAPPING_VALUE);
     EnclaveRecipeEntry_t tmpEnclaveRecipeEntry;
     EnclaveRecipeEntry_t tmpEnclaveBaseRecipeEntry;
 
@@ -229,285 +220,109 @@ void EcallRecvDecoder::ProcRecipeBatch(uint8_t* recipeBuffer, size_t recipeNum,
     //Enclave::Logging("DEBUG", "recipenum is %d\n", recipeNum);
     
     uint8_t* tmpEncValue = (uint8_t*)malloc(sizeof(RecipeEntry_t));
-    uint8_t* tmpDecValue = (uint8_t*)malloc(sizeof(RecipeEntry_t));
     //Enclave::Logging("DEBUG", "recipeNum is %d\n", recipeNum);
 
+    // decrypt all recipe entries, and collect the unique base chunk fps of the delta chunks
+    RecipeEntry_t* plainRecipeBase = (RecipeEntry_t*)sgxClient->_plainRecipeBuffer;
+    vector<uint32_t> baseSlotList(recipeNum, 0);
+    unordered_map<string, uint32_t> baseSlotMap;
+    string tmpBaseFpStr;
+    for (size_t i = 0; i < recipeNum; i++) {
+        memcpy(tmpEncValue, fileRecipes + i * sizeof(RecipeEntry_t), sizeof(RecipeEntry_t));
+        cryptoObj_->AESCBCDec(cipherCtx, tmpEncValue, sizeof(RecipeEntry_t), Enclave::indexQueryKey_,
+            (uint8_t*)&plainRecipeBase[i]);
+        if (plainRecipeBase[i].deltaFlag != DELTA) {
+            continue;
+        }
+        delta_num_0++;
+        tmpBaseFpStr.assign((char*)plainRecipeBase[i].basechunkHash, CHUNK_HASH_SIZE);
+        auto findResult = baseSlotMap.find(tmpBaseFpStr);
+        if (findResult == baseSlotMap.end()) {
+            baseSlotList[i] = resOutSGX->baseQuery->queryNum;
+            baseSlotMap[tmpBaseFpStr] = resOutSGX->baseQuery->queryNum;
+            memcpy(baseQueryEntry->chunkHash, plainRecipeBase[i].basechunkHash, CHUNK_HASH_SIZE);
+            baseQueryEntry++;
+            resOutSGX->baseQuery->queryNum++;
+        } else {
+            baseSlotList[i] = findResult->second;
+        }
+        delta_rec_num++;
+    }
+
+    // resolve the addresses of all base chunks of this batch in one query
+    vector<RecipeEntry_t> baseAddrList(resOutSGX->baseQuery->queryNum);
+    if (resOutSGX->baseQuery->queryNum != 0) {
+        Ocall_QueryBaseIndex(resOutSGX->outClient);
+        baseQueryEntry = baseQueryBase;
+        for (size_t i = 0; i < resOutSGX->baseQuery->queryNum; i++) {
+            cryptoObj_->AESCBCDec(cipherCtx, (uint8_t*)&baseQueryEntry->chunkAddr,
+                sizeof(RecipeEntry_t), Enclave::indexQueryKey_, (uint8_t*)&baseAddrList[i]);
+            baseQueryEntry++;
+        }
+        baseQueryEntry = baseQueryBase;
+        resOutSGX->baseQuery->queryNum = 0;
+    }
+
     RecipeEntry_t* tmpRecipeEntry;
     //Enclave::Logging("DEBUG", "Outside recipeNum is %d\n", recipeNum);
     for (size_t i = 0; i < recipeNum; i++) {
-        if(i%100 == 0){
-        //Enclave::Logging(myName_.c_str(), "restore %d chunk\n",i);
+        tmpRecipeEntry = &plainRecipeBase[i];
+
+        if (Enclave::faaSlotNum_ != 0) {
+            // plan the reads of the chunk (and its base chunk) into the forward assembly area
+            if (tmpRecipeEntry->deltaFlag == DELTA) {
+                this->AddFaaChunk(sgxClient, tmpRecipeEntry, &baseAddrList[baseSlotList[i]]);
+            } else {
+                this->AddFaaChunk(sgxClient, tmpRecipeEntry, NULL);
+            }
+            // judge whether the area is full, the next entry may take two slots (the chunk and its base)
+            if ((openWindow->chunkBaseList.size() + openWindow->baseSlotNum + 2) >
+                Enclave::faaSlotNum_) {
+                this->CloseWindow(sgxClient, resOutSGX);
+            }
+            continue;
         }
-        //parse the recipe entry one-by-one
-        // uint8_t* value;
-        // Ocall_ReadIndexStore(&status, (char*)&tmpCryptChunkHash[i*CHUNK_HASH_SIZE], CHUNK_HASH_SIZE, &value, &expectedBufferSize, resOutSGX->outClient);
-        
-        memset(tmpEncValue, 0, sizeof(RecipeEntry_t));
-        memset(tmpDecValue, 0, sizeof(RecipeEntry_t));
-            
-        memcpy(tmpEncValue, fileRecipes + i * sizeof(RecipeEntry_t), sizeof(RecipeEntry_t));
-        //Enclave::Logging("debug", "decrypt3\n");
-        cryptoObj_->AESCBCDec(cipherCtx, tmpEncValue, sizeof(RecipeEntry_t), Enclave::indexQueryKey_, tmpDecValue);
-        //Enclave::Logging("debug", "decrypt4\n");
-        tmpRecipeEntry = (RecipeEntry_t*)tmpDecValue;
 
         tmpContainerIDStr.assign((char*)tmpRecipeEntry->containerName, CONTAINER_ID_LENGTH);
 
-        
-
         tmpEnclaveRecipeEntry.offset = tmpRecipeEntry->offset;
         tmpEnclaveRecipeEntry.length = tmpRecipeEntry->length;
         tmpEnclaveRecipeEntry.deltaFlag = tmpRecipeEntry->deltaFlag;
         if(tmpEnclaveRecipeEntry.deltaFlag == DELTA){
-            //if chunk is a delta chunk, save basechunk fp to basequeryentry(out-enclave)
-            delta_num_0++;
-            if(resOutSGX->baseQuery->queryNum <  5){
-                memcpy(tmpEnclaveRecipeEntry.basechunkHash,tmpRecipeEntry->basechunkHash,CHUNK_HASH_SIZE);
-                resOutSGX->baseQuery->queryNum++;
-                //Enclave::Logging("debug", "squery num is %d and delta num is %d\n", resOutSGX->baseQuery->queryNum, delta_num_0);
-                memcpy((uint8_t *)&baseQueryEntry->chunkHash,(uint8_t *)&tmpRecipeEntry->basechunkHash,CHUNK_HASH_SIZE);
-                baseQueryEntry++;
-                delta_rec_num++;
-            } else if(resOutSGX->baseQuery->queryNum == 5)
-            {
-                Ocall_QueryBaseIndex(resOutSGX->outClient);
-                baseQueryEntry = baseQueryBase;
-                for(int i = 0;i<resOutSGX->baseQuery->queryNum;i++){
-                    //decrypto basechunk recipe
-                    //Enclave::Logging("debug", "decrypt0\n");
-                    cryptoObj_->AESCBCDec(cipherCtx, (uint8_t *)&baseQueryEntry->chunkAddr, sizeof(RecipeEntry_t), Enclave::indexQueryKey_, (uint8_t *)&tmpEntry->chunkAddr);
-                    //Enclave::Logging("debug", "decrypt1\n");
-                    tmpEnclaveBaseRecipeEntry.offset = tmpEntry->chunkAddr.offset;
-                    tmpEnclaveBaseRecipeEntry.length = tmpEntry->chunkAddr.length;
-                    tmpEnclaveBaseRecipeEntry.deltaFlag = tmpEntry->chunkAddr.deltaFlag;
-                    tmpBaseContainerIDStr.assign((char*)tmpEntry->chunkAddr.containerName, CONTAINER_ID_LENGTH);
-                    auto findResult = tmpContainerMap.find(tmpBaseContainerIDStr);
-                    if(findResult == tmpContainerMap.end())
-                    {
-                        tmpEnclaveBaseRecipeEntry.containerID = reqContainer->idNum;
-                        tmpContainerMap[tmpBaseContainerIDStr] = reqContainer->idNum;
-                        memcpy(idBuffer + reqContainer->idNum * CONTAINER_ID_LENGTH, 
-                                tmpBaseContainerIDStr.c_str(), CONTAINER_ID_LENGTH);
-                        reqContainer->idNum++;
-                    } else 
-                    {
-                        tmpEnclaveBaseRecipeEntry.containerID = findResult->second;
-                    }
-                    sgxClient->_baseRecipeBuffer.push_back(tmpEnclaveBaseRecipeEntry);
-                    //Enclave::Logging("debug","a base chunk buffer size is %d\n", sgxClient->_baseRecipeBuffer.size());
-                    baseQueryEntry++;
-                }
-                baseQueryEntry = baseQueryBase;
-                //Enclave::Logging("debug", "aquery num is %d and delta num is %d\n", resOutSGX->baseQuery->queryNum, delta_num_0);
-    
-                memcpy(tmpEnclaveRecipeEntry.basechunkHash,tmpRecipeEntry->basechunkHash,CHUNK_HASH_SIZE);
-                //Enclave::Logging("debug", "squery num is %d and delta num is %d\n", resOutSGX->baseQuery->queryNum, delta_num_0);
-                memcpy((uint8_t *)&baseQueryEntry->chunkHash,(uint8_t *)&tmpRecipeEntry->basechunkHash,CHUNK_HASH_SIZE);
-                baseQueryEntry++;
-                delta_rec_num++;
-                resOutSGX->baseQuery->queryNum = 1;
-            }
-            //Enclave::Logging("recvDecoder", "offset is %d\n", tmpEnclaveRecipeEntry.offset);
-        }
-
-        //1.ocall 2.baserecipe buffer 3. idnum++
-        
-        auto findResult = tmpContainerMap.find(tmpContainerIDStr);
-        if (findResult == tmpContainerMap.end()) {
-            // this is a unique container entry, it does not exist in current local index
-            tmpEnclaveRecipeEntry.containerID = reqContainer->idNum;
-            tmpContainerMap[tmpContainerIDStr] = reqContainer->idNum;
-            
-            memcpy(idBuffer + reqContainer->idNum * CONTAINER_ID_LENGTH, 
-                tmpContainerIDStr.c_str(), CONTAINER_ID_LENGTH);
-            reqContainer->idNum++;
-        } else {
-            // this is a duplicate container entry, using existing result.
-            tmpEnclaveRecipeEntry.containerID = findResult->second;
+            //if chunk is a delta chunk, add the container of its base chunk to the window
+            memcpy(tmpEnclaveRecipeEntry.basechunkHash, tmpRecipeEntry->basechunkHash, CHUNK_HASH_SIZE);
+            RecipeEntry_t* baseAddr = &baseAddrList[baseSlotList[i]];
+            tmpEnclaveBaseRecipeEntry.offset = baseAddr->offset;
+            tmpEnclaveBaseRecipeEntry.length = baseAddr->length;
+            tmpEnclaveBaseRecipeEntry.deltaFlag = baseAddr->deltaFlag;
+            tmpBaseContainerIDStr.assign((char*)baseAddr->containerName, CONTAINER_ID_LENGTH);
+            tmpEnclaveBaseRecipeEntry.containerID = this->AddWindowContainer(sgxClient,
+                tmpBaseContainerIDStr);
+            openWindow->baseRecipeList.push_back(tmpEnclaveBaseRecipeEntry);
         }
 
-        sgxClient->_enclaveRecipeBuffer.push_back(tmpEnclaveRecipeEntry);
-        
-        Container_list.push_back(tmpContainerIDStr);
-
-        // judge whether reach the capping value 
-        //Enclave::Logging("debug", "id num is %d and query num is %d\n",reqContainer->idNum, resOutSGX->baseQuery->queryNum);
-        if ((reqContainer->idNum + resOutSGX->baseQuery->queryNum ) >= CONTAINER_CAPPING_VALUE) {
-
-            // start to let outside application to fetch the container data
-            //Enclave::Logging("debug", "reach capping value\n");
-            if(resOutSGX->baseQuery->queryNum != 0)
-            {
-                Ocall_QueryBaseIndex(resOutSGX->outClient);
-                baseQueryEntry = baseQueryBase;
-                //Enclave::Logging("debug", "query num is %d\n", resOutSGX->baseQuery->queryNum);
-                for(int i = 0;i<resOutSGX->baseQuery->queryNum;i++){
-                    //decrypto basechunk recipe
-                    //Enclave::Logging("debug", "decrypt0\n");
-                    cryptoObj_->AESCBCDec(cipherCtx, (uint8_t *)&baseQueryEntry->chunkAddr, sizeof(RecipeEntry_t), Enclave::indexQueryKey_, (uint8_t *)&tmpEntry->chunkAddr);
-                    //Enclave::Logging("debug", "decrypt1\n");
-                    tmpEnclaveBaseRecipeEntry.offset = tmpEntry->chunkAddr.offset;
-                    tmpEnclaveBaseRecipeEntry.length = tmpEntry->chunkAddr.length;
-                    tmpEnclaveBaseRecipeEntry.deltaFlag = tmpEntry->chunkAddr.deltaFlag;
-                    tmpBaseContainerIDStr.assign((char*)tmpEntry->chunkAddr.containerName, CONTAINER_ID_LENGTH);
-                    auto findResult = tmpContainerMap.find(tmpBaseContainerIDStr);
-                    if(findResult == tmpContainerMap.end())
-                    {
-                        tmpEnclaveBaseRecipeEntry.containerID = reqContainer->idNum;
-                        tmpContainerMap[tmpBaseContainerIDStr] = reqContainer->idNum;
-                        memcpy(idBuffer + reqContainer->idNum * CONTAINER_ID_LENGTH, 
-                                tmpBaseContainerIDStr.c_str(), CONTAINER_ID_LENGTH);
-                        reqContainer->idNum++;
-                    } else 
-                    {
-                        tmpEnclaveBaseRecipeEntry.containerID = findResult->second;
-                    }
-                    sgxClient->_baseRecipeBuffer.push_back(tmpEnclaveBaseRecipeEntry);
-                    //Enclave::Logging("debug","b base chunk buffer size is %d\n", sgxClient->_baseRecipeBuffer.size());
-                    baseQueryEntry++;
-                }
-                baseQueryEntry = baseQueryBase;
-                resOutSGX->baseQuery->queryNum = 0;
-            }
-
-            Ocall_GetReqContainers(resOutSGX->outClient);
-            size_t bidx = 0;
-            for (size_t idx = 0; idx < sgxClient->_enclaveRecipeBuffer.size(); idx++) {
-                //Enclave::Logging("debug", "idx is %d\n", idx);
-                uint32_t containerID = sgxClient->_enclaveRecipeBuffer[idx].containerID;
-                uint32_t offset = sgxClient->_enclaveRecipeBuffer[idx].offset;
-                uint32_t chunkSize = sgxClient->_enclaveRecipeBuffer[idx].length;
-                uint8_t deltaflag = sgxClient->_enclaveRecipeBuffer[idx].deltaFlag;
-                uint8_t* chunkBuffer = containerArray[containerID] + offset + sizeof(RecipeEntry_t) + 4*CHUNK_HASH_SIZE;
-               // Enclave::Logging("debug", "start process delta\n");
-                if(deltaflag == DELTA){
-                    //Enclave::Logging("debug", "delta chunk\n");
-                    Ocall_GetCurrentTime(&_starttime1);
-                    //restore delta chunk
-                    uint8_t* iv = chunkBuffer+chunkSize;
-                    uint8_t* outputBuffer = restoreChunkBuf->dataBuffer + restoreChunkBuf->header->dataSize;
-                    uint8_t decompressedChunk[MAX_CHUNK_SIZE];
-                    //decrypto the delta chunk with iv_key
-                    //Enclave::Logging("debug", "start decrypt delta chunk\n");
-                    cryptoObj_->DecryptionWithKeyIV(cipherCtx, chunkBuffer, chunkSize, 
-                        Enclave::enclaveKey_, decompressedChunk, iv);
-                    //Enclave::Logging("debug", "decrypt delta chunk end\n");
-                    
-                    uint8_t decompressbaseChunk[MAX_CHUNK_SIZE];
-                    //Enclave::Logging("debug","c base chunk buffer size is %d\n", sgxClient->_baseRecipeBuffer.size());
-                    //Enclave::Logging("debug", "bidx is %d\n", bidx);
-                    //uint8_t* basechunkBuffer = baseQueryEntry->containerbuffer+baseQueryEntry->chunkAddr.offset+sizeof(RecipeEntry_t) + 4*CHUNK_HASH_SIZE;
-                    //Enclave::Logging("debug", "1\n");
-                    uint32_t baseContainerId = sgxClient->_baseRecipeBuffer[bidx].containerID;
-                    //Enclave::Logging("debug", "container id is %d\n", sgxClient->_baseRecipeBuffer[bidx].containerID);
-                    //Enclave::Logging("debug", "2\n");
-                    uint32_t baseChunkOffset = sgxClient->_baseRecipeBuffer[bidx].offset;
-                    //Enclave::Logging("debug", "3\n");
-                    uint32_t baseChunkLength = sgxClient->_baseRecipeBuffer[bidx].length;
-                    //Enclave::Logging("debug", "4\n");
-                    uint8_t* basechunkBuffer = containerArray[baseContainerId] + baseChunkOffset + sizeof(RecipeEntry_t)+4*CHUNK_HASH_SIZE;
-                    //uint8_t* basechunkBuffer = containerArray[baseContainerId];
-                    //Enclave::Logging("debug", "5\n");
-                    iv = basechunkBuffer + baseChunkLength;
-                    //Enclave::Logging("debug", "6\n");
-                    bidx++;
-                    //decrpto the base chunk with iv_key  
-                    //Enclave::Logging("debug", "start decrypt base chunk\n");
-                    cryptoObj_->DecryptionWithKeyIV(cipherCtx, basechunkBuffer, baseChunkLength, 
-                        Enclave::enclaveKey_, decompressbaseChunk, iv);
-                    //Enclave::Logging("debug", "decrypt base chunk end\n");
-                    uint8_t lz4decompressbaseChunk[MAX_CHUNK_SIZE];
-                    uint8_t *recchunk;
-                    size_t recchunk_size;
-                    //decompress basechunk with lz4
-                    int decompressedSize = LZ4_decompress_safe((char*)decompressbaseChunk, (char*)lz4decompressbaseChunk,baseChunkLength, MAX_CHUNK_SIZE);
-                    if(decompressedSize > 0){
-                    //base chunk can decompress, use decompressed chunk as basechunk
-                    //Enclave::Logging("debug", "xdelta decode start\n");
-                    recchunk = ed3_decode((uint8_t*)&decompressedChunk, chunkSize,(uint8_t*)&lz4decompressbaseChunk, decompressedSize, &recchunk_size);
-                    }else{
-                    //base chunk can decompress, use it as basechunk
-                    recchunk = ed3_decode((uint8_t*)&decompressedChunk, chunkSize,(uint8_t*)&decompressbaseChunk, baseChunkLength, &recchunk_size);
-                    }
-                    delta_num++;
-                    //Enclave::Logging("debug", "xdelta decode end\n");
-                    if(recchunk_size == 0){
-                        Enclave::Logging(myName_.c_str(), "recchunk chunk size: %d\n", recchunk_size);
-                        Enclave::Logging(myName_.c_str(), "offset: %d\n", offset);
-                        Enclave::Logging(myName_.c_str(), "container id: %d\n", containerID);
-                    }
-                    //Enclave::Logging("debug", "xrestore succeed\n");
-
-
-                    //
-                    //Enclave::Logging(myName_.c_str(), "recchunk chunk num: %d\n", delta_num);
-                    memcpy(outputBuffer, &recchunk_size, sizeof(uint32_t));
-                    memcpy(outputBuffer + sizeof(uint32_t), recchunk, recchunk_size);
-                    restoreChunkBuf->header->dataSize += sizeof(uint32_t) + recchunk_size;
-                    total_batch_size += recchunk_size;
-                    total_datasize = recchunk_size+total_datasize;
-                    total_deltasize = recchunk_size+total_deltasize;
-                    free(recchunk);
-                    //Enclave::Logging("debug", "memcpy done\n");
-             
-                    restoreChunkBuf->header->currentItemNum++;
-                    Ocall_GetCurrentTime(&_endtime1);
-                    _deltarestoretime += _endtime1 - _starttime1;
-                }else{
-                    //restore unique chunk
-                    this->RecoverOneChunk(chunkBuffer, chunkSize, restoreChunkBuf, cipherCtx);
-                    if(lz4_flag == 1){
-                        tmpContainerIDStr.assign((char*)idBuffer + containerID * CONTAINER_ID_LENGTH, CONTAINER_ID_LENGTH);
-  
-                        for(int i = 0;i<reqContainer->idNum;i++){
-                            tmpContainerIDStr.assign((char*)idBuffer + i * CONTAINER_ID_LENGTH, CONTAINER_ID_LENGTH);
-
-                        }
-                    }
-                    lz4_flag = 0;
+        tmpEnclaveRecipeEntry.containerID = this->AddWindowContainer(sgxClient, tmpContainerIDStr);
+        openWindow->recipeList.push_back(tmpEnclaveRecipeEntry);
 
-                }
-
-                recipe_num++;
-
-                
-                //Enclave::Logging("debug", "start sending data\n");
-                if (restoreChunkBuf->header->currentItemNum % 
-                    Enclave::sendChunkBatchSize_ == 0) {
-                    cryptoObj_->SessionKeyEnc(cipherCtx, restoreChunkBuf->dataBuffer,
-                        restoreChunkBuf->header->dataSize, sessionKey, sendChunkBuf->dataBuffer);
-                    
-                    // copy the header to the send buffer
-                    restoreChunkBuf->header->messageType = SERVER_RESTORE_CHUNK;
-                    memcpy(sendChunkBuf->header, restoreChunkBuf->header, sizeof(NetworkHead_t));
-                    //Enclave::Logging("DEBUG", "processOneBatch buf size is %d\n", restoreChunkBuf->header->dataSize);
-                    Ocall_SendRestoreData(resOutSGX->outClient);
-                    restoreChunkBuf->header->dataSize = 0;
-                    restoreChunkBuf->header->currentItemNum = 0;
-                }
-                //Enclave::Logging("debug", "sending data end\n");
-            }
-            
-
-            // reset 
-            Ocall_FreeContainer(resOutSGX->outClient);
-            reqContainer->idNum = 0;
-            //Enclave::Logging(myName_.c_str(), "a id Num is %d\n", reqContainer->idNum);
-            tmpContainerMap.clear();
-            sgxClient->_enclaveRecipeBuffer.clear();
-            sgxClient->_baseRecipeBuffer.clear();
-            baseQueryEntry = baseQueryBase;
-            resOutSGX->baseQuery->queryNum = 0;
-            Container_list.clear();
+        // judge whether reach the capping value, the next entry may add two containers (the chunk and its base)
+        if ((sgxClient->_openWindowMap.size() + 2) > CONTAINER_CAPPING_VALUE) {
+            this->CloseWindow(sgxClient, resOutSGX);
         }
     }
-    free(tmpEntry);
+    sgxClient->_recipeBatchID++;
+
+    // decode the windows resolved RESTORE_LOOKAHEAD_BATCH batches ago, the later ones are prefetched
+    deque<RestoreWindow_t>* windowList = &sgxClient->_restoreWindowList;
+    while (!windowList->empty() && (windowList->front().batchID + RESTORE_LOOKAHEAD_BATCH <
+        sgxClient->_recipeBatchID)) {
+        this->DecodeWindow(windowList->front(), resOutSGX, false);
+        windowList->pop_front();
+    }
+
     //Enclave::Logging(myName_.c_str(), "batch end\n");
-    //Enclave::Logging(myName_.c_str(), "b id Num is %d\n", reqContainer->idNum);
     Ocall_GetCurrentTime(&_endtime);
     _restoretime += _endtime - _starttime;
     free(tmpFpBuffer);
-    free(tmpDecValue);
     free(tmpEncValue);
    // free(fileRecipes);
     //free(tmpEncFpValue);
@@ -525,176 +340,513 @@ void EcallRecvDecoder::ProcRecipeTailBatch(ResOutSGX_t* resOutSGX) {
     ReqContainer_t* reqContainer = (ReqContainer_t*)resOutSGX->reqContainer;
     if(reqContainer == NULL)
         Enclave::Logging("DEBUG", "reqContainer is NULLPTR\n");
-    uint8_t** containerArray = reqContainer->containerArray;
-    SendMsgBuffer_t* sendChunkBuf = resOutSGX->sendChunkBuf;
-    uint8_t* idBuffer = reqContainer->idBuffer;
 
-    // uint32_t myCounter = 0;
-    OutQueryEntry_t *baseQueryBase = resOutSGX->baseQuery->outQueryBase;
-    unordered_map<string, uint32_t> tmpContainerMap;
-    string tmpContainerIDStr;
-    OutQueryEntry_t *baseQueryEntry = baseQueryBase;
-    OutQueryEntry_t *tmpEntry;
-    tmpEntry = (OutQueryEntry_t *)malloc(sizeof(OutQueryEntry_t));
-    for(int i = 0;i<resOutSGX->baseQuery->queryNum;i++){
-        baseQueryEntry++;   
+    // in-enclave info
+    EnclaveClient* sgxClient = (EnclaveClient*)resOutSGX->sgxClient;
+
+    // decode the windows resolved ahead
+    deque<RestoreWindow_t>* windowList = &sgxClient->_restoreWindowList;
+    while (!windowList->empty()) {
+        this->DecodeWindow(windowList->front(), resOutSGX, false);
+        windowList->pop_front();
+    }
+
+    //Enclave::Logging(myName_.c_str(), "recipe end\n");
+    RestoreWindow_t& openWindow = sgxClient->_openWindow;
+    if ((openWindow.recipeList.size() != 0) || (openWindow.chunkBaseList.size() != 0)) {
+        // the last window ends the restore
+        this->DecodeWindow(openWindow, resOutSGX, true);
+        openWindow = RestoreWindow_t();
+        sgxClient->_openWindowMap.clear();
+        sgxClient->_openBaseSlotMap.clear();
+    } else {
+        this->SendRestoreChunk(resOutSGX, true);
+    }
+    recipe_num = 0;
+    return ;
+}
+
+/**
+ * @brief add a container to the open window
+ * 
+ * @param sgxClient the enclave client
+ * @param containerID the container ID
+ * @return uint32_t the index of the container in the window
+ */
+uint32_t EcallRecvDecoder::AddWindowContainer(EnclaveClient* sgxClient, string& containerID) {
+    unordered_map<string, uint32_t>& windowMap = sgxClient->_openWindowMap;
+    auto findResult = windowMap.find(containerID);
+    if (findResult != windowMap.end()) {
+        // this is a duplicate container entry, using existing result.
+        return findResult->second;
+    }
+    // this is a unique container entry, it does not exist in current window
+    uint32_t containerIndex = windowMap.size();
+    windowMap[containerID] = containerIndex;
+    sgxClient->_openWindow.idList.append(containerID);
+    return containerIndex;
+}
+
+/**
+ * @brief close the open window, and let the outside application prefetch its containers
+ * 
+ * @param sgxClient the enclave client
+ * @param resOutSGX the pointer to the out-enclave var
+ */
+void EcallRecvDecoder::CloseWindow(EnclaveClient* sgxClient, ResOutSGX_t* resOutSGX) {
+    RestoreWindow_t& openWindow = sgxClient->_openWindow;
+    openWindow.batchID = sgxClient->_recipeBatchID;
+    Ocall_PrefetchContainers(resOutSGX->outClient, (uint8_t*)&openWindow.idList[0],
+        openWindow.idList.size());
+    sgxClient->_restoreWindowList.push_back(std::move(openWindow));
+    openWindow = RestoreWindow_t();
+    sgxClient->_openWindowMap.clear();
+    sgxClient->_openBaseSlotMap.clear();
+    return ;
+}
+
+/**
+ * @brief load the containers of a window, restore its chunks and send them
+ * 
+ * @param window the window
+ * @param resOutSGX the pointer to the out-enclave var
+ * @param finalFlag the window is the last one of the restore
+ */
+void EcallRecvDecoder::DecodeWindow(RestoreWindow_t& window, ResOutSGX_t* resOutSGX,
+    bool finalFlag) {
+    if (Enclave::faaSlotNum_ != 0) {
+        this->DecodeFaaWindow(window, resOutSGX, finalFlag);
+        return ;
     }
+
+    // out-enclave info
+    ReqContainer_t* reqContainer = (ReqContainer_t*)resOutSGX->reqContainer;
+    uint8_t** containerArray = reqContainer->containerArray;
+
     // in-enclave info
-    EnclaveRecipeEntry_t tmpEnclaveBaseRecipeEntry;
-    string tmpBaseContainerIDStr;
     EnclaveClient* sgxClient = (EnclaveClient*)resOutSGX->sgxClient;
     SendMsgBuffer_t* restoreChunkBuf = &sgxClient->_restoreChunkBuffer;
-    EVP_CIPHER_CTX* cipherCtx = sgxClient->_cipherCtx;
-    uint8_t* sessionKey = sgxClient->_sessionKey;
-    //Enclave::Logging(myName_.c_str(), "recipe end\n");
-    if (sgxClient->_enclaveRecipeBuffer.size() != 0) {
-        // start to let outside application to fetch the container data
-       // Ocall_GetReqContainers(resOutSGX->outClient);
-       //Enclave::Logging("DEBUG", "query num is %d\n", resOutSGX->baseQuery->queryNum);
-        if (resOutSGX->baseQuery->queryNum != 0)
-        {
-            Ocall_QueryBaseIndex(resOutSGX->outClient);
+    vector<EnclaveRecipeEntry_t>& recipeList = window.recipeList;
+    vector<EnclaveRecipeEntry_t>& baseRecipeList = window.baseRecipeList;
+    vector<RestoreTask_t>& taskList = sgxClient->_restoreTaskList;
+
+    // start to let outside application to fetch the container data
+    reqContainer->idNum = window.idList.size() / CONTAINER_ID_LENGTH;
+    memcpy(reqContainer->idBuffer, window.idList.c_str(), window.idList.size());
+    Ocall_GetReqContainers(resOutSGX->outClient);
+
+    // the chunks of a restore message are decoded together, the base chunks take the later slots
+    uint8_t* chunkSlotBase = sgxClient->_decodeBuffer;
+    uint8_t* baseSlotBase = chunkSlotBase + Enclave::sendChunkBatchSize_ * RESTORE_SLOT_SIZE;
+    unordered_map<string, uint8_t*> baseSlotMap;
+    vector<uint8_t*> deltaBaseList;
+    vector<pair<uint8_t*, uint8_t*>> missBaseList;
+    string tmpBaseFpStr;
+    RestoreTask_t tmpTask;
+    size_t bidx = 0;
+    size_t idx = 0;
+    while (idx < recipeList.size()) {
+        size_t chunkNum = Enclave::sendChunkBatchSize_ - restoreChunkBuf->header->currentItemNum;
+        if (chunkNum > recipeList.size() - idx) {
+            chunkNum = recipeList.size() - idx;
         }
-        baseQueryEntry = baseQueryBase;
-        for(int i = 0;i<resOutSGX->baseQuery->queryNum;i++){
-            cryptoObj_->AESCBCDec(cipherCtx, (uint8_t *)&baseQueryEntry->chunkAddr, sizeof(RecipeEntry_t), Enclave::indexQueryKey_, (uint8_t *)&tmpEntry->chunkAddr);
-            baseQueryEntry->chunkAddr = tmpEntry->chunkAddr;
-            tmpEnclaveBaseRecipeEntry.offset = tmpEntry->chunkAddr.offset;
-            tmpEnclaveBaseRecipeEntry.length = tmpEntry->chunkAddr.length;
-            tmpEnclaveBaseRecipeEntry.deltaFlag = tmpEntry->chunkAddr.deltaFlag;
-            //Enclave::Logging(myName_.c_str(), "Base container:%s\n",baseQueryEntry->chunkAddr.containerName);
-            tmpBaseContainerIDStr.assign((char*)tmpEntry->chunkAddr.containerName, CONTAINER_ID_LENGTH);
-            auto findResult = tmpContainerMap.find(tmpBaseContainerIDStr);
-            if(findResult == tmpContainerMap.end())
-            {
-                tmpEnclaveBaseRecipeEntry.containerID = reqContainer->idNum;
-                tmpContainerMap[tmpBaseContainerIDStr] = reqContainer->idNum;
-                memcpy(idBuffer + reqContainer->idNum * CONTAINER_ID_LENGTH, 
-                        tmpBaseContainerIDStr.c_str(), CONTAINER_ID_LENGTH);
-                reqContainer->idNum++;
-            } else 
-            {
-                tmpEnclaveBaseRecipeEntry.containerID = findResult->second;
+
+        // stage-1: decode the base chunks which are not in the base cache
+        baseSlotMap.clear();
+        deltaBaseList.clear();
+        missBaseList.clear();
+        uint8_t* baseSlot = baseSlotBase;
+        for (size_t k = idx; k < idx + chunkNum; k++) {
+            if (recipeList[k].deltaFlag != DELTA) {
+                continue;
             }
-            sgxClient->_baseRecipeBuffer.push_back(tmpEnclaveBaseRecipeEntry);
-            baseQueryEntry++;
+            EnclaveRecipeEntry_t& baseEntry = baseRecipeList[bidx];
+            bidx++;
+            tmpBaseFpStr.assign((char*)recipeList[k].basechunkHash, CHUNK_HASH_SIZE);
+            auto findResult = baseSlotMap.find(tmpBaseFpStr);
+            if (findResult != baseSlotMap.end()) {
+                deltaBaseList.push_back(findResult->second);
+                continue;
+            }
+            baseSlotMap[tmpBaseFpStr] = baseSlot;
+            deltaBaseList.push_back(baseSlot);
+
+            uint32_t baseSize;
+            uint8_t* baseChunk = sgxClient->_baseCache->Get(recipeList[k].basechunkHash, baseSize);
+            if (baseChunk != NULL) {
+                memcpy(baseSlot, &baseSize, sizeof(uint32_t));
+                memcpy(baseSlot + sizeof(uint32_t), baseChunk, baseSize);
+            } else {
+                tmpTask.chunkBuffer = containerArray[baseEntry.containerID] + baseEntry.offset +
+                    sizeof(RecipeEntry_t) + 4 * CHUNK_HASH_SIZE;
+                tmpTask.length = baseEntry.length;
+                tmpTask.type = RESTORE_TASK_PLAIN;
+                tmpTask.slot = baseSlot;
+                tmpTask.baseSlot = NULL;
+                taskList.push_back(tmpTask);
+                missBaseList.push_back(make_pair(recipeList[k].basechunkHash, baseSlot));
+            }
+            baseSlot += RESTORE_SLOT_SIZE;
         }
-        baseQueryEntry = baseQueryBase;
-        resOutSGX->baseQuery->queryNum = 0;
+        this->RunTasks(sgxClient);
+        this->InsertBaseCache(sgxClient, missBaseList);
+
+        // stage-2: decode the chunks, each one to its own slot
+        size_t didx = 0;
+        for (size_t k = idx; k < idx + chunkNum; k++) {
+            tmpTask.chunkBuffer = containerArray[recipeList[k].containerID] + recipeList[k].offset +
+                sizeof(RecipeEntry_t) + 4 * CHUNK_HASH_SIZE;
+            tmpTask.length = recipeList[k].length;
+            tmpTask.slot = chunkSlotBase + (k - idx) * RESTORE_SLOT_SIZE;
+            if (recipeList[k].deltaFlag == DELTA) {
+                tmpTask.type = RESTORE_TASK_DELTA;
+                tmpTask.baseSlot = deltaBaseList[didx];
+                didx++;
+            } else {
+                tmpTask.type = RESTORE_TASK_PLAIN;
+                tmpTask.baseSlot = NULL;
+            }
+            taskList.push_back(tmpTask);
+        }
+        this->RunTasks(sgxClient);
+
+        // send the chunks in the recipe order
+        idx += chunkNum;
+        this->SendSlots(resOutSGX, chunkSlotBase, chunkNum,
+            finalFlag && (idx == recipeList.size()));
+    }
+
+    // reset 
+    Ocall_FreeContainer(resOutSGX->outClient);
+    reqContainer->idNum = 0;
+    return ;
+}
+
+/**
+ * @brief plan the reads of a chunk into the forward assembly area of the open window
+ * 
+ * @param sgxClient the enclave client
+ * @param recipeEntry the recipe entry of the chunk
+ * @param baseAddr the address of its base chunk (NULL if it is not a delta chunk)
+ */
+void EcallRecvDecoder::AddFaaChunk(EnclaveClient* sgxClient, RecipeEntry_t* recipeEntry,
+    RecipeEntry_t* baseAddr) {
+    RestoreWindow_t& openWindow = sgxClient->_openWindow;
+    FaaRead_t tmpRead;
+    string tmpContainerIDStr;
+    uint32_t baseSlot = FAA_NO_BASE;
+
+    if (recipeEntry->deltaFlag == DELTA) {
+        // a base chunk shared by the delta chunks of the window is read once
+        string tmpBaseFpStr((char*)recipeEntry->basechunkHash, CHUNK_HASH_SIZE);
+        auto findResult = sgxClient->_openBaseSlotMap.find(tmpBaseFpStr);
+        if (findResult != sgxClient->_openBaseSlotMap.end()) {
+            baseSlot = findResult->second;
+        } else {
+            baseSlot = openWindow.baseSlotNum;
+            openWindow.baseSlotNum++;
+            sgxClient->_openBaseSlotMap[tmpBaseFpStr] = baseSlot;
+            tmpRead.offset = baseAddr->offset;
+            tmpRead.length = baseAddr->length;
+            tmpRead.slot = baseSlot;
+            tmpRead.type = FAA_BASE_READ;
+            memcpy(tmpRead.basechunkHash, recipeEntry->basechunkHash, CHUNK_HASH_SIZE);
+            tmpContainerIDStr.assign((char*)baseAddr->containerName, CONTAINER_ID_LENGTH);
+            this->AddFaaRead(sgxClient, tmpContainerIDStr, tmpRead);
+        }
+        tmpRead.type = FAA_DELTA_READ;
+    } else {
+        tmpRead.type = FAA_CHUNK_READ;
+    }
+
+    tmpRead.offset = recipeEntry->offset;
+    tmpRead.length = recipeEntry->length;
+    tmpRead.slot = openWindow.chunkBaseList.size();
+    tmpContainerIDStr.assign((char*)recipeEntry->containerName, CONTAINER_ID_LENGTH);
+    this->AddFaaRead(sgxClient, tmpContainerIDStr, tmpRead);
+    openWindow.chunkBaseList.push_back(baseSlot);
+    return ;
+}
+
+/**
+ * @brief add a planned read to its container in the open window
+ * 
+ * @param sgxClient the enclave client
+ * @param containerID the container ID
+ * @param faaRead the planned read
+ */
+void EcallRecvDecoder::AddFaaRead(EnclaveClient* sgxClient, string& containerID,
+    FaaRead_t& faaRead) {
+    vector<vector<FaaRead_t>>& readList = sgxClient->_openWindow.readList;
+    uint32_t containerIndex = this->AddWindowContainer(sgxClient, containerID);
+    if (containerIndex == readList.size()) {
+        readList.emplace_back();
+    }
+    readList[containerIndex].push_back(faaRead);
+    return ;
+}
+
+/**
+ * @brief restore a window with the forward assembly area: read each of its containers once 
+ * to fill the slots, then send the chunks in the recipe order
+ * 
+ * @param window the window
+ * @param resOutSGX the pointer to the out-enclave var
+ * @param finalFlag the window is the last one of the restore
+ */
+void EcallRecvDecoder::DecodeFaaWindow(RestoreWindow_t& window, ResOutSGX_t* resOutSGX,
+    bool finalFlag) {
+    // out-enclave info
+    ReqContainer_t* reqContainer = (ReqContainer_t*)resOutSGX->reqContainer;
+    uint8_t** containerArray = reqContainer->containerArray;
+
+    // in-enclave info
+    EnclaveClient* sgxClient = (EnclaveClient*)resOutSGX->sgxClient;
+    vector<RestoreTask_t>& taskList = sgxClient->_restoreTaskList;
+    uint8_t* faaBuffer = sgxClient->_faaBuffer;
+    // the base slots count from the end of the area
+    uint8_t* baseSlotEnd = faaBuffer + Enclave::faaSlotNum_ * RESTORE_SLOT_SIZE;
+    vector<pair<uint8_t*, uint8_t*>> missBaseList;
+    RestoreTask_t tmpTask;
+
+    // load the containers in groups of CONTAINER_CAPPING_VALUE, and fill all their reads
+    size_t containerNum = window.idList.size() / CONTAINER_ID_LENGTH;
+    for (size_t groupStart = 0; groupStart < containerNum;
+        groupStart += CONTAINER_CAPPING_VALUE) {
+        size_t groupNum = containerNum - groupStart;
+        if (groupNum > CONTAINER_CAPPING_VALUE) {
+            groupNum = CONTAINER_CAPPING_VALUE;
+        }
+        reqContainer->idNum = groupNum;
+        memcpy(reqContainer->idBuffer, window.idList.c_str() + groupStart * CONTAINER_ID_LENGTH,
+            groupNum * CONTAINER_ID_LENGTH);
         Ocall_GetReqContainers(resOutSGX->outClient);
-       
-        baseQueryEntry = baseQueryBase;
-        uint32_t remainChunkNum = sgxClient->_enclaveRecipeBuffer.size();
-        bool endFlag = 0;
-        size_t bidx = 0;
-        for (size_t idx = 0; idx < sgxClient->_enclaveRecipeBuffer.size(); idx++) {
-            uint32_t containerID = sgxClient->_enclaveRecipeBuffer[idx].containerID;
-            uint32_t offset = sgxClient->_enclaveRecipeBuffer[idx].offset;
-            uint32_t chunkSize = sgxClient->_enclaveRecipeBuffer[idx].length;
-            uint8_t deltaflag = sgxClient->_enclaveRecipeBuffer[idx].deltaFlag;
-            uint8_t* chunkBuffer = containerArray[containerID] + offset + sizeof(RecipeEntry_t) + 4*CHUNK_HASH_SIZE;
-            if(deltaflag == DELTA){
-                //restore delta chunk
-                    uint8_t* iv = chunkBuffer+chunkSize;
-                    uint8_t* outputBuffer = restoreChunkBuf->dataBuffer + restoreChunkBuf->header->dataSize;
-                    uint8_t decompressedChunk[MAX_CHUNK_SIZE];
-                    //decrypto the delta chunk with iv_key
-                    cryptoObj_->DecryptionWithKeyIV(cipherCtx, chunkBuffer, chunkSize, 
-                    Enclave::enclaveKey_, decompressedChunk, iv);
-                    uint8_t decompressbaseChunk[MAX_CHUNK_SIZE];
-                    uint32_t baseContainerId = sgxClient->_baseRecipeBuffer[bidx].containerID;
-                    uint32_t baseChunkOffset = sgxClient->_baseRecipeBuffer[bidx].offset;
-                    uint32_t baseChunkLength = sgxClient->_baseRecipeBuffer[bidx].length;
-                    uint8_t* basechunkBuffer = containerArray[baseContainerId] + baseChunkOffset + sizeof(RecipeEntry_t)+4*CHUNK_HASH_SIZE;
-                    iv = basechunkBuffer + baseChunkLength;
-                    bidx++;
-                    //decrpto the base chunk with iv_key
-                    cryptoObj_->DecryptionWithKeyIV(cipherCtx, basechunkBuffer, baseChunkLength, 
-                    Enclave::enclaveKey_, decompressbaseChunk, iv);
-                    uint8_t lz4decompressbaseChunk[MAX_CHUNK_SIZE];
-                    uint8_t *recchunk;
-                    size_t recchunk_size;
-                    //decompress basechunk with lz4
-                    int decompressedSize = LZ4_decompress_safe((char*)decompressbaseChunk, (char*)lz4decompressbaseChunk, baseChunkLength, MAX_CHUNK_SIZE);
-                    if(decompressedSize > 0){
-                    //base chunk can decompress, use decompressed chunk as basechunk
-                    recchunk = ed3_decode((uint8_t*)&decompressedChunk, chunkSize,(uint8_t*)&lz4decompressbaseChunk, decompressedSize, &recchunk_size);
-                    }else{
-                    //base chunk can decompress, use it as basechunk
-                    recchunk = ed3_decode((uint8_t*)&decompressedChunk, chunkSize,(uint8_t*)&decompressbaseChunk, baseChunkLength, &recchunk_size);
+
+        missBaseList.clear();
+        for (size_t i = 0; i < groupNum; i++) {
+            for (auto& faaRead : window.readList[groupStart + i]) {
+                tmpTask.chunkBuffer = containerArray[i] + faaRead.offset +
+                    sizeof(RecipeEntry_t) + 4 * CHUNK_HASH_SIZE;
+                tmpTask.length = faaRead.length;
+                tmpTask.baseSlot = NULL;
+                switch (faaRead.type) {
+                    case FAA_CHUNK_READ: {
+                        tmpTask.type = RESTORE_TASK_PLAIN;
+                        tmpTask.slot = faaBuffer + faaRead.slot * RESTORE_SLOT_SIZE;
+                        break;
+                    }
+                    case FAA_DELTA_READ: {
+                        // keep the decrypted delta, apply it once its base chunk is filled
+                        tmpTask.type = RESTORE_TASK_DECRYPT;
+                        tmpTask.slot = faaBuffer + faaRead.slot * RESTORE_SLOT_SIZE;
+                        break;
+                    }
+                    case FAA_BASE_READ: {
+                        tmpTask.type = RESTORE_TASK_PLAIN;
+                        tmpTask.slot = baseSlotEnd - (faaRead.slot + 1) * RESTORE_SLOT_SIZE;
+                        uint32_t baseSize;
+                        uint8_t* baseChunk = sgxClient->_baseCache->Get(faaRead.basechunkHash,
+                            baseSize);
+                        if (baseChunk != NULL) {
+                            memcpy(tmpTask.slot, &baseSize, sizeof(uint32_t));
+                            memcpy(tmpTask.slot + sizeof(uint32_t), baseChunk, baseSize);
+                            continue;
+                        }
+                        missBaseList.push_back(make_pair(faaRead.basechunkHash, tmpTask.slot));
+                        break;
+                    }
+                    default: {
+                        Enclave::Logging(myName_.c_str(), "wrong FAA read type.\n");
+                        continue;
                     }
-                    //Enclave::Logging(myName_.c_str(), "recchunk chunk size2: %d\n", recchunk_size);
-                    //Enclave::Logging(myName_.c_str(), "recchunk chunk num2: %d\n", delta_num);
-                    memcpy(outputBuffer, &recchunk_size, sizeof(uint32_t));
-                    memcpy(outputBuffer + sizeof(uint32_t), recchunk, recchunk_size);
-                    restoreChunkBuf->header->dataSize += sizeof(uint32_t) + recchunk_size;
-                    total_datasize = recchunk_size+total_datasize;
-                    total_deltasize = recchunk_size+total_deltasize;
-                    //Enclave::Logging("DEBUG", "total data size is %d\n", total_data_size);
-                    free(recchunk);
-                    restoreChunkBuf->header->currentItemNum++;
-                    remainChunkNum--;
-                }else{
-                    this->RecoverOneChunk(chunkBuffer, chunkSize, restoreChunkBuf, 
-                    cipherCtx);
-                    remainChunkNum--;   
-            }
-            if (remainChunkNum == 0) {
-                // this is the last batch of chunks;
-                endFlag = 1;
-            }
-            if ((restoreChunkBuf->header->currentItemNum % 
-                Enclave::sendChunkBatchSize_ == 0) || endFlag) {
-                cryptoObj_->SessionKeyEnc(cipherCtx, restoreChunkBuf->dataBuffer,
-                    restoreChunkBuf->header->dataSize, sessionKey, 
-                    sendChunkBuf->dataBuffer);
-
-                // copy the header to the send buffer
-                if (endFlag == 1) {
-                    restoreChunkBuf->header->messageType = SERVER_RESTORE_FINAL;
-                } else {
-                    restoreChunkBuf->header->messageType = SERVER_RESTORE_CHUNK;
                 }
-                memcpy(sendChunkBuf->header, restoreChunkBuf->header, sizeof(NetworkHead_t));
-                Ocall_SendRestoreData(resOutSGX->outClient);
-                //Enclave::Logging("DEBUG", "processTailBatch buf size is %d\n", restoreChunkBuf->header->dataSize);
-
-                restoreChunkBuf->header->dataSize = 0;
-                restoreChunkBuf->header->currentItemNum = 0;
+                taskList.push_back(tmpTask);
             }
         }
+        this->RunTasks(sgxClient);
+        this->InsertBaseCache(sgxClient, missBaseList);
+
+        Ocall_FreeContainer(resOutSGX->outClient);
+        reqContainer->idNum = 0;
+    }
+
+    // apply the delta chunks with their base chunks
+    size_t chunkNum = window.chunkBaseList.size();
+    for (size_t slot = 0; slot < chunkNum; slot++) {
+        if (window.chunkBaseList[slot] == FAA_NO_BASE) {
+            continue;
+        }
+        tmpTask.type = RESTORE_TASK_APPLY;
+        tmpTask.slot = faaBuffer + slot * RESTORE_SLOT_SIZE;
+        tmpTask.baseSlot = baseSlotEnd - (window.chunkBaseList[slot] + 1) * RESTORE_SLOT_SIZE;
+        taskList.push_back(tmpTask);
+    }
+    this->RunTasks(sgxClient);
+
+    // send the chunks in the recipe order
+    this->SendSlots(resOutSGX, faaBuffer, chunkNum, finalFlag);
+    return ;
+}
+
+/**
+ * @brief run the decode tasks of a client (on the workers if any), and clear them
+ * 
+ * @param sgxClient the enclave client
+ */
+void EcallRecvDecoder::RunTasks(EnclaveClient* sgxClient) {
+    vector<RestoreTask_t>& taskList = sgxClient->_restoreTaskList;
+    if (restorePool_ != NULL) {
+        restorePool_->ProcessBatch(taskList.data(), taskList.size());
     } else {
-        cryptoObj_->SessionKeyEnc(cipherCtx, restoreChunkBuf->dataBuffer,
-            restoreChunkBuf->header->dataSize, sessionKey,
-            sendChunkBuf->dataBuffer);
+        for (auto& task : taskList) {
+            this->RunTask(task, sgxClient->_cipherCtx);
+        }
+    }
+    taskList.clear();
+    return ;
+}
 
-        // copy the header to the send buffer
+/**
+ * @brief run a decode task, write the chunk size and the chunk to its slot
+ * 
+ * @param task the task
+ * @param cipherCtx the cipher ctx of the running thread
+ */
+void EcallRecvDecoder::RunTask(RestoreTask_t& task, EVP_CIPHER_CTX* cipherCtx) {
+    uint8_t* outputBuffer = task.slot + sizeof(uint32_t);
+    uint8_t deltaChunk[MAX_CHUNK_SIZE];
+    uint32_t deltaSize;
+    uint32_t baseSize;
+    uint32_t chunkSize;
+    switch (task.type) {
+        case RESTORE_TASK_PLAIN: {
+            chunkSize = this->DecodeUniqueChunk(task.chunkBuffer, task.length, outputBuffer,
+                cipherCtx);
+            break;
+        }
+        case RESTORE_TASK_DECRYPT: {
+            cryptoObj_->DecryptionWithKeyIV(cipherCtx, task.chunkBuffer, task.length,
+                Enclave::enclaveKey_, outputBuffer, task.chunkBuffer + task.length);
+            chunkSize = task.length;
+            break;
+        }
+        case RESTORE_TASK_DELTA:
+        case RESTORE_TASK_APPLY: {
+            if (task.type == RESTORE_TASK_DELTA) {
+                cryptoObj_->DecryptionWithKeyIV(cipherCtx, task.chunkBuffer, task.length,
+                    Enclave::enclaveKey_, deltaChunk, task.chunkBuffer + task.length);
+                deltaSize = task.length;
+            } else {
+                // the slot keeps the decrypted delta
+                memcpy(&deltaSize, task.slot, sizeof(uint32_t));
+                memcpy(deltaChunk, outputBuffer, deltaSize);
+            }
+            memcpy(&baseSize, task.baseSlot, sizeof(uint32_t));
+            this->EDeltaDecode(deltaChunk, deltaSize, task.baseSlot + sizeof(uint32_t),
+                baseSize, outputBuffer, &chunkSize);
+            break;
+        }
+        default: {
+            Enclave::Logging(myName_.c_str(), "wrong restore task type.\n");
+            chunkSize = 0;
+            break;
+        }
+    }
+    memcpy(task.slot, &chunkSize, sizeof(uint32_t));
+    return ;
+}
+
+/**
+ * @brief insert the base chunks decoded by the tasks to the base cache
+ * 
+ * @param sgxClient the enclave client
+ * @param missBaseList the (base chunk fp, base slot) list
+ */
+void EcallRecvDecoder::InsertBaseCache(EnclaveClient* sgxClient,
+    vector<pair<uint8_t*, uint8_t*>>& missBaseList) {
+    uint32_t baseSize;
+    for (auto& missBase : missBaseList) {
+        memcpy(&baseSize, missBase.second, sizeof(uint32_t));
+        sgxClient->_baseCache->Insert(missBase.first, missBase.second + sizeof(uint32_t),
+            baseSize);
+    }
+    return ;
+}
+
+/**
+ * @brief append the decoded chunks in the slots to the restore buffer, send it once it is full
+ * 
+ * @param resOutSGX the pointer to the out-enclave var
+ * @param slotBase the first slot
+ * @param slotNum the number of slots
+ * @param finalFlag the last slot ends the restore
+ */
+void EcallRecvDecoder::SendSlots(ResOutSGX_t* resOutSGX, uint8_t* slotBase, size_t slotNum,
+    bool finalFlag) {
+    EnclaveClient* sgxClient = (EnclaveClient*)resOutSGX->sgxClient;
+    SendMsgBuffer_t* restoreChunkBuf = &sgxClient->_restoreChunkBuffer;
+    bool endFlag = false;
+    uint32_t slotSize;
+    for (size_t slot = 0; slot < slotNum; slot++) {
+        uint8_t* slotBuffer = slotBase + slot * RESTORE_SLOT_SIZE;
+        memcpy(&slotSize, slotBuffer, sizeof(uint32_t));
+        memcpy(restoreChunkBuf->dataBuffer + restoreChunkBuf->header->dataSize, slotBuffer,
+            sizeof(uint32_t) + slotSize);
+        restoreChunkBuf->header->dataSize += sizeof(uint32_t) + slotSize;
+        restoreChunkBuf->header->currentItemNum++;
+        recipe_num++;
+
+        if (finalFlag && (slot + 1 == slotNum)) {
+            // this is the last batch of chunks;
+            endFlag = true;
+        }
+        if ((restoreChunkBuf->header->currentItemNum % 
+            Enclave::sendChunkBatchSize_ == 0) || endFlag) {
+            this->SendRestoreChunk(resOutSGX, endFlag);
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief encrypt the restored chunks with the session key and send them
+ * 
+ * @param resOutSGX the pointer to the out-enclave var
+ * @param endFlag this is the last batch of the restore
+ */
+void EcallRecvDecoder::SendRestoreChunk(ResOutSGX_t* resOutSGX, bool endFlag) {
+    SendMsgBuffer_t* sendChunkBuf = resOutSGX->sendChunkBuf;
+    EnclaveClient* sgxClient = (EnclaveClient*)resOutSGX->sgxClient;
+    SendMsgBuffer_t* restoreChunkBuf = &sgxClient->_restoreChunkBuffer;
+
+    cryptoObj_->SessionKeyEnc(sgxClient->_cipherCtx, restoreChunkBuf->dataBuffer,
+        restoreChunkBuf->header->dataSize, sgxClient->_sessionKey, sendChunkBuf->dataBuffer);
+
+    // copy the header to the send buffer
+    if (endFlag) {
         restoreChunkBuf->header->messageType = SERVER_RESTORE_FINAL;
-        memcpy(sendChunkBuf->header, restoreChunkBuf->header, sizeof(NetworkHead_t));
-        Ocall_SendRestoreData(resOutSGX->outClient);
-        
-        restoreChunkBuf->header->currentItemNum = 0;
-        restoreChunkBuf->header->dataSize = 0;
+    } else {
+        restoreChunkBuf->header->messageType = SERVER_RESTORE_CHUNK;
     }
-    recipe_num = 0;
-    free(tmpEntry);
+    memcpy(sendChunkBuf->header, restoreChunkBuf->header, sizeof(NetworkHead_t));
+    Ocall_SendRestoreData(resOutSGX->outClient);
+    restoreChunkBuf->header->dataSize = 0;
+    restoreChunkBuf->header->currentItemNum = 0;
     return ;
 }
 
 /**
- * @brief recover a chunk
+ * @brief decrypt and decompress a unique chunk
  * 
- * @param chunkBuffer the chunk buffer
+ * @param chunkBuffer the chunk buffer (followed by its iv)
  * @param chunkSize the chunk size
- * @param restoreChunkBuf the restore chunk buffer
+ * @param outputBuffer the buffer of the plaintext chunk (MAX_CHUNK_SIZE) <return>
  * @param cipherCtx the pointer to the EVP cipher
- * 
+ * @return uint32_t the size of the plaintext chunk
  */
-void EcallRecvDecoder::RecoverOneChunk(uint8_t* chunkBuffer, uint32_t chunkSize, 
-    SendMsgBuffer_t* restoreChunkBuf, EVP_CIPHER_CTX* cipherCtx) {
+uint32_t EcallRecvDecoder::DecodeUniqueChunk(uint8_t* chunkBuffer, uint32_t chunkSize,
+    uint8_t* outputBuffer, EVP_CIPHER_CTX* cipherCtx) {
     uint8_t* iv = chunkBuffer + chunkSize; 
-    uint8_t* outputBuffer = restoreChunkBuf->dataBuffer + 
-        restoreChunkBuf->header->dataSize;
     uint8_t decompressedChunk[MAX_CHUNK_SIZE];
     
     // first decrypt the chunk first
@@ -703,24 +855,49 @@ void EcallRecvDecoder::RecoverOneChunk(uint8_t* chunkBuffer, uint32_t chunkSize,
 
     // try to decompress the chunk
     int decompressedSize = LZ4_decompress_safe((char*)decompressedChunk, 
-        (char*)(outputBuffer + sizeof(uint32_t)), chunkSize, MAX_CHUNK_SIZE);
+        (char*)outputBuffer, chunkSize, MAX_CHUNK_SIZE);
     if (decompressedSize > 0) {
-        lz4_times++;
-        // it can do the decompression, write back the decompressed chunk size
-        memcpy(outputBuffer, &decompressedSize, sizeof(uint32_t));
-        restoreChunkBuf->header->dataSize += sizeof(uint32_t) + decompressedSize; 
-        total_datasize = decompressedSize+total_datasize;
-    } else {
-        lz4_flag = 1;
-        // it cannot do the decompression
-        memcpy(outputBuffer, &chunkSize, sizeof(uint32_t));
-        memcpy(outputBuffer + sizeof(uint32_t), decompressedChunk, chunkSize);
-        restoreChunkBuf->header->dataSize += sizeof(uint32_t) + chunkSize;
-        total_datasize = chunkSize+total_datasize;
+        // it can do the decompression
+        return decompressedSize;
     }
-   
 
-    restoreChunkBuf->header->currentItemNum++;
+    // it cannot do the decompression
+    memcpy(outputBuffer, decompressedChunk, chunkSize);
+    return chunkSize;
+}
+
+/**
+ * @brief create the cipher ctx of a decode worker
+ *
+ * @return void* the cipher ctx
+ */
+static void* NewDecodeCtx() {
+    return EVP_CIPHER_CTX_new();
+}
+
+/**
+ * @brief free the cipher ctx of a decode worker
+ *
+ * @param ctx the cipher ctx
+ */
+static void FreeDecodeCtx(void* ctx) {
+    EVP_CIPHER_CTX_free((EVP_CIPHER_CTX*)ctx);
+    return ;
+}
+
+/**
+ * @brief run a decode task on a decode worker
+ *
+ * @param owner the decoder
+ * @param taskList the RestoreTask_t list
+ * @param taskID the task index
+ * @param ctx the cipher ctx of the worker
+ */
+static void RunDecodeTask(void* owner, void* taskList, uint32_t taskID, void* ctx) {
+    ((EcallRecvDecoder*)owner)->RunTask(((RestoreTask_t*)taskList)[taskID],
+        (EVP_CIPHER_CTX*)ctx);
     return ;
 }
 
+const WorkerHandler_t EcallRecvDecoder::poolHandler_ = {NewDecodeCtx, FreeDecodeCtx,
+    RunDecodeTask};
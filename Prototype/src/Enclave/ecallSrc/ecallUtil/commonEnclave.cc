@@ -20,6 +20,10 @@ namespace Enclave {
     uint64_t sendChunkBatchSize_;
     uint64_t sendRecipeBatchSize_;
     uint64_t topKParam_;
+    uint64_t sfThreadNum_;
+    uint64_t baseCacheSize_;
+    uint64_t faaSlotNum_;
+    uint64_t decodeThreadNum_;
     // lock
     mutex sessionKeyLck_;
     mutex sketchLck_;
@@ -29,6 +33,10 @@ namespace Enclave {
 
     // the obj to the enclave index
     EnclaveBase* enclaveBaseObj_;
+    // the superfeature engine shared by all indexes
+    EcallSuperFeature* sfEngineObj_;
+    // the superfeature workers shared by all indexes
+    EcallWorkerPool* sfPoolObj_ = NULL;
 };
 
 void Enclave::Logging(const char* logger, const char* fmt, ...) {
@@ -0,0 +1,112 @@
+/**
+ * @file ecallBaseCache.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the in-enclave LRU cache of plaintext base chunks used in the restore
+ * @version 0.1
+ * @date 2024-03-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/ecallBaseCache.h"
+#include "../../include/commonEnclave.h"
+
+/**
+ * @brief Construct a new Ecall Base Cache object
+ *
+ * @param maxCacheSize the byte budget of the cache (0: disable the cache)
+ */
+EcallBaseCache::EcallBaseCache(uint64_t maxCacheSize) {
+    maxCacheSize_ = maxCacheSize;
+}
+
+/**
+ * @brief Destroy the Ecall Base Cache object
+ *
+ */
+EcallBaseCache::~EcallBaseCache() {
+    if (hitNum_ + missNum_ != 0) {
+        Enclave::Logging(myName_.c_str(), "========EcallBaseCache Info========\n");
+        Enclave::Logging(myName_.c_str(), "base cache budget (B): %lu\n", maxCacheSize_);
+        Enclave::Logging(myName_.c_str(), "base cache hit num: %lu\n", hitNum_);
+        Enclave::Logging(myName_.c_str(), "base cache miss num: %lu\n", missNum_);
+        Enclave::Logging(myName_.c_str(), "base cache evict num: %lu\n", evictNum_);
+        Enclave::Logging(myName_.c_str(), "===================================\n");
+    }
+    for (auto& it : baseMap_) {
+        free(it.second.data);
+    }
+    baseMap_.clear();
+    lruList_.clear();
+}
+
+/**
+ * @brief find a decoded base chunk, the buffer is valid until the next insert
+ *
+ * @param baseFp the base chunk fp
+ * @param size the size of the base chunk <return>
+ * @return uint8_t* the plaintext base chunk, NULL if it is not cached
+ */
+uint8_t* EcallBaseCache::Get(const uint8_t* baseFp, uint32_t& size) {
+    if (maxCacheSize_ == 0) {
+        return NULL;
+    }
+    string key((char*)baseFp, CHUNK_HASH_SIZE);
+    auto findResult = baseMap_.find(key);
+    if (findResult == baseMap_.end()) {
+        missNum_++;
+        return NULL;
+    }
+
+    hitNum_++;
+    lruList_.splice(lruList_.begin(), lruList_, findResult->second.lruIter);
+    size = findResult->second.size;
+    return findResult->second.data;
+}
+
+/**
+ * @brief insert a decoded base chunk, evict the LRU ones if the budget is exceeded
+ *
+ * @param baseFp the base chunk fp
+ * @param data the plaintext base chunk
+ * @param size the size of the base chunk
+ */
+void EcallBaseCache::Insert(const uint8_t* baseFp, const uint8_t* data, uint32_t size) {
+    if (size > maxCacheSize_) {
+        // also covers the disabled cache
+        return ;
+    }
+    string key((char*)baseFp, CHUNK_HASH_SIZE);
+    if (baseMap_.find(key) != baseMap_.end()) {
+        return ;
+    }
+
+    while (curCacheSize_ + size > maxCacheSize_) {
+        this->EvictOne();
+    }
+
+    BaseEntry_t newEntry;
+    newEntry.data = (uint8_t*) malloc(size);
+    memcpy(newEntry.data, data, size);
+    newEntry.size = size;
+    lruList_.push_front(key);
+    newEntry.lruIter = lruList_.begin();
+    baseMap_[key] = newEntry;
+    curCacheSize_ += size;
+    return ;
+}
+
+/**
+ * @brief evict the least recently used base chunk
+ *
+ */
+void EcallBaseCache::EvictOne() {
+    auto findResult = baseMap_.find(lruList_.back());
+    curCacheSize_ -= findResult->second.size;
+    free(findResult->second.data);
+    baseMap_.erase(findResult);
+    lruList_.pop_back();
+    evictNum_++;
+    return ;
+}
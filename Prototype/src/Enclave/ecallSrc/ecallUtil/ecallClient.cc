@@ -151,6 +151,9 @@ void EnclaveClient::InitUploadBuffer() {
  */
 void EnclaveClient::DestroyUploadBuffer() {
     free(_recvBuffer);
+    if (_plainBuffer != NULL) {
+        free(_plainBuffer);
+    }
     free(_inRecipe.entryFpList);
     free(_inQueryBase);
     free(_inContainer.buf);
@@ -228,7 +231,18 @@ void EnclaveClient::InitRestoreBuffer() {
     // for recipe
     _plainRecipeBuffer = (uint8_t*) malloc(Enclave::sendRecipeBatchSize_ *
         sizeof(RecipeEntry_t));
-    _enclaveRecipeBuffer.reserve(Enclave::sendRecipeBatchSize_);
+    _openWindow.batchID = 0;
+    _openWindow.baseSlotNum = 0;
+
+    // for the FAA restore, or the decode of a restore message
+    if (Enclave::faaSlotNum_ != 0) {
+        _faaBuffer = (uint8_t*) malloc(Enclave::faaSlotNum_ * RESTORE_SLOT_SIZE);
+    } else {
+        _decodeBuffer = (uint8_t*) malloc(2 * Enclave::sendChunkBatchSize_ * RESTORE_SLOT_SIZE);
+    }
+
+    // for the base chunks of delta chunks
+    _baseCache = new EcallBaseCache(Enclave::baseCacheSize_);
     return ;
 }
 
@@ -239,6 +253,13 @@ void EnclaveClient::InitRestoreBuffer() {
 void EnclaveClient::DestroyRestoreBuffer() {
     free(_plainRecipeBuffer);
     free(_restoreChunkBuffer.sendBuffer);
+    delete _baseCache;
+    if (_faaBuffer != NULL) {
+        free(_faaBuffer);
+    }
+    if (_decodeBuffer != NULL) {
+        free(_decodeBuffer);
+    }
     return ;
 }
 
@@ -225,13 +225,16 @@ void OFFLineBackward::Easy_update(UpOutSGX_t *upOutSGX , EcallCrypto* cryptoObj_
             //Enclave::Logging("DEBUG", "old container id is %s\n", old_recipe->containerName);
             //Enclave::Logging("DEBUG", "old recipe offset is %d\n", old_recipe->offset);
             memcpy(&outEntry->chunkAddr.containerName, old_recipe->containerName, CONTAINER_ID_LENGTH);
+            outEntry->chunkAddr.offset = old_recipe->offset;
+            outEntry->chunkAddr.length = old_recipe->length;
 
             Ocall_OneContainer(upOutSGX->outClient);
             if(outEntry->offlineFlag == false)
             {
                 continue;
             }
-            memcpy(tmpOldContainer, outEntry->containerbuffer, MAX_CONTAINER_SIZE);
+            // only the chunk record is loaded
+            memcpy(tmpOldContainer + old_recipe->offset, outEntry->containerbuffer + old_recipe->offset, CHUNK_RECORD_SIZE(old_recipe->length));
             old_container = tmpOldContainer;
             old_basecontainerID.assign((char*)&old_recipe->containerName, CONTAINER_ID_LENGTH);
             // Get old chunk sf
@@ -259,6 +262,8 @@ void OFFLineBackward::Easy_update(UpOutSGX_t *upOutSGX , EcallCrypto* cryptoObj_
             cryptoObj_->AESCBCDec(cipherCtx, (uint8_t*)&outEntry->chunkAddr, sizeof(RecipeEntry_t), Enclave::indexQueryKey_, (uint8_t*)new_recipe);
             // Get new container
             memcpy(&outEntry->chunkAddr.containerName, new_recipe->containerName, CONTAINER_ID_LENGTH);            
+            outEntry->chunkAddr.offset = new_recipe->offset;
+            outEntry->chunkAddr.length = new_recipe->length;
 
 
             Ocall_OneContainer(upOutSGX->outClient);
@@ -268,7 +273,8 @@ void OFFLineBackward::Easy_update(UpOutSGX_t *upOutSGX , EcallCrypto* cryptoObj_
                 Enclave::Logging("DEBUG", "skip total num: %d\n", skip_num);
                 continue;
             }
-            memcpy(tmpNewContainer, outEntry->containerbuffer, MAX_CONTAINER_SIZE);
+            // only the chunk record is loaded
+            memcpy(tmpNewContainer + new_recipe->offset, outEntry->containerbuffer + new_recipe->offset, CHUNK_RECORD_SIZE(new_recipe->length));
             new_container = tmpNewContainer;
             new_basecontainerID.assign((char*)&new_recipe->containerName, CONTAINER_ID_LENGTH);
             // Get new chunk sf
@@ -394,6 +400,8 @@ void OFFLineBackward::Easy_update(UpOutSGX_t *upOutSGX , EcallCrypto* cryptoObj_
                     delta_containerID.resize(CONTAINER_ID_LENGTH, 0);
                     delta_containerID.assign((char *)&delta_recipe->containerName, CONTAINER_ID_LENGTH);
                     memcpy(&outEntry->chunkAddr.containerName, delta_recipe->containerName, CONTAINER_ID_LENGTH);
+                    outEntry->chunkAddr.offset = delta_recipe->offset;
+                    outEntry->chunkAddr.length = delta_recipe->length;
                     //Enclave::Logging("DEBUG", "delta recipe container name is %s\n", delta_containerID.c_str());
 #if(CONTAINER_SEPARATE == 1)
                     Ocall_OneDeltaContainer(upOutSGX->outClient);
@@ -401,7 +409,8 @@ void OFFLineBackward::Easy_update(UpOutSGX_t *upOutSGX , EcallCrypto* cryptoObj_
                     Ocall_OneContainer(upOutSGX->outClient);
 #endif
                     _offline_Ocall++;
-                    memcpy(tmpDeltaContainer, outEntry->containerbuffer, MAX_CONTAINER_SIZE);
+                    memcpy(tmpDeltaContainer + delta_recipe->offset, outEntry->containerbuffer + delta_recipe->offset, 
+                        CHUNK_RECORD_SIZE(delta_recipe->length));
                     delta_container = tmpDeltaContainer;
                     //Enclave::Logging("DEBUG", "Get delta chunk container\n");
                     // Get delta chunk fp & sf & Iv
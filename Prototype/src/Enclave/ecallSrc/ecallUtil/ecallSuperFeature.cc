@@ -0,0 +1,400 @@
+/**
+ * @file ecallSuperFeature.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the interface of the superfeature engine inside the enclave
+ * @version 0.1
+ * @date 2024-03-02
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/ecallSuperFeature.h"
+
+#include <algorithm>
+
+// the SIMD kernel is selected by the enclave build flags (see SF_SIMD in src/Enclave/CMakeLists.txt)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SF_SIMD_AVX2 1
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define SF_SIMD_SSE41 1
+#endif
+
+// the gear hash of uint32_t covers the last 32 bytes
+static const uint32_t SF_GEAR_WINDOW_SIZE = 32;
+
+// floor(A * 2^56 / MOD), the lanes estimate floor(fp * A / MOD) without a division
+static const uint32_t SF_RABIN_SHIFT = 56;
+static const uint64_t SF_RABIN_BARRETT = (((uint64_t)SF_RABIN_A << SF_RABIN_SHIFT) / SF_RABIN_MOD);
+
+/**
+ * @brief roll a byte into a rabin-karp fingerprint: (fp * A + in) mod MOD, the quotient
+ * is estimated with the barrett constant as the SIMD lanes do (at most two below)
+ *
+ * @param fp the fingerprint (fp < MOD)
+ * @param in the byte rolled in
+ * @return uint64_t the new fingerprint
+ */
+static inline uint64_t RabinRollIn(uint64_t fp, uint8_t in) {
+    uint64_t q = (fp * SF_RABIN_BARRETT) >> SF_RABIN_SHIFT;
+    uint64_t x = fp * SF_RABIN_A + in - q * SF_RABIN_MOD;
+    if (x >= SF_RABIN_MOD) {
+        x -= SF_RABIN_MOD;
+    }
+    if (x >= SF_RABIN_MOD) {
+        x -= SF_RABIN_MOD;
+    }
+    return x;
+}
+
+#if defined(SF_SIMD_AVX2) || defined(SF_SIMD_SSE41)
+
+#if defined(SF_SIMD_AVX2)
+// 4 x 64-bit lanes per vector
+struct SFLaneOps {
+    typedef __m256i Vec;
+    static const uint32_t LANE_NUM = 4;
+    static inline Vec Set1(uint64_t x) { return _mm256_set1_epi64x((long long)x); }
+    static inline Vec Load(const uint64_t* x) { return _mm256_loadu_si256((const __m256i*)x); }
+    static inline void Store(uint64_t* x, Vec v) { _mm256_storeu_si256((__m256i*)x, v); }
+    static inline Vec Gather(const uint8_t* const* base, uint32_t off) {
+        return _mm256_set_epi64x(base[3][off], base[2][off], base[1][off], base[0][off]);
+    }
+    static inline Vec GatherTable(const uint64_t* table, const uint8_t* const* base, uint32_t off) {
+        return _mm256_set_epi64x(table[base[3][off]], table[base[2][off]],
+            table[base[1][off]], table[base[0][off]]);
+    }
+    static inline Vec Add(Vec a, Vec b) { return _mm256_add_epi64(a, b); }
+    static inline Vec Sub(Vec a, Vec b) { return _mm256_sub_epi64(a, b); }
+    static inline Vec Mul32(Vec a, Vec b) { return _mm256_mul_epu32(a, b); }
+    static inline Vec Shift(Vec a) { return _mm256_srli_epi64(a, SF_RABIN_SHIFT); }
+    static inline Vec Min32(Vec a, Vec b) { return _mm256_min_epu32(a, b); }
+    static inline Vec Max32(Vec a, Vec b) { return _mm256_max_epu32(a, b); }
+};
+#else
+// 2 x 64-bit lanes per vector
+struct SFLaneOps {
+    typedef __m128i Vec;
+    static const uint32_t LANE_NUM = 2;
+    static inline Vec Set1(uint64_t x) { return _mm_set1_epi64x((long long)x); }
+    static inline Vec Load(const uint64_t* x) { return _mm_loadu_si128((const __m128i*)x); }
+    static inline void Store(uint64_t* x, Vec v) { _mm_storeu_si128((__m128i*)x, v); }
+    static inline Vec Gather(const uint8_t* const* base, uint32_t off) {
+        return _mm_set_epi64x(base[1][off], base[0][off]);
+    }
+    static inline Vec GatherTable(const uint64_t* table, const uint8_t* const* base, uint32_t off) {
+        return _mm_set_epi64x(table[base[1][off]], table[base[0][off]]);
+    }
+    static inline Vec Add(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+    static inline Vec Sub(Vec a, Vec b) { return _mm_sub_epi64(a, b); }
+    static inline Vec Mul32(Vec a, Vec b) { return _mm_mul_epu32(a, b); }
+    static inline Vec Shift(Vec a) { return _mm_srli_epi64(a, SF_RABIN_SHIFT); }
+    static inline Vec Min32(Vec a, Vec b) { return _mm_min_epu32(a, b); }
+    static inline Vec Max32(Vec a, Vec b) { return _mm_max_epu32(a, b); }
+};
+#endif
+
+static const uint32_t SF_VEC_NUM = SF_FEATURE_NUM / SFLaneOps::LANE_NUM;
+
+/**
+ * @brief x mod MOD for x < 2^32 held in a 64-bit lane: min(x, x - MOD) as unsigned 32-bit,
+ * x - MOD wraps to a value larger than x when x < MOD (the high half stays 0 on both sides)
+ *
+ * @param x the input lanes (x < 2 * MOD)
+ * @param mod the modulus lanes
+ * @return the reduced lanes
+ */
+static inline SFLaneOps::Vec ReduceOnce(SFLaneOps::Vec x, SFLaneOps::Vec mod) {
+    return SFLaneOps::Min32(x, SFLaneOps::Sub(x, mod));
+}
+
+#endif
+
+/**
+ * @brief Construct a new Ecall Super Feature object
+ *
+ */
+EcallSuperFeature::EcallSuperFeature() {
+    // step-1: the rabin-karp roll-out table
+    uint64_t aPower = 1;
+    for (size_t i = 0; i < SF_WINDOW_SIZE - 1; i++) {
+        aPower *= SF_RABIN_A;
+        aPower %= SF_RABIN_MOD;
+    }
+    for (size_t i = 0; i < 256; i++) {
+        rabinOutTable_[i] = (i * aPower) % SF_RABIN_MOD;
+        rabinNegOutTable_[i] = SF_RABIN_MOD - rabinOutTable_[i];
+    }
+
+    // step-2: the gear table (splitmix64)
+    uint64_t state = SF_GEAR_SEED;
+    for (size_t i = 0; i < 256; i++) {
+        state += 0x9e3779b97f4a7c15ULL;
+        uint64_t z = state;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+        z = z ^ (z >> 31);
+        gearTable_[i] = static_cast<uint32_t>(z >> 32);
+    }
+
+    Enclave::Logging(myName_.c_str(), "init the EcallSuperFeature.\n");
+}
+
+/**
+ * @brief Destroy the Ecall Super Feature object
+ *
+ */
+EcallSuperFeature::~EcallSuperFeature() {
+    // all tables are inline
+}
+
+/**
+ * @brief get the max rabin-karp fingerprint of a sub-chunk
+ *
+ * @param ptr the pointer of chunk content
+ * @param begin the begin offset of the sub-chunk
+ * @param end the end offset of the sub-chunk
+ * @return uint32_t the feature
+ */
+uint32_t EcallSuperFeature::RabinFeature(const uint8_t* ptr, int begin, int end) {
+    int64_t fp = 0;
+    uint32_t feature = 0;
+    for (int j = begin; j < begin + (int)SF_WINDOW_SIZE; j++) {
+        fp = RabinRollIn(fp, ptr[j]);
+    }
+
+    int last = end - SF_WINDOW_SIZE;
+    for (int j = begin; j <= last; j++) {
+        if (fp > feature) {
+            feature = fp;
+        }
+        if (j == last) {
+            break;
+        }
+        fp -= rabinOutTable_[ptr[j]];
+        if (fp < 0) {
+            fp += SF_RABIN_MOD;
+        }
+        fp = RabinRollIn(fp, ptr[j + SF_WINDOW_SIZE]);
+    }
+    return feature;
+}
+
+/**
+ * @brief get the max rabin-karp fingerprints of all sub-chunks, the sub-chunks
+ * are advanced in parallel SIMD lanes if the enclave is built with AVX2/SSE4.1
+ *
+ * @param ptr the pointer of chunk content
+ * @param subchunkIndex the boundaries of the sub-chunks (SF_FEATURE_NUM + 1)
+ * @param feature the output features (SF_FEATURE_NUM)
+ */
+void EcallSuperFeature::RabinFeatureAll(const uint8_t* ptr, const int* subchunkIndex,
+    uint32_t* feature) {
+#if defined(SF_SIMD_AVX2) || defined(SF_SIMD_SSE41)
+    typedef SFLaneOps Ops;
+
+    // the lanes run in lock-step over the shortest sub-chunk, the sub-chunks differ by at most one byte
+    int minLen = subchunkIndex[1] - subchunkIndex[0];
+    for (size_t i = 1; i < SF_FEATURE_NUM; i++) {
+        minLen = min(minLen, subchunkIndex[i + 1] - subchunkIndex[i]);
+    }
+    if (minLen <= (int)SF_WINDOW_SIZE) {
+        // too short for the lanes
+        for (size_t i = 0; i < SF_FEATURE_NUM; i++) {
+            feature[i] = this->RabinFeature(ptr, subchunkIndex[i], subchunkIndex[i + 1]);
+        }
+        return ;
+    }
+
+    const uint8_t* outBase[SF_FEATURE_NUM];
+    const uint8_t* inBase[SF_FEATURE_NUM];
+    uint64_t fpArr[SF_FEATURE_NUM];
+    uint64_t featureArr[SF_FEATURE_NUM];
+    for (size_t i = 0; i < SF_FEATURE_NUM; i++) {
+        outBase[i] = ptr + subchunkIndex[i];
+        inBase[i] = outBase[i] + SF_WINDOW_SIZE;
+        uint64_t fp = 0;
+        for (size_t j = 0; j < SF_WINDOW_SIZE; j++) {
+            fp = RabinRollIn(fp, outBase[i][j]);
+        }
+        fpArr[i] = fp;
+    }
+
+    const Ops::Vec modVec = Ops::Set1(SF_RABIN_MOD);
+    const Ops::Vec aVec = Ops::Set1(SF_RABIN_A);
+    const Ops::Vec barrettVec = Ops::Set1(SF_RABIN_BARRETT);
+    Ops::Vec fpVec[SF_VEC_NUM];
+    Ops::Vec featureVec[SF_VEC_NUM];
+    for (size_t k = 0; k < SF_VEC_NUM; k++) {
+        fpVec[k] = Ops::Load(fpArr + k * Ops::LANE_NUM);
+        featureVec[k] = fpVec[k];
+    }
+
+    uint32_t lastPos = minLen - SF_WINDOW_SIZE;
+    for (uint32_t pos = 0; pos < lastPos; pos++) {
+        for (size_t k = 0; k < SF_VEC_NUM; k++) {
+            // roll out: (fp - out) mod MOD
+            Ops::Vec fp = Ops::Add(fpVec[k],
+                Ops::GatherTable(rabinNegOutTable_, outBase + k * Ops::LANE_NUM, pos));
+            fp = ReduceOnce(fp, modVec);
+            // roll in: (fp * A + in) mod MOD, the quotient estimate is at most one below
+            Ops::Vec x = Ops::Add(Ops::Mul32(fp, aVec), Ops::Gather(inBase + k * Ops::LANE_NUM, pos));
+            Ops::Vec q = Ops::Shift(Ops::Mul32(fp, barrettVec));
+            x = Ops::Sub(x, Ops::Mul32(q, modVec));
+            x = ReduceOnce(ReduceOnce(x, modVec), modVec);
+            fpVec[k] = x;
+            featureVec[k] = Ops::Max32(featureVec[k], x);
+        }
+    }
+
+    for (size_t k = 0; k < SF_VEC_NUM; k++) {
+        Ops::Store(fpArr + k * Ops::LANE_NUM, fpVec[k]);
+        Ops::Store(featureArr + k * Ops::LANE_NUM, featureVec[k]);
+    }
+
+    // the longer sub-chunks have the remaining windows
+    for (size_t i = 0; i < SF_FEATURE_NUM; i++) {
+        int64_t fp = fpArr[i];
+        uint32_t last = subchunkIndex[i + 1] - subchunkIndex[i] - SF_WINDOW_SIZE;
+        for (uint32_t pos = lastPos; pos < last; pos++) {
+            fp -= rabinOutTable_[outBase[i][pos]];
+            if (fp < 0) {
+                fp += SF_RABIN_MOD;
+            }
+            fp = RabinRollIn(fp, inBase[i][pos]);
+            if ((uint64_t)fp > featureArr[i]) {
+                featureArr[i] = fp;
+            }
+        }
+        feature[i] = featureArr[i];
+    }
+#else
+    for (size_t i = 0; i < SF_FEATURE_NUM; i++) {
+        feature[i] = this->RabinFeature(ptr, subchunkIndex[i], subchunkIndex[i + 1]);
+    }
+#endif
+    return ;
+}
+
+/**
+ * @brief get the max gear fingerprint of a sub-chunk
+ *
+ * @param ptr the pointer of chunk content
+ * @param begin the begin offset of the sub-chunk
+ * @param end the end offset of the sub-chunk
+ * @return uint32_t the feature
+ */
+uint32_t EcallSuperFeature::GearFeature(const uint8_t* ptr, int begin, int end) {
+    uint32_t fp = 0;
+    uint32_t feature = 0;
+    int warmEnd = min(begin + (int)SF_GEAR_WINDOW_SIZE - 1, end);
+    int j = begin;
+    for (; j < warmEnd; j++) {
+        fp = (fp << 1) + gearTable_[ptr[j]];
+    }
+    for (; j < end; j++) {
+        fp = (fp << 1) + gearTable_[ptr[j]];
+        if (fp > feature) {
+            feature = fp;
+        }
+    }
+    return feature;
+}
+
+/**
+ * @brief extract the features of a chunk, grouped by superfeature
+ *
+ * @param ptr the pointer of chunk content
+ * @param chunkSize the chunk size
+ * @param featureGroup the output buffer (SF_SUPER_NUM * SF_GROUP_SIZE)
+ */
+void EcallSuperFeature::ExtractFeature(const uint8_t* ptr, int chunkSize,
+    uint64_t* featureGroup) {
+    int subchunkIndex[SF_FEATURE_NUM + 1];
+    uint32_t feature[SF_FEATURE_NUM];
+
+    subchunkIndex[0] = 0;
+    for (size_t i = 0; i < SF_FEATURE_NUM; i++) {
+        subchunkIndex[i + 1] = (chunkSize * (i + 1)) / SF_FEATURE_NUM;
+    }
+
+#if (SF_GEAR_HASH == 1)
+    for (size_t i = 0; i < SF_FEATURE_NUM; i++) {
+        feature[i] = this->GearFeature(ptr, subchunkIndex[i], subchunkIndex[i + 1]);
+    }
+#else
+    this->RabinFeatureAll(ptr, subchunkIndex, feature);
+#endif
+
+    for (size_t i = 0; i < SF_FEATURE_NUM / SF_SUPER_NUM; i++) {
+        std::sort(feature + i * SF_SUPER_NUM, feature + (i + 1) * SF_SUPER_NUM);
+    }
+
+    for (size_t i = 0; i < SF_SUPER_NUM; i++) {
+        for (size_t j = 0; j < SF_GROUP_SIZE; j++) {
+            featureGroup[i * SF_GROUP_SIZE + j] = feature[j * SF_SUPER_NUM + i];
+        }
+    }
+    return ;
+}
+
+/**
+ * @brief compute the superfeatures of a chunk
+ *
+ * @param ptr the pointer of chunk content
+ * @param chunkSize the chunk size
+ * @param mdCtx the hasher ctx (owned by the calling thread)
+ * @param cryptoObj the crypto obj
+ * @param SF the output buffer (SF_SUPER_NUM * CHUNK_HASH_SIZE)
+ */
+void EcallSuperFeature::GenerateSuperFeature(const uint8_t* ptr, int chunkSize,
+    EVP_MD_CTX* mdCtx, EcallCrypto* cryptoObj, uint8_t* SF) {
+    uint64_t featureGroup[SF_SUPER_NUM * SF_GROUP_SIZE];
+    this->ExtractFeature(ptr, chunkSize, featureGroup);
+
+    for (size_t i = 0; i < SF_SUPER_NUM; i++) {
+        cryptoObj->GenerateHash(mdCtx, (uint8_t*)(featureGroup + i * SF_GROUP_SIZE),
+            sizeof(uint64_t) * SF_GROUP_SIZE, SF + i * CHUNK_HASH_SIZE);
+    }
+    return ;
+}
+
+/**
+ * @brief create the hasher ctx of a superfeature worker
+ *
+ * @return void* the hasher ctx
+ */
+static void* NewSFCtx() {
+    return EVP_MD_CTX_new();
+}
+
+/**
+ * @brief free the hasher ctx of a superfeature worker
+ *
+ * @param ctx the hasher ctx
+ */
+static void FreeSFCtx(void* ctx) {
+    EVP_MD_CTX_free((EVP_MD_CTX*)ctx);
+    return ;
+}
+
+/**
+ * @brief compute the superfeature of a task
+ *
+ * @param owner the superfeature engine
+ * @param taskList the Param list
+ * @param taskID the task index
+ * @param ctx the hasher ctx of the worker
+ */
+static void RunSFTask(void* owner, void* taskList, uint32_t taskID, void* ctx) {
+    Param& param = ((Param*)taskList)[taskID];
+    if (param.SF) {
+        ((EcallSuperFeature*)owner)->GenerateSuperFeature(param.ptr, param.chunksize,
+            (EVP_MD_CTX*)ctx, param.cryptoObj_, param.SF);
+    }
+    return ;
+}
+
+const WorkerHandler_t EcallSuperFeature::poolHandler_ = {NewSFCtx, FreeSFCtx, RunSFTask};
@@ -0,0 +1,165 @@
+/**
+ * @file ecallWorkerPool.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the interface of the persistent worker pool inside the enclave
+ * @version 0.1
+ * @date 2024-03-27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/ecallWorkerPool.h"
+#include "../../include/commonEnclave.h"
+
+/**
+ * @brief Construct a new Ecall Worker Pool object
+ *
+ * @param poolName the name of the pool
+ * @param workerNum the number of workers (each holds a TCS until the pool is destroyed)
+ * @param handler the task hooks
+ * @param owner the owner passed to the task hook
+ */
+EcallWorkerPool::EcallWorkerPool(const string& poolName, uint32_t workerNum,
+    const WorkerHandler_t& handler, void* owner) {
+    if (workerNum == 0) {
+        workerNum = 1;
+    }
+    myName_ = poolName;
+    workerNum_ = workerNum;
+    handler_ = handler;
+    owner_ = owner;
+
+    pthread_mutex_init(&queueLck_, NULL);
+    pthread_cond_init(&notEmptyCond_, NULL);
+    pthread_cond_init(&notFullCond_, NULL);
+
+    workerList_.resize(workerNum_);
+    for (size_t i = 0; i < workerNum_; i++) {
+        if (pthread_create(&workerList_[i], NULL, WorkerLoop, this) != 0) {
+            Ocall_SGX_Exit_Error("EcallWorkerPool: cannot create the worker, check TCSNum.");
+        }
+    }
+
+    Enclave::Logging(myName_.c_str(), "init the worker pool with %u workers.\n",
+        workerNum_);
+}
+
+/**
+ * @brief Destroy the Ecall Worker Pool object
+ *
+ */
+EcallWorkerPool::~EcallWorkerPool() {
+    pthread_mutex_lock(&queueLck_);
+    stopFlag_ = true;
+    pthread_cond_broadcast(&notEmptyCond_);
+    pthread_mutex_unlock(&queueLck_);
+
+    for (size_t i = 0; i < workerNum_; i++) {
+        pthread_join(workerList_[i], NULL);
+    }
+
+    pthread_cond_destroy(&notFullCond_);
+    pthread_cond_destroy(&notEmptyCond_);
+    pthread_mutex_destroy(&queueLck_);
+}
+
+/**
+ * @brief the main loop of a worker, the worker owns its context for its lifetime
+ *
+ * @param arg the pointer to the pool
+ * @return void* NULL
+ */
+void* EcallWorkerPool::WorkerLoop(void* arg) {
+    EcallWorkerPool* pool = (EcallWorkerPool*)arg;
+    void* ctx = pool->handler_.NewCtx();
+    WorkerJob_t job;
+
+    while (true) {
+        pthread_mutex_lock(&pool->queueLck_);
+        while (pool->queueNum_ == 0 && !pool->stopFlag_) {
+            pthread_cond_wait(&pool->notEmptyCond_, &pool->queueLck_);
+        }
+        if (pool->queueNum_ == 0) {
+            // stop and no pending job
+            pthread_mutex_unlock(&pool->queueLck_);
+            break;
+        }
+        job = pool->jobQueue_[pool->queueHead_];
+        pool->queueHead_ = (pool->queueHead_ + 1) % WORKER_POOL_QUEUE_SIZE;
+        pool->queueNum_--;
+        pthread_cond_signal(&pool->notFullCond_);
+        pthread_mutex_unlock(&pool->queueLck_);
+
+        for (uint32_t i = job.begin; i < job.end; i++) {
+            pool->handler_.RunTask(pool->owner_, job.taskList, i, ctx);
+        }
+
+        pthread_mutex_lock(&pool->queueLck_);
+        job.batch->pendingJob--;
+        if (job.batch->pendingJob == 0) {
+            pthread_cond_signal(&job.batch->doneCond);
+        }
+        pthread_mutex_unlock(&pool->queueLck_);
+    }
+
+    pool->handler_.FreeCtx(ctx);
+    return NULL;
+}
+
+/**
+ * @brief push a job to the queue, block if the queue is full (hold queueLck_)
+ *
+ * @param job the range job
+ */
+void EcallWorkerPool::PushJob(WorkerJob_t& job) {
+    while (queueNum_ == WORKER_POOL_QUEUE_SIZE) {
+        pthread_cond_wait(&notFullCond_, &queueLck_);
+    }
+    jobQueue_[queueTail_] = job;
+    queueTail_ = (queueTail_ + 1) % WORKER_POOL_QUEUE_SIZE;
+    queueNum_++;
+    pthread_cond_signal(&notEmptyCond_);
+    return ;
+}
+
+/**
+ * @brief run a batch of tasks, block until all tasks are done
+ *
+ * @param taskList the task list
+ * @param taskNum the number of tasks
+ */
+void EcallWorkerPool::ProcessBatch(void* taskList, uint32_t taskNum) {
+    if (taskNum == 0) {
+        return ;
+    }
+
+    // spread the remainder over the first workers
+    uint32_t jobNum = min(workerNum_, taskNum);
+    uint32_t blockLen = taskNum / jobNum;
+    uint32_t remainNum = taskNum % jobNum;
+
+    WorkerBatch_t batch;
+    batch.pendingJob = jobNum;
+    pthread_cond_init(&batch.doneCond, NULL);
+
+    WorkerJob_t job;
+    job.taskList = taskList;
+    job.batch = &batch;
+    uint32_t begin = 0;
+
+    pthread_mutex_lock(&queueLck_);
+    for (uint32_t i = 0; i < jobNum; i++) {
+        job.begin = begin;
+        job.end = begin + blockLen + (i < remainNum ? 1 : 0);
+        begin = job.end;
+        this->PushJob(job);
+    }
+    while (batch.pendingJob != 0) {
+        pthread_cond_wait(&batch.doneCond, &queueLck_);
+    }
+    pthread_mutex_unlock(&queueLck_);
+
+    pthread_cond_destroy(&batch.doneCond);
+    return ;
+}
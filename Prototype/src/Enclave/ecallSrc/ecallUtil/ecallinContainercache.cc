@@ -113,7 +113,7 @@ void InContainercache::InsertToCache(string& name, const char* data, uint32_t le
  * 
  * @return the query restult
  */
-bool InContainercache::ExistsInCache(string& name) {
+bool InContainercache::ExistsInCache(const string& name) {
     bool flag = false;
     flag = this->inCache_->contains(name);
     return flag;
@@ -142,7 +142,10 @@ void InContainercache::InsertToCache_Offline(string& name, const char* data, uin
     uint32_t tempoffset;
     uint32_t tempoffset_recipe;
 
-    length = MAX_CONTAINER_SIZE;
+    // only copy the valid part, the buffer may be a view of the container file
+    if (length > MAX_CONTAINER_SIZE) {
+        length = MAX_CONTAINER_SIZE;
+    }
 
     if (inCache_->size() + 1 > cacheSize_) { 
         // evict a item
@@ -33,6 +33,8 @@
 #include "ecallClient.h"
 
 class EnclaveBase;
+class EcallSuperFeature;
+class EcallWorkerPool;
 
 using namespace std;
 namespace Enclave {
@@ -47,6 +49,10 @@ namespace Enclave {
     extern uint64_t sendChunkBatchSize_;
     extern uint64_t sendRecipeBatchSize_;
     extern uint64_t topKParam_;
+    extern uint64_t sfThreadNum_;
+    extern uint64_t baseCacheSize_; // the byte budget of the restore base chunk cache of a client
+    extern uint64_t faaSlotNum_; // the slot number of the restore forward assembly area (0: disable)
+    extern uint64_t decodeThreadNum_; // the number of the restore decode workers (0: no worker)
     // mutex
     extern mutex sessionKeyLck_;
     extern mutex sketchLck_;
@@ -54,6 +60,10 @@ namespace Enclave {
     extern mutex inContainerLck_;
     // the obj to the enclave index
     extern EnclaveBase* enclaveBaseObj_;
+    // the superfeature engine shared by all indexes
+    extern EcallSuperFeature* sfEngineObj_;
+    // the superfeature workers shared by all indexes
+    extern EcallWorkerPool* sfPoolObj_;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,86 @@
+/**
+ * @file ecallBaseCache.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the in-enclave LRU cache of plaintext base chunks used in the restore
+ * @version 0.1
+ * @date 2024-03-24
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef ECALL_BASE_CACHE_H
+#define ECALL_BASE_CACHE_H
+
+#include "stdint.h"
+#include "string"
+#include "list"
+#include "unordered_map"
+#include "../../../include/constVar.h"
+
+using namespace std;
+
+class EcallBaseCache {
+    private:
+        string myName_ = "EcallBaseCache";
+
+        // a decoded (decrypted and decompressed) base chunk
+        typedef struct {
+            uint8_t* data;
+            uint32_t size;
+            list<string>::iterator lruIter;
+        } BaseEntry_t;
+
+        // key: the base chunk fp
+        unordered_map<string, BaseEntry_t> baseMap_;
+        // the base chunk fps in LRU order (front is the latest)
+        list<string> lruList_;
+        // the byte budget of the plaintext base chunks
+        uint64_t maxCacheSize_;
+        uint64_t curCacheSize_ = 0;
+
+        // statistics
+        uint64_t hitNum_ = 0;
+        uint64_t missNum_ = 0;
+        uint64_t evictNum_ = 0;
+
+        /**
+         * @brief evict the least recently used base chunk
+         *
+         */
+        void EvictOne();
+
+    public:
+        /**
+         * @brief Construct a new Ecall Base Cache object
+         *
+         * @param maxCacheSize the byte budget of the cache (0: disable the cache)
+         */
+        EcallBaseCache(uint64_t maxCacheSize);
+
+        /**
+         * @brief Destroy the Ecall Base Cache object
+         *
+         */
+        ~EcallBaseCache();
+
+        /**
+         * @brief find a decoded base chunk, the buffer is valid until the next insert
+         *
+         * @param baseFp the base chunk fp
+         * @param size the size of the base chunk <return>
+         * @return uint8_t* the plaintext base chunk, NULL if it is not cached
+         */
+        uint8_t* Get(const uint8_t* baseFp, uint32_t& size);
+
+        /**
+         * @brief insert a decoded base chunk, evict the LRU ones if the budget is exceeded
+         *
+         * @param baseFp the base chunk fp
+         * @param data the plaintext base chunk
+         * @param size the size of the base chunk
+         */
+        void Insert(const uint8_t* baseFp, const uint8_t* data, uint32_t size);
+};
+
+#endif
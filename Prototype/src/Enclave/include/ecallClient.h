@@ -13,11 +13,13 @@
 #define ECALL_CLIENT_H
 
 #include "ecallEnc.h"
+#include "ecallBaseCache.h"
 #include "commonEnclave.h"
 // #include ""
 #include "md5.h"
 #include "util.h"
 #include "xxhash.h"
+#include "deque"
 
 
 using namespace std;
@@ -27,6 +29,48 @@ typedef struct {
     uint32_t curSize;
 } InContainer;
 
+// the type of a restore decode task
+enum RESTORE_TASK_TYPE {
+    RESTORE_TASK_PLAIN = 0, // decrypt and decompress a unique chunk (or a base chunk)
+    RESTORE_TASK_DELTA, // decrypt a delta chunk and decode it with its base chunk
+    RESTORE_TASK_DECRYPT, // only decrypt a delta chunk, its base chunk is not ready
+    RESTORE_TASK_APPLY // decode a decrypted delta chunk (in the slot) with its base chunk
+};
+
+// the decode task of one chunk, the result is written to its own slot
+struct RestoreTask_t {
+    uint8_t* chunkBuffer; // the encrypted chunk (followed by its iv)
+    uint32_t length; // the length of the encrypted chunk
+    uint8_t type;
+    uint8_t* slot; // the output slot: the chunk size and the chunk (RESTORE_SLOT_SIZE)
+    uint8_t* baseSlot; // the slot of the plaintext base chunk (only for the delta chunk)
+};
+
+// the type of a planned read in the forward assembly area
+enum FAA_READ_TYPE {FAA_CHUNK_READ = 0, FAA_DELTA_READ, FAA_BASE_READ};
+static const uint32_t FAA_NO_BASE = UINT32_MAX;
+
+// a record to read from a container into a slot of the forward assembly area
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+    uint32_t slot; // the chunk slot (counts from the front) or the base slot (counts from the back)
+    uint8_t type;
+    uint8_t basechunkHash[CHUNK_HASH_SIZE]; // only for FAA_BASE_READ
+} FaaRead_t;
+
+// the chunks of the restore whose containers are loaded together (at most CONTAINER_CAPPING_VALUE)
+// in the FAA restore, the chunks fit the forward assembly area, and its containers are loaded in groups
+typedef struct {
+    string idList; // the container IDs
+    vector<EnclaveRecipeEntry_t> recipeList; // containerID: the index in idList
+    vector<EnclaveRecipeEntry_t> baseRecipeList; // the base chunks of the delta chunks in order
+    vector<vector<FaaRead_t>> readList; // FAA: the reads of each container in idList
+    vector<uint32_t> chunkBaseList; // FAA: the base slot of each chunk slot (FAA_NO_BASE: not a delta chunk)
+    uint32_t baseSlotNum; // FAA: the number of base slots
+    uint64_t batchID; // the recipe batch closing this window
+} RestoreWindow_t;
+
 class EnclaveClient {
     private:
         int indexType_ = 0;
@@ -94,18 +138,27 @@ class EnclaveClient {
         uint8_t _masterKey[CHUNK_HASH_SIZE];
 
         // for restore
-        vector<EnclaveRecipeEntry_t> _enclaveRecipeBuffer;
-        vector<EnclaveRecipeEntry_t> _baseRecipeBuffer;
+        deque<RestoreWindow_t> _restoreWindowList; // the closed windows waiting for the decode
+        RestoreWindow_t _openWindow;
+        unordered_map<string, uint32_t> _openWindowMap; // container ID -> index in the open window
+        unordered_map<string, uint32_t> _openBaseSlotMap; // FAA: base chunk fp -> base slot in the open window
+        uint8_t* _faaBuffer = NULL; // the forward assembly area (Enclave::faaSlotNum_ slots)
+        uint8_t* _decodeBuffer = NULL; // the chunk slots and the base slots of a restore message
+        vector<RestoreTask_t> _restoreTaskList; // the decode tasks handed to the workers
+        uint64_t _recipeBatchID = 0; // the number of resolved recipe batches
         SendMsgBuffer_t _restoreChunkBuffer;
         uint8_t* _plainRecipeBuffer; // store plaintext recipe after decryption
+        EcallBaseCache* _baseCache; // the decoded base chunks shared by the recipe batches
         
 
         // for upload
         InQueryEntry_t* _inQueryBase; // dedup buffer
         Recipe_t _inRecipe; // the in-enclave recipe buffer
         uint8_t* _recvBuffer;
+        uint8_t* _plainBuffer = NULL; // the decompressed batch, allocated by the first compressed batch
         Segment_t _segment;
         unordered_map<string, uint32_t> _localIndex;
+        unordered_map<string, uint32_t> _fetchedBaseMap; // base container id -> index in the batch fetch buffers
         InContainer _inContainer;
         InContainer _deltainContainer;
 
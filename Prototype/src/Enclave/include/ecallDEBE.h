@@ -47,6 +47,15 @@ class EcallDEBE : public EnclaveBase {
          */
         void UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFreq);
 
+        /**
+         * @brief check whether a chunk is in the top-k index
+         * 
+         * @param chunkFp the chunk fp
+         * @return true it is in the index
+         * @return false it is not in the index
+         */
+        bool CheckInsideIndex(const string& chunkFp);
+
         /**
          * @brief check whether add this chunk to the heap
          * 
@@ -23,6 +23,8 @@
 #include "ecallCMSketch.h"
 #include "ecallEntryHeap.h"
 #include "ecallinContainercache.h"
+#include "ecallSuperFeature.h"
+#include "ecallWorkerPool.h"
 #include <sgx_thread.h>
 #include "md5.h"
 #include "util.h"
@@ -86,6 +88,15 @@ class EcallFreqIndex : public EnclaveBase {
          */
         void UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFreq);
 
+        /**
+         * @brief check whether a chunk is in the top-k index
+         * 
+         * @param chunkFp the chunk fp
+         * @return true it is in the index
+         * @return false it is not in the index
+         */
+        bool CheckInsideIndex(const string& chunkFp);
+
         /**
          * @brief check whether add this chunk to the heap
          * 
@@ -208,6 +219,16 @@ class EcallFreqIndex : public EnclaveBase {
          */
         bool LocalChecker(InQueryEntry_t *_inQueryBase, OutQueryEntry_t *_outQueryBase, UpOutSGX_t *_upOutSGX,uint32_t _chunkNum);
 
+        /**
+         * @brief load the uncached base containers of a batch in one ocall, the sparse ones are
+         * read per base chunk record
+         * 
+         * @param Batch_ContainerIDset the set of basechunk container
+         * @param Batch_ContainerRefNum the number of basechunks in each container
+         * @param _upOutSGX the pointer to enclave-related var
+         */
+        void FetchBaseContainers(set<string> &Batch_ContainerIDset, unordered_map<string, uint32_t> &Batch_ContainerRefNum, UpOutSGX_t *_upOutSGX);
+
         /**
          * @brief batch processing of delta chunks
          * 
@@ -276,10 +297,6 @@ class EcallFreqIndex : public EnclaveBase {
          * @param _chunkNum
          */
         void OutEntrySFGet(InQueryEntry_t *_inQueryBase, OutQueryEntry_t *_outQueryBase,uint32_t _chunkNum);
-
-        static void* GetSF_thread_func_f(void* arg);
-
-        static uint32_t* mt_n_get(uint32_t seed, int n);
 };
 
 #endif
\ No newline at end of file
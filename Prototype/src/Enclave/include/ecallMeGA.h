@@ -23,6 +23,8 @@
 #include "ecallCMSketch.h"
 #include "ecallEntryHeap.h"
 #include "ecallinContainercache.h"
+#include "ecallSuperFeature.h"
+#include "ecallWorkerPool.h"
 #include <sgx_thread.h>
 #include "md5.h"
 #include "util.h"
@@ -41,26 +43,6 @@ extern "C"
 
 
 
-struct Param
-{
-    int thread_id;
-    unsigned char *ptr;
-    EVP_MD_CTX *mdCtx;
-    uint8_t *SF;
-    EcallCrypto *cryptoObj_;
-    int chunksize;
-};
-
-struct GetSFTask{
-    int begin{0};
-    int end{0};
-    int thread_id;
-};
-
-extern vector<Param> param_list;
-extern pthread_mutex_t mutex2;
-extern pthread_t test_pthread[4];
-
 class EcallMeGA : public EnclaveBase {
     private:
         string myName_ = "SecureMeGA";
@@ -109,6 +91,15 @@ class EcallMeGA : public EnclaveBase {
          */
         void UpdateInsideIndexFreq(const string& chunkFp, uint32_t currentFreq);
 
+        /**
+         * @brief check whether a chunk is in the top-k index
+         * 
+         * @param chunkFp the chunk fp
+         * @return true it is in the index
+         * @return false it is not in the index
+         */
+        bool CheckInsideIndex(const string& chunkFp);
+
         /**
          * @brief check whether add this chunk to the heap
          * 
@@ -289,8 +280,6 @@ class EcallMeGA : public EnclaveBase {
          */
         void MeGAdeltaTure(InQueryEntry_t *_inQueryEntry, OutQueryEntry_t *_outQueryEntry, UpOutSGX_t *_upOutSGX,int &_batch_out_times,unordered_map<string,int> &MeGA_ContainerIDmap);
 
-        static uint32_t* mt_n_get(uint32_t seed, int n);
-
         /**
          * @brief copy superfeature from inqueryentry to outqueryentry
          * 
@@ -300,8 +289,6 @@ class EcallMeGA : public EnclaveBase {
          */
         void OutEntrySFGet(InQueryEntry_t *_inQueryBase, OutQueryEntry_t *_outQueryBase,uint32_t _chunkNum);
 
-        static void* GetSF_thread_func_f(void* arg);
-
 
 };
 
@@ -16,6 +16,7 @@
 #include "commonEnclave.h"
 #include "ecallEnc.h"
 #include "ecallLz4.h"
+#include "ecallWorkerPool.h"
 
 
 
@@ -39,19 +40,110 @@ class EcallRecvDecoder {
     private:
         string myName_ = "EcallRecvDecoder";
         EcallCrypto* cryptoObj_;
+        // the decode workers shared by the clients (NULL: decode on the restore thread)
+        EcallWorkerPool* restorePool_ = NULL;
         //InContainercache* InContainercache_;
 
         /**
-         * @brief recover a chunk
+         * @brief decrypt and decompress a unique chunk
          * 
-         * @param chunkBuffer the chunk buffer
+         * @param chunkBuffer the chunk buffer (followed by its iv)
          * @param chunkSize the chunk size
-         * @param restoreChunkBuf the restore chunk buffer
+         * @param outputBuffer the buffer of the plaintext chunk (MAX_CHUNK_SIZE) <return>
          * @param cipherCtx the pointer to the EVP cipher
+         * @return uint32_t the size of the plaintext chunk
+         */
+        uint32_t DecodeUniqueChunk(uint8_t* chunkBuffer, uint32_t chunkSize,
+            uint8_t* outputBuffer, EVP_CIPHER_CTX* cipherCtx);
+
+        /**
+         * @brief add a container to the open window
+         * 
+         * @param sgxClient the enclave client
+         * @param containerID the container ID
+         * @return uint32_t the index of the container in the window
+         */
+        uint32_t AddWindowContainer(EnclaveClient* sgxClient, string& containerID);
+
+        /**
+         * @brief close the open window, and let the outside application prefetch its containers
          * 
+         * @param sgxClient the enclave client
+         * @param resOutSGX the pointer to the out-enclave var
+         */
+        void CloseWindow(EnclaveClient* sgxClient, ResOutSGX_t* resOutSGX);
+
+        /**
+         * @brief load the containers of a window, restore its chunks and send them
+         * 
+         * @param window the window
+         * @param resOutSGX the pointer to the out-enclave var
+         * @param finalFlag the window is the last one of the restore
          */
-        void RecoverOneChunk(uint8_t* chunkBuffer, uint32_t chunkSize, 
-            SendMsgBuffer_t* restoreChunkBuf, EVP_CIPHER_CTX* cipherCtx);
+        void DecodeWindow(RestoreWindow_t& window, ResOutSGX_t* resOutSGX, bool finalFlag);
+
+        /**
+         * @brief plan the reads of a chunk into the forward assembly area of the open window
+         * 
+         * @param sgxClient the enclave client
+         * @param recipeEntry the recipe entry of the chunk
+         * @param baseAddr the address of its base chunk (NULL if it is not a delta chunk)
+         */
+        void AddFaaChunk(EnclaveClient* sgxClient, RecipeEntry_t* recipeEntry,
+            RecipeEntry_t* baseAddr);
+
+        /**
+         * @brief add a planned read to its container in the open window
+         * 
+         * @param sgxClient the enclave client
+         * @param containerID the container ID
+         * @param faaRead the planned read
+         */
+        void AddFaaRead(EnclaveClient* sgxClient, string& containerID, FaaRead_t& faaRead);
+
+        /**
+         * @brief restore a window with the forward assembly area: read each of its containers once 
+         * to fill the slots, then send the chunks in the recipe order
+         * 
+         * @param window the window
+         * @param resOutSGX the pointer to the out-enclave var
+         * @param finalFlag the window is the last one of the restore
+         */
+        void DecodeFaaWindow(RestoreWindow_t& window, ResOutSGX_t* resOutSGX, bool finalFlag);
+
+        /**
+         * @brief encrypt the restored chunks with the session key and send them
+         * 
+         * @param resOutSGX the pointer to the out-enclave var
+         * @param endFlag this is the last batch of the restore
+         */
+        void SendRestoreChunk(ResOutSGX_t* resOutSGX, bool endFlag);
+
+        /**
+         * @brief run the decode tasks of a client (on the workers if any), and clear them
+         * 
+         * @param sgxClient the enclave client
+         */
+        void RunTasks(EnclaveClient* sgxClient);
+
+        /**
+         * @brief insert the base chunks decoded by the tasks to the base cache
+         * 
+         * @param sgxClient the enclave client
+         * @param missBaseList the (base chunk fp, base slot) list
+         */
+        void InsertBaseCache(EnclaveClient* sgxClient,
+            vector<pair<uint8_t*, uint8_t*>>& missBaseList);
+
+        /**
+         * @brief append the decoded chunks in the slots to the restore buffer, send it once it is full
+         * 
+         * @param resOutSGX the pointer to the out-enclave var
+         * @param slotBase the first slot
+         * @param slotNum the number of slots
+         * @param finalFlag the last slot ends the restore
+         */
+        void SendSlots(ResOutSGX_t* resOutSGX, uint8_t* slotBase, size_t slotNum, bool finalFlag);
     public:
         int lz4_times = 0;
         uint64_t _restoretime = 0;
@@ -93,6 +185,17 @@ class EcallRecvDecoder {
          */
         void ProcRecipeTailBatch(ResOutSGX_t* resOutSGX);
 
+        /**
+         * @brief run a decode task, write the chunk size and the chunk to its slot
+         * 
+         * @param task the task
+         * @param cipherCtx the cipher ctx of the running thread
+         */
+        void RunTask(RestoreTask_t& task, EVP_CIPHER_CTX* cipherCtx);
+
+        // the hooks of the decode workers, the tasks are RestoreTask_t, each worker owns a cipher ctx
+        static const WorkerHandler_t poolHandler_;
+
         uint8_t* xd3_decode(const uint8_t *in, size_t in_size, const uint8_t *ref, size_t ref_size, size_t *res_size);
 
         int EDeltaDecode(uint8_t *deltaBuf, uint32_t deltaSize, uint8_t *baseBuf,
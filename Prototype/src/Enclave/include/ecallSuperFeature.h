@@ -0,0 +1,122 @@
+/**
+ * @file ecallSuperFeature.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the interface of the superfeature engine inside the enclave
+ * @version 0.1
+ * @date 2024-03-02
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef ECALL_SUPER_FEATURE_H
+#define ECALL_SUPER_FEATURE_H
+
+#include "commonEnclave.h"
+#include "ecallEnc.h"
+#include "ecallWorkerPool.h"
+
+// the layout of the superfeature
+static const uint32_t SF_WINDOW_SIZE = 48;
+static const uint32_t SF_FEATURE_NUM = 12;
+static const uint32_t SF_SUPER_NUM = 3;
+static const uint32_t SF_GROUP_SIZE = SF_FEATURE_NUM / SF_SUPER_NUM;
+
+// the parameters of the rabin-karp rolling hash
+static const uint32_t SF_RABIN_A = 37;
+static const uint32_t SF_RABIN_MOD = 1000000007;
+
+// the seed of the gear table
+static const uint64_t SF_GEAR_SEED = 314159;
+
+// the superfeature task of one unique chunk
+struct Param {
+    unsigned char* ptr;
+    uint8_t* SF;
+    EcallCrypto* cryptoObj_;
+    int chunksize;
+};
+
+class EcallSuperFeature {
+    private:
+        string myName_ = "EcallSuperFeature";
+
+        // (b * A^(w-1)) % MOD for each byte value b, used to roll the byte out of the window
+        uint64_t rabinOutTable_[256];
+
+        // MOD - rabinOutTable_[b], used by the SIMD kernel to avoid the signed compare
+        uint64_t rabinNegOutTable_[256];
+
+        // the random table of the gear hash
+        uint32_t gearTable_[256];
+
+        /**
+         * @brief get the max rabin-karp fingerprint of a sub-chunk
+         *
+         * @param ptr the pointer of chunk content
+         * @param begin the begin offset of the sub-chunk
+         * @param end the end offset of the sub-chunk
+         * @return uint32_t the feature
+         */
+        uint32_t RabinFeature(const uint8_t* ptr, int begin, int end);
+
+        /**
+         * @brief get the max gear fingerprint of a sub-chunk
+         *
+         * @param ptr the pointer of chunk content
+         * @param begin the begin offset of the sub-chunk
+         * @param end the end offset of the sub-chunk
+         * @return uint32_t the feature
+         */
+        uint32_t GearFeature(const uint8_t* ptr, int begin, int end);
+
+        /**
+         * @brief get the max rabin-karp fingerprints of all sub-chunks, the sub-chunks
+         * are advanced in parallel SIMD lanes if the enclave is built with AVX2/SSE4.1
+         *
+         * @param ptr the pointer of chunk content
+         * @param subchunkIndex the boundaries of the sub-chunks (SF_FEATURE_NUM + 1)
+         * @param feature the output features (SF_FEATURE_NUM)
+         */
+        void RabinFeatureAll(const uint8_t* ptr, const int* subchunkIndex, uint32_t* feature);
+
+    public:
+        /**
+         * @brief Construct a new Ecall Super Feature object
+         *
+         */
+        EcallSuperFeature();
+
+        /**
+         * @brief Destroy the Ecall Super Feature object
+         *
+         */
+        ~EcallSuperFeature();
+
+        /**
+         * @brief extract the features of a chunk, grouped by superfeature
+         *
+         * @param ptr the pointer of chunk content
+         * @param chunkSize the chunk size
+         * @param featureGroup the output buffer (SF_SUPER_NUM * SF_GROUP_SIZE),
+         * the features of the i-th superfeature are stored in [i * SF_GROUP_SIZE, (i + 1) * SF_GROUP_SIZE)
+         */
+        void ExtractFeature(const uint8_t* ptr, int chunkSize, uint64_t* featureGroup);
+
+        /**
+         * @brief compute the superfeatures of a chunk
+         *
+         * @param ptr the pointer of chunk content
+         * @param chunkSize the chunk size
+         * @param mdCtx the hasher ctx (owned by the calling thread)
+         * @param cryptoObj the crypto obj
+         * @param SF the output buffer (SF_SUPER_NUM * CHUNK_HASH_SIZE)
+         */
+        void GenerateSuperFeature(const uint8_t* ptr, int chunkSize, EVP_MD_CTX* mdCtx,
+            EcallCrypto* cryptoObj, uint8_t* SF);
+
+        // the hooks of the superfeature workers, the tasks are Param, each worker owns a hasher ctx
+        static const WorkerHandler_t poolHandler_;
+};
+
+#endif
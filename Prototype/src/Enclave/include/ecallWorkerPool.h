@@ -0,0 +1,115 @@
+/**
+ * @file ecallWorkerPool.h
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief define the interface of the persistent worker pool inside the enclave
+ * @version 0.1
+ * @date 2024-03-27
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#ifndef ECALL_WORKER_POOL_H
+#define ECALL_WORKER_POOL_H
+
+#include "pthread.h"
+#include "stdint.h"
+#include "string"
+#include "vector"
+
+using namespace std;
+
+// the max number of pending range jobs in the queue
+static const uint32_t WORKER_POOL_QUEUE_SIZE = 64;
+
+// the hooks of a pool
+struct WorkerHandler_t {
+    // create the context a worker owns for its lifetime (e.g., a cipher ctx)
+    void* (*NewCtx)();
+    // free the context of a worker
+    void (*FreeCtx)(void* ctx);
+    // run a task of a task list with the context of the worker
+    void (*RunTask)(void* owner, void* taskList, uint32_t taskID, void* ctx);
+};
+
+// the completion barrier of one batch
+struct WorkerBatch_t {
+    uint32_t pendingJob;
+    pthread_cond_t doneCond;
+};
+
+// a contiguous range of tasks in a batch
+struct WorkerJob_t {
+    void* taskList;
+    uint32_t begin;
+    uint32_t end;
+    WorkerBatch_t* batch;
+};
+
+class EcallWorkerPool {
+    private:
+        string myName_;
+
+        // the task hooks and their owner
+        WorkerHandler_t handler_;
+        void* owner_;
+
+        // the long-lived workers
+        vector<pthread_t> workerList_;
+        uint32_t workerNum_;
+
+        // the bounded ring queue of range jobs
+        WorkerJob_t jobQueue_[WORKER_POOL_QUEUE_SIZE];
+        uint32_t queueHead_ = 0;
+        uint32_t queueTail_ = 0;
+        uint32_t queueNum_ = 0;
+
+        pthread_mutex_t queueLck_;
+        pthread_cond_t notEmptyCond_;
+        pthread_cond_t notFullCond_;
+
+        bool stopFlag_ = false;
+
+        /**
+         * @brief the main loop of a worker, the worker owns its context for its lifetime
+         *
+         * @param arg the pointer to the pool
+         * @return void* NULL
+         */
+        static void* WorkerLoop(void* arg);
+
+        /**
+         * @brief push a job to the queue, block if the queue is full
+         *
+         * @param job the range job
+         */
+        void PushJob(WorkerJob_t& job);
+
+    public:
+        /**
+         * @brief Construct a new Ecall Worker Pool object
+         *
+         * @param poolName the name of the pool
+         * @param workerNum the number of workers (each holds a TCS until the pool is destroyed)
+         * @param handler the task hooks
+         * @param owner the owner passed to the task hook
+         */
+        EcallWorkerPool(const string& poolName, uint32_t workerNum,
+            const WorkerHandler_t& handler, void* owner);
+
+        /**
+         * @brief Destroy the Ecall Worker Pool object
+         *
+         */
+        ~EcallWorkerPool();
+
+        /**
+         * @brief run a batch of tasks, block until all tasks are done
+         *
+         * @param taskList the task list
+         * @param taskNum the number of tasks
+         */
+        void ProcessBatch(void* taskList, uint32_t taskNum);
+};
+
+#endif
@@ -63,7 +63,7 @@ class InContainercache{
          * @return true
          * @return false
          */
-        bool ExistsInCache(string& name);
+        bool ExistsInCache(const string& name);
 
         /**
          * @brief Get the target container content
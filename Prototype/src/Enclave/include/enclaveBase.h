@@ -72,11 +72,15 @@ class EnclaveBase {
          * @param chunkBuffer the chunk buffer
          * @param chunkSize the chunk size
          * @param upOutSGX the upload out-enclave var
+         * @param compressedChunk the LZ4 form sent by the client (NULL: compress it here)
+         * @param compressedSize the size of the LZ4 form
          */
         void ProcessUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuffer, 
-            uint32_t chunkSize, UpOutSGX_t* upOutSGX);
+            uint32_t chunkSize, UpOutSGX_t* upOutSGX, uint8_t* compressedChunk = NULL,
+            uint32_t compressedSize = 0);
 
-        void ProcessSheUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuffer, uint32_t chunkSize, UpOutSGX_t* upOutSGX, uint8_t* chunksf, uint8_t* chunkfp);
+        void ProcessSheUniqueChunk(RecipeEntry_t* chunkAddr, uint8_t* chunkBuffer, uint32_t chunkSize, UpOutSGX_t* upOutSGX, uint8_t* chunksf, uint8_t* chunkfp,
+            uint8_t* compressedChunk = NULL, uint32_t compressedSize = 0);
 
         /**
          * @brief update the index store
@@ -112,6 +116,49 @@ class EnclaveBase {
          */
         void ResetCurrentSegment(EnclaveClient* sgxClient);
 
+        /**
+         * @brief decrypt a received chunk batch with the session key, and decompress the chunks
+         * sent in the LZ4 form (their compressed form is kept in the query entries)
+         * 
+         * @param recvChunkBuf the recv chunk buffer
+         * @param sgxClient the current client
+         * @return uint8_t* the plaintext batch
+         */
+        uint8_t* DecryptBatch(SendMsgBuffer_t* recvChunkBuf, EnclaveClient* sgxClient);
+
+        /**
+         * @brief parse a chunk of the received batch: compute the hash over the plaintext chunk,
+         * or take the fingerprint sent instead of the body of a pre-filtered chunk
+         * 
+         * @param mdCtx the hash ctx
+         * @param recvBuffer the decrypted batch
+         * @param currentOffset the offset of the chunk in the batch, moved to the next chunk
+         * @param inQueryEntry the query entry of the chunk
+         * @return true the chunk body is received
+         * @return false only the fingerprint is received
+         */
+        bool ParseChunk(EVP_MD_CTX* mdCtx, uint8_t* recvBuffer, size_t& currentOffset,
+            InQueryEntry_t* inQueryEntry);
+
+        /**
+         * @brief check that no unique chunk of the batch is pre-filtered (i.e., has no body)
+         * 
+         * @param inQueryBase the in-enclave query entries of the batch
+         * @param outQueryBase the out-enclave query entries of the batch
+         * @param chunkNum the number of chunks in the batch
+         */
+        void CheckChunkBody(InQueryEntry_t* inQueryBase, OutQueryEntry_t* outQueryBase,
+            uint32_t chunkNum);
+
+        /**
+         * @brief check whether a chunk is in the in-enclave (top-k) index
+         * 
+         * @param chunkFp the chunk fp
+         * @return true it is in the index
+         * @return false it is not in the index (or there is no in-enclave index)
+         */
+        virtual bool CheckInsideIndex(const string& chunkFp);
+
         /**
          * @brief Get the Time Differ object
          * 
@@ -209,6 +256,14 @@ class EnclaveBase {
          */
         virtual void ProcessTailBatch(UpOutSGX_t* upOutSGX) = 0;
 
+        /**
+         * @brief answer a fingerprint batch with the duplicate bitmap (the indexes are only queried)
+         * 
+         * @param recvFpBuf the recv fingerprint buffer, the encrypted bitmap is written back to it
+         * @param upOutSGX the pointer to enclave-related var
+         */
+        virtual void ProcessFpBatch(SendMsgBuffer_t* recvFpBuf, UpOutSGX_t* upOutSGX);
+
 
         virtual void ProcessOffline(SendMsgBuffer_t* recvChunkBuf,UpOutSGX_t* upOutSGX) = 0;
 
@@ -21,6 +21,8 @@
 #include "ecallFreqIndex.h"
 #include "ecallMeGA.h"
 #include "ecallDEBE.h"
+#include "ecallSuperFeature.h"
+#include "ecallWorkerPool.h"
 
 // for ecall store
 #include "ecallStorage.h"
@@ -56,6 +58,15 @@ void Ecall_Destroy_Upload();
 void Ecall_ProcChunkBatch(SendMsgBuffer_t* recvChunkBuf,
     UpOutSGX_t* upOutSGX);
 
+/**
+ * @brief answer a batch of chunk fingerprints with the duplicate bitmap
+ * 
+ * @param recvFpBuf the recv fingerprint buffer
+ * @param upOutSGX the pointer to enclave-needed structure
+ */
+void Ecall_ProcFpBatch(SendMsgBuffer_t* recvFpBuf,
+    UpOutSGX_t* upOutSGX);
+
 /**
  * @brief process the tail batch 
  * 
@@ -10,6 +10,7 @@
 #include <vector>
 #include <filesystem>
 #include <sys/stat.h>
+#include <fcntl.h>
 
 #include "sgx_urts.h"
 
@@ -30,6 +31,9 @@ namespace OutEnclave {
     extern EnclaveRecvDecoder* enclaveRecvDecoderObj_;
     extern string myName_;
 
+    // the containers shared by all clients
+    extern ContainerStore* containerStoreObj_;
+
     // for persistence
     extern ofstream outSealedFile_;
     extern ifstream inSealedFile_;
@@ -44,9 +48,11 @@ namespace OutEnclave {
      * @param indexStoreObj the pointer to the index
      * @param storageCoreObj the pointer to the storageCoreObj
      * @param enclaveDecoderObj the pointer to the enclave recvDecoder
+     * @param containerStoreObj the pointer to the container store
      */
     void Init(DataWriter* dataWriterObj, AbsDatabase* indexStoreObj,
-        StorageCore* storageCoreObj, EnclaveRecvDecoder* enclaveRecvDecoderObj);
+        StorageCore* storageCoreObj, EnclaveRecvDecoder* enclaveRecvDecoderObj,
+        ContainerStore* containerStoreObj);
 
     /**
      * @brief destroy the ocall var
@@ -181,6 +187,29 @@ void Ocall_PrintfBinary(const uint8_t* buffer, size_t len);
  */
 void Ocall_GetReqContainers(void* outClient);
 
+/**
+ * @brief post the containers of a future load of the restore to the read-ahead
+ * 
+ * @param outClient the out-enclave client ptr
+ * @param idBuffer the container IDs in the access order
+ * @param idSize the size of the container IDs
+ */
+void Ocall_PrefetchContainers(void* outClient, uint8_t* idBuffer, size_t idSize);
+
+/**
+ * @brief load the base containers in _baseFetch.idBuffer from the container store
+ * 
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_FetchBaseContainers(void* outClient);
+
+/**
+ * @brief read the base chunk record of the current entry instead of its whole container
+ * 
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_getRefChunk(void* outClient);
+
 /**
  * @brief send the restore chunks to the client
  * 
@@ -218,14 +247,14 @@ void Ocall_CreateUUID(uint8_t* id, size_t len);
 void Ocall_OneRecipe(void* outClient);
 
 /**
- * @brief get the single target container
+ * @brief get the record of the target chunk (chunkAddr) in its container
  * 
  * @param outClient the out-enclave client ptr
  */
 void Ocall_OneContainer(void* outClient);
 
 /**
- * @brief get the single target delta container
+ * @brief get the record of the target chunk (chunkAddr) in its delta container
  * 
  * @param outClient the out-enclave client ptr
  */
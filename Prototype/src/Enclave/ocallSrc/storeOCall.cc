@@ -28,6 +28,9 @@ namespace OutEnclave {
     EnclaveRecvDecoder* enclaveRecvDecoderObj_ = NULL;
     string myName_ = "OCall";
 
+    // the containers shared by all clients
+    ContainerStore* containerStoreObj_ = NULL;
+
     // for lock
     pthread_rwlock_t outIdxLck_;
 
@@ -44,15 +47,18 @@ using namespace OutEnclave;
  * @param indexStoreObj the pointer to the index
  * @param storageCoreObj the pointer to the storageCoreObj
  * @param enclaveDecoderObj the pointer to the enclave recvDecoder
+ * @param containerStoreObj the pointer to the container store
  */
 void OutEnclave::Init(DataWriter* dataWriterObj,
     AbsDatabase* indexStoreObj,
     StorageCore* storageCoreObj,
-    EnclaveRecvDecoder* enclaveRecvDecoderObj) {
+    EnclaveRecvDecoder* enclaveRecvDecoderObj,
+    ContainerStore* containerStoreObj) {
     dataWriterObj_ = dataWriterObj;
     indexStoreObj_ = indexStoreObj;
     storageCoreObj_ = storageCoreObj;
     enclaveRecvDecoderObj_ = enclaveRecvDecoderObj;
+    containerStoreObj_ = containerStoreObj;
     tmpOcallcontainer = (uint8_t*)malloc(MAX_CONTAINER_SIZE);
 
     // init the lck
@@ -335,6 +341,19 @@ void Ocall_GetReqContainers(void* outClient) {
     return ;
 }
 
+/**
+ * @brief post the containers of a future load of the restore to the read-ahead
+ * 
+ * @param outClient the out-enclave client ptr
+ * @param idBuffer the container IDs in the access order
+ * @param idSize the size of the container IDs
+ */
+void Ocall_PrefetchContainers(void* outClient, uint8_t* idBuffer, size_t idSize) {
+    ClientVar* outClientPtr = (ClientVar*)outClient;
+    outClientPtr->_restorePrefetcher->Post(idBuffer, idSize / CONTAINER_ID_LENGTH);
+    return ;
+}
+
 /**
  * @brief send the restore chunks to the client
  * 
@@ -360,18 +379,14 @@ void Ocall_QueryOutIndex(void* outClient) {
     ClientVar* outClientPtr = (ClientVar*)outClient;
     OutQuery_t* outQuery = &outClientPtr->_outQuery;
     OutQueryEntry_t* entry = outQuery->outQueryBase;
-    string tmpChunkAddress;
-    tmpChunkAddress.resize(sizeof(RecipeEntry_t), 0);
-    bool queryResult;
+    // check the outside index in a batch, the result is stored in the buffer
+    vector<uint8_t> queryResult(outQuery->queryNum);
+    indexStoreObj_->QueryBatch(entry->chunkHash, outQuery->queryNum, sizeof(OutQueryEntry_t),
+        (uint8_t*)&entry->chunkAddr, sizeof(OutQueryEntry_t), queryResult.data());
     for (size_t i = 0; i < outQuery->queryNum; i++) {
-        // check the outside index
-        queryResult = indexStoreObj_->QueryBuffer((char*)entry->chunkHash, 
-            CHUNK_HASH_SIZE, tmpChunkAddress);
-        if (queryResult) {
+        if (queryResult[i]) {
             // this chunk is duplicate in the outside index
-            // store the query result in the buffer 
             entry->dedupFlag = DUPLICATE;
-            memcpy(&entry->chunkAddr, &tmpChunkAddress[0], sizeof(RecipeEntry_t));
         } else {
             entry->dedupFlag = UNIQUE;
         }
@@ -439,18 +454,19 @@ void Ocall_ReadIndexStoreBatch(bool* ret, const char* key, size_t keySize,
     ClientVar* outClientPtr = (ClientVar*)outClient;
     size_t recipeNum = keySize / CHUNK_HASH_SIZE;
     //tool::Logging("DEBUG", "Inside recipeNum is %d\n", recipeNum);
-    outClientPtr->_tmpBatchQueryBufferStr.resize(0,recipeNum*sizeof(RecipeEntry_t));
-    string value;
+    outClientPtr->_tmpBatchQueryBufferStr.assign(recipeNum * sizeof(RecipeEntry_t), 0);
+    vector<uint8_t> queryResult(recipeNum);
+    indexStoreObj_->QueryBatch((const uint8_t*)key, recipeNum, CHUNK_HASH_SIZE,
+        (uint8_t*)&outClientPtr->_tmpBatchQueryBufferStr[0], sizeof(RecipeEntry_t),
+        queryResult.data());
+    *ret = true;
     for(size_t i = 0; i < recipeNum; i++)
     {
-        value.resize(sizeof(RecipeEntry_t), 0);
-        *ret=indexStoreObj_->QueryBuffer(key , CHUNK_HASH_SIZE, value);
-        if(!(*ret)){
+        if(!queryResult[i]){
             tool::PrintBinaryArray((uint8_t*)key,CHUNK_HASH_SIZE);
             tool::Logging("DEBUG","Not find!!!\n");
+            *ret = false;
         }
-        outClientPtr->_tmpBatchQueryBufferStr += value;
-        //memcpy(outClientPtr->_tmpBatchQueryBufferStr + i * sizeof(RecipeEntry_t), (uint8_t*)&value[0], sizeof(RecipeEntry_t));
         key += CHUNK_HASH_SIZE;
     }
     //*retVal = outClientPtr->_tmpBatchQueryBufferStr;
@@ -466,23 +482,12 @@ void Ocall_QueryBaseIndex(void* outClient) {
     ClientVar* outClientPtr = (ClientVar*)outClient;
     OutQuery_t* outQuery = &outClientPtr->_baseoutQuery;
     OutQueryEntry_t* entry = outQuery->outQueryBase;
-    string tmpChunkAddress;
-    tmpChunkAddress.resize(sizeof(RecipeEntry_t), 0);
-    bool queryResult;
+    // check the outside index in a batch, the result is stored in the buffer
+    vector<uint8_t> queryResult(outQuery->queryNum);
+    indexStoreObj_->QueryBatch(entry->chunkHash, outQuery->queryNum, sizeof(OutQueryEntry_t),
+        (uint8_t*)&entry->chunkAddr, sizeof(OutQueryEntry_t), queryResult.data());
     for (size_t i = 0; i < outQuery->queryNum; i++) {
-        // check the outside index
-       // fprintf(stderr, "base chunk hash 3: %02x\n", entry->chunkHash[10]);
-        queryResult = indexStoreObj_->QueryBuffer((char*)entry->chunkHash, 
-            CHUNK_HASH_SIZE, tmpChunkAddress);
-        if (queryResult) {
-            // this chunk is duplicate in the outside index
-            // store the query result in the buffer 
-            //fprintf(stderr, "find out!\n");
-            //fprintf(stderr, "address:%s\n",tmpChunkAddress.c_str());
-            memcpy(&entry->chunkAddr, &tmpChunkAddress[0], sizeof(RecipeEntry_t));
-
-
-        } else {
+        if (!queryResult[i]) {
             fprintf(stderr, "no find out:%d!\n",i);
             for(int i = 0;i<CHUNK_HASH_SIZE;i++){
                 fprintf(stderr, "%02x\n",entry->chunkHash[i]);
@@ -507,6 +512,9 @@ void Ocall_FreeContainer(void* outClient) {
         free(entry->containerbuffer);
         entry++;
     }
+    // the enclave is done with the containers of this batch
+    outClientPtr->_containerCache->Unpin(outClientPtr->_reqPinList);
+    outClientPtr->_containerStore->Release(outClientPtr->_reqViewList);
     return ;
 }
 
@@ -563,110 +571,87 @@ void Ocall_QueryOutBasechunk(void* outClient){
 void Ocall_getRefContainer(void* outClient) {
     ClientVar* outClientPtr = (ClientVar*)outClient;
     OutQuery_t* outQuery = &outClientPtr->_outQuery;
-    OutQueryEntry_t* entry = outQuery->outQueryBase;
-    string tmpbaseChunkAddress;
-
+    OutQueryEntry_t* entry = outQuery->outQueryBase + outQuery->currNum;
+    ContainerStore* containerStore = outClientPtr->_containerStore;
 
-    tmpbaseChunkAddress.resize(sizeof(RecipeEntry_t), 0);
-    for(size_t i = 0;i < outQuery->currNum;i++){
-        entry++;
+    if (entry->deltaFlag != OUT_DELTA && entry->deltaFlag != DELTA) {
+        return ;
     }
-    if(entry->deltaFlag == OUT_DELTA){
+
+    // the enclave has copied the last container to its cache
+    containerStore->Release(outClientPtr->_refViewList);
+
     string tmpContainerIDStr;
-    uint8_t* tempcontainerbuf;
-    //tempcontainerbuf = (uint8_t*)malloc(MAX_CONTAINER_SIZE);
     tmpContainerIDStr.assign((char*)entry->basechunkAddr.containerName, CONTAINER_ID_LENGTH);
-   // fprintf(stderr, "containerid:%s\n",tmpContainerIDStr.c_str());
-/*     if(indexStoreObj_->QueryVersion((char*)entry->basechunkAddr.containerName,CONTAINER_ID_LENGTH,2)){
-      //  fprintf(stderr, "CONTAINER IS OKKK\n");
-    }else{
-        //fprintf(stderr, "CONTAINER IS not OKKK-------------------------------------------------------------------------------------------------------\n");
-        entry->chunkAddr.deltaFalg = DELAY_DELTA;
-        return; 
-    }  */
-
-    ifstream containerIn;
-    string containerNamePrefix_ = "Base-Containers/";
-    string containerNameTail_ = config.GetContainerSuffix();
-    
-    string readFileNameStr = containerNamePrefix_ + tmpContainerIDStr + containerNameTail_;
-  //  fprintf(stderr, "%s\n",readFileNameStr.c_str());
-
-    containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-    if (!containerIn.is_open()) {
-           //fprintf(stderr, "container have not store on disk1: %s\n",tmpContainerIDStr.c_str());
-            entry->deltaFlag = NO_DELTA;
-            //free(tempcontainerbuf);
-            return;
-    }
 
-    containerIn.seekg(0, ios_base::end);
-    int readSize = containerIn.tellg();
-    containerIn.seekg(0, ios_base::beg);
-    int containerSize = 0;
-  //  fprintf(stderr, "container size:%d\n",readSize);
-
-    containerSize = readSize;
-        // read compression data
-    containerIn.read((char*)tmpOcallcontainer, containerSize);
-     if (containerIn.gcount() != containerSize) {
-            fprintf(stderr, "not match\n");
-            exit(EXIT_FAILURE);
-    } 
-    containerIn.close();
+    ContainerView_t containerView;
+    if (!containerStore->OpenContainer(tmpContainerIDStr, BASE_CONTAINER, containerView)) {
+        if (entry->deltaFlag == DELTA) {
+            fprintf(stderr, "container have not store on disk :%s\n",tmpContainerIDStr.c_str());
+        }
+        entry->deltaFlag = NO_DELTA;
+        return;
+    }
+    outClientPtr->_refViewList.push_back(containerView);
 
-    entry->containerbuffer = tmpOcallcontainer;
-    entry->containersize = containerSize;
+    entry->containerbuffer = containerView.data;
+    entry->containersize = containerView.size;
     entry->deltaFlag = DELTA;
+    return ;
+}
 
-    return;
-    }
+/**
+ * @brief read the base chunk record of the current entry instead of its whole container
+ *
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_getRefChunk(void* outClient) {
+    ClientVar* outClientPtr = (ClientVar*)outClient;
+    OutQuery_t* outQuery = &outClientPtr->_outQuery;
+    OutQueryEntry_t* entry = outQuery->outQueryBase + outQuery->currNum;
 
-    if(entry->deltaFlag == DELTA){
     string tmpContainerIDStr;
-    uint8_t* tempcontainerbuf;
-    //tempcontainerbuf = (uint8_t*)malloc(MAX_CONTAINER_SIZE);
     tmpContainerIDStr.assign((char*)entry->basechunkAddr.containerName, CONTAINER_ID_LENGTH);
-    //fprintf(stderr, "delay_containerid:%s\n",tmpContainerIDStr.c_str());
-    ifstream containerIn;
-    string containerNamePrefix_ = "Base-Containers/";
-    string containerNameTail_ = config.GetContainerSuffix();
-    
-    string readFileNameStr = containerNamePrefix_ + tmpContainerIDStr + containerNameTail_;
-  //  fprintf(stderr, "%s\n",readFileNameStr.c_str());
-
-    containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-    if (!containerIn.is_open()) {
-            fprintf(stderr, "container have not store on disk :%s\n",tmpContainerIDStr.c_str());
-            entry->deltaFlag = NO_DELTA;
-           // free(tempcontainerbuf);
-            return;
+    // only the record is valid in the buffer, the enclave does not cache it
+    if (!outClientPtr->_containerStore->ReadRecord(tmpContainerIDStr, BASE_CONTAINER,
+        entry->basechunkAddr.offset, entry->basechunkAddr.length, tmpOcallcontainer)) {
+        entry->deltaFlag = NO_DELTA;
+        return ;
     }
-    containerIn.seekg(0, ios_base::end);
-    int readSize = containerIn.tellg();
-    containerIn.seekg(0, ios_base::beg);
-    int containerSize = 0;
-   // fprintf(stderr, "delay_container size:%d\n",readSize);
-
-    containerSize = readSize;
-        // read compression data
-    containerIn.read((char*)tmpOcallcontainer, containerSize);
-     if (containerIn.gcount() != containerSize) {
-            fprintf(stderr, "not match\n");
-            exit(EXIT_FAILURE);
-    } 
-    containerIn.close();
-
     entry->containerbuffer = tmpOcallcontainer;
-    entry->containersize = containerSize;
-
-
-
-    entry->deltaFlag  = DELTA;
+    entry->containersize = entry->basechunkAddr.offset + CHUNK_RECORD_SIZE(entry->basechunkAddr.length);
+    entry->deltaFlag = DELTA;
+    return ;
+}
 
-    return;
+/**
+ * @brief load the base containers in _baseFetch.idBuffer from the container store
+ *
+ * @param outClient the out-enclave client ptr
+ */
+void Ocall_FetchBaseContainers(void* outClient) {
+    ClientVar* outClientPtr = (ClientVar*)outClient;
+    BaseFetch_t* baseFetch = &outClientPtr->_baseFetch;
+    ContainerStore* containerStore = outClientPtr->_containerStore;
+    uint32_t idNum = min(baseFetch->idNum, BASE_FETCH_NUM);
+
+    // the views of the last batch are not used anymore
+    containerStore->Release(outClientPtr->_baseViewList);
+
+    // the store starts the read-ahead of all missing containers before the enclave touches them
+    ContainerView_t containerView;
+    for (size_t i = 0; i < idNum; i++) {
+        string containerIDStr((char*)baseFetch->idBuffer + i * CONTAINER_ID_LENGTH,
+            CONTAINER_ID_LENGTH);
+        if (!containerStore->OpenContainer(containerIDStr, BASE_CONTAINER, containerView)) {
+            baseFetch->containerArray[i] = NULL;
+            baseFetch->sizeArray[i] = 0;
+            continue;
+        }
+        outClientPtr->_baseViewList.push_back(containerView);
+        baseFetch->containerArray[i] = containerView.data;
+        baseFetch->sizeArray[i] = containerView.size;
     }
-
     return ;
 }
 
@@ -894,29 +879,14 @@ void Ocall_OneContainer(void* outClient){
     string tmpContainerIDStr;
     tmpContainerIDStr.resize(CONTAINER_ID_LENGTH,0);
     tmpContainerIDStr.assign((char*)entry->chunkAddr.containerName,CONTAINER_ID_LENGTH);
-    ifstream containerIn;
-    string containerNamePrefix_ = "Base-Containers/";
-    string containerNameTail_ = config.GetContainerSuffix();
-    string readFileNameStr = containerNamePrefix_ + tmpContainerIDStr + containerNameTail_;
-    containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-        if (!containerIn.is_open()) {
-            fprintf(stderr, "there is something wrong\n");
-            fprintf(stderr, "Base chunk container: %s\n",readFileNameStr.c_str());
-            entry->offlineFlag = false;
-            return;
-    }
-
-    containerIn.seekg(0, ios_base::end);
-    int readSize = containerIn.tellg();
-    containerIn.seekg(0, ios_base::beg);
-    int containerSize = 0;
-    containerSize = readSize;
-    containerIn.read((char*)tmpOcallcontainer, containerSize);
-    if (containerIn.gcount() != containerSize) {
-        fprintf(stderr, "not match\n");
-        exit(EXIT_FAILURE);
+    // only read the record at chunkAddr.offset
+    if (!outClientPtr->_containerStore->ReadRecord(tmpContainerIDStr, BASE_CONTAINER,
+        entry->chunkAddr.offset, entry->chunkAddr.length, tmpOcallcontainer)) {
+        fprintf(stderr, "there is something wrong\n");
+        fprintf(stderr, "Base chunk container: %s\n",tmpContainerIDStr.c_str());
+        entry->offlineFlag = false;
+        return;
     }
-    containerIn.close();
     entry->containerbuffer = tmpOcallcontainer;
     entry->offlineFlag = true;
     return;
@@ -958,57 +928,37 @@ void Ocall_OFFline_updateIndex(void* outClient,size_t keySize){
 
 void Ocall_SavehotContainer(const char* containerID, uint8_t* containerBody, size_t currentSize)
 {
-    FILE* containerFile = NULL;
     tool::Logging("DEBUG", "in Ocall save hot container, containerid is %s\n", containerID);
 
 
 #if(CONTAINER_SEPARATE == 1)
-    string containerNamePrefix_ = "Delta-Containers/";
+    uint8_t containerType = DELTA_CONTAINER;
 #endif
 
 #if(CONTAINER_SEPARATE == 0)
-    string containerNamePrefix_ = "Base-Containers/";
+    uint8_t containerType = BASE_CONTAINER;
 #endif
 
 
-    string containerNameTail_ = config.GetContainerSuffix();
     string fileName(containerID, CONTAINER_ID_LENGTH);
-    string fileFullName = containerNamePrefix_ + fileName + containerNameTail_;
-    containerFile = fopen(fileFullName.c_str(), "wb");
-    if(!containerFile)
-    {
-        exit(EXIT_FAILURE);
-    }
-
-    fwrite((char*)containerBody, currentSize, 1, containerFile);
-    fclose(containerFile);
+    containerStoreObj_->SaveContainer(fileName, containerType, containerBody, currentSize);
     return ;
 }
 
 void Ocall_SaveColdContainer(const char* containerID, uint8_t* containerBody, size_t currentSize, bool* delta_flag)
 {
-    FILE* containerFile = NULL;
-    string containerNamePrefix_;
+    uint8_t containerType;
     //tool::Logging("CCLOD", "in ocall save cold container. containerid is %s\n", containerID);
     if(*delta_flag)
     {
-        containerNamePrefix_ = "Delta-Containers/";
+        containerType = DELTA_CONTAINER;
     } else
     {
-        containerNamePrefix_ = "Base-Containers/";
+        containerType = BASE_CONTAINER;
     }
-    string containerNameTail_ = config.GetContainerSuffix();
     string fileName;
     fileName.assign(containerID, CONTAINER_ID_LENGTH);
-    string fileFullName = containerNamePrefix_ + fileName + containerNameTail_;
-    //tool::Logging("DEBUG", "fullFileName is  %s\n", fileFullName.c_str());
-    containerFile = fopen(fileFullName.c_str(), "wb");
-    if(!containerFile)
-    {
-        exit(EXIT_FAILURE);
-    }
-    fwrite((char*)containerBody, currentSize, 1, containerFile);
-    fclose(containerFile);
+    containerStoreObj_->SaveContainer(fileName, containerType, containerBody, currentSize);
     return ;
 }
 
@@ -1120,29 +1070,13 @@ void Ocall_OneDeltaContainer(void* outClient)
     string tmpContainerIDStr;
     tmpContainerIDStr.resize(CONTAINER_ID_LENGTH,0);
     tmpContainerIDStr.assign((char*)entry->chunkAddr.containerName,CONTAINER_ID_LENGTH);
-    ifstream containerIn;
-    string containerNamePrefix_ = "Delta-Containers/";
-    string containerNameTail_ = config.GetContainerSuffix();
-    string readFileNameStr = containerNamePrefix_ + tmpContainerIDStr + containerNameTail_;
-    containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-        if (!containerIn.is_open()) {
-            fprintf(stderr, "there is something wrong\n");
-            fprintf(stderr, "Delta chunk container: %s\n",readFileNameStr.c_str());
-            return;
-    }
-
-    containerIn.seekg(0, ios_base::end);
-    int readSize = containerIn.tellg();
-    containerIn.seekg(0, ios_base::beg);
-    int containerSize = 0;
-    containerSize = readSize;
-    containerIn.read((char*)tmpOcallcontainer, containerSize);
-    if (containerIn.gcount() != containerSize) {
-        fprintf(stderr, "not match\n");
-        fprintf(stderr, "Delta chunk container: %s\n",readFileNameStr.c_str());
-        exit(EXIT_FAILURE);
+    // only read the record at chunkAddr.offset
+    if (!outClientPtr->_containerStore->ReadRecord(tmpContainerIDStr, DELTA_CONTAINER,
+        entry->chunkAddr.offset, entry->chunkAddr.length, tmpOcallcontainer)) {
+        fprintf(stderr, "there is something wrong\n");
+        fprintf(stderr, "Delta chunk container: %s\n",tmpContainerIDStr.c_str());
+        return;
     }
-    containerIn.close();
     entry->containerbuffer = tmpOcallcontainer;
     return;
 }
@@ -1155,34 +1089,21 @@ void Ocall_OneColdContainer(void* outClient, bool* deltaFlag) {
     tmpContainerIDStr.resize(CONTAINER_ID_LENGTH,0);
     tmpContainerIDStr.assign((char*)entry->chunkAddr.containerName,CONTAINER_ID_LENGTH);
     //tool::Logging("Ocall_OneColdContainer", "cold container id is %s\n", tmpContainerIDStr.c_str());
-    ifstream containerIn;
-    string containerNamePrefix_ = "Delta-Containers/";
-    string containerNameTail_ = config.GetContainerSuffix();
-    string readFileNameStr = containerNamePrefix_ + tmpContainerIDStr + containerNameTail_;
+    ContainerView_t containerView;
 
     *deltaFlag = 1;
-    containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-    if (!containerIn.is_open()) {
-        readFileNameStr = "Base-Containers/" + tmpContainerIDStr + containerNameTail_;
-        containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
+    if (!containerStoreObj_->OpenContainer(tmpContainerIDStr, DELTA_CONTAINER, containerView)) {
         *deltaFlag = 0;
-        if(!containerIn.is_open())
+        if(!containerStoreObj_->OpenContainer(tmpContainerIDStr, BASE_CONTAINER, containerView))
         {
             return ;
         }
     }
 
-    containerIn.seekg(0, ios_base::end);
-    int readSize = containerIn.tellg();
-    containerIn.seekg(0, ios_base::beg);
-    int containerSize = 0;
-    containerSize = readSize;
-    containerIn.read((char*)tmpOcallcontainer, containerSize);
-    if (containerIn.gcount() != containerSize) {
-        fprintf(stderr, "not match\n");
-        exit(EXIT_FAILURE);
-    }
-    containerIn.close();
+    // the enclave rewrites the container, copy it out of the store
+    uint32_t containerSize = min(containerView.size, MAX_CONTAINER_SIZE);
+    memcpy(tmpOcallcontainer, containerView.data, containerSize);
+    containerStoreObj_->Release(containerView);
     entry->containerbuffer = tmpOcallcontainer;
     entry->containersize = containerSize;
     return;
@@ -1195,95 +1116,30 @@ void Ocall_CleanLocalIndex(){
 void Ocall_GetMergeContainer(void* outClient)
 {
     ClientVar* outClientPtr = (ClientVar*)outClient;
-    // outClientPtr->_mergeContainerBuffer = (uint8_t*)malloc(MAX_CONTAINER_SIZE);
-    // namespace fs = std::filesystem;
-    std::vector<std::filesystem::path> baseContainerList_;
-    std::string basePath = "Base-Containers/";
-    // std::string deltaPath = "Delta-Containers/";
- 
-    // get container name and sort
-    try 
-    {
-        for (const auto& entry : std::filesystem::directory_iterator(basePath)) {
-            if (std::filesystem::is_regular_file(entry.status())) {
-                baseContainerList_.push_back(entry.path());
-            }
-        }
-
-        // for (const auto& entry : fs::directory_iterator(deltaPath)) {
-        //     if (fs::is_regular_file(entry.status())) {
-        //         outClientPtr->deltaContainerList_.push_back(entry.path());
-        //     }
-        // }
- 
-        std::sort(baseContainerList_.begin(), baseContainerList_.end());
-        // std::sort(outClientPtr->deltaContainerList_.begin(), outClientPtr->deltaContainerList_.end());
-    } 
-    catch (const std::filesystem::filesystem_error& e) 
-    {
-        std::cerr << e.what() << std::endl;
-    }
+    // the (container ID, size) list sorted by the container ID
+    vector<pair<string, uint32_t>> baseContainerList_;
+    containerStoreObj_->ListContainer(BASE_CONTAINER, baseContainerList_);
 
     uint32_t containerSize1;
     uint32_t containerSize2;
     // for base container
     for (int i = 1; i < baseContainerList_.size(); i++)
     {
-        std::ifstream container1(baseContainerList_[i-1], std::ifstream::ate | std::ifstream::binary);
-        std::ifstream container2(baseContainerList_[i], std::ifstream::ate | std::ifstream::binary);
-
-        if (container1 && container2) {
-            containerSize1 = container1.tellg();
-            container1.close();
-            containerSize2 = container2.tellg();
-            container2.close();
-            // tool::Logging(myName_.c_str(), "size1: %u, size2: %u.\n", containerSize1, containerSize2); 
-        }
-        else {
-            tool::Logging(myName_.c_str(), "in merge container, can not open container.\n"); 
-        }
+        containerSize1 = baseContainerList_[i-1].second;
+        containerSize2 = baseContainerList_[i].second;
+        // tool::Logging(myName_.c_str(), "size1: %u, size2: %u.\n", containerSize1, containerSize2); 
 
         if (containerSize1 + containerSize2 < MAX_CONTAINER_SIZE - 1)
         {
             // tool::Logging(myName_.c_str(), "add base pair.\n"); 
-            string containerName1 = baseContainerList_[i-1];
-            string containerName2 = baseContainerList_[i];
+            string containerName1 = baseContainerList_[i-1].first;
+            string containerName2 = baseContainerList_[i].first;
             pair<string, string> pairTmp(containerName1, containerName2);
             outClientPtr->baseMergePair.push_back(pairTmp);
             i++;
         }
     }
 
-    // containerSize1 = 0;
-    // containerSize2 = 0;
-    // // for delta container
-    // for (int i = 1; i < outClientPtr->deltaContainerList_.size(); i++)
-    // {
-    //     std::ifstream container1(outClientPtr->deltaContainerList_[i-1], std::ifstream::ate | std::ifstream::binary);
-    //     std::ifstream container2(outClientPtr->deltaContainerList_[i], std::ifstream::ate | std::ifstream::binary);
-
-    //     if (container1 && container2) {
-    //         containerSize1 = container1.tellg();
-    //         container1.close();
-    //         containerSize2 = container2.tellg();
-    //         container2.close();
-    //         tool::Logging(myName_.c_str(), "size1: %u, size2: %u.\n", containerSize1, containerSize2); 
-    //     }
-    //     else {
-    //         tool::Logging(myName_.c_str(), "in merge container, can not open container.\n"); 
-    //     }
-
-    //     if (containerSize1 + containerSize2 < MAX_CONTAINER_SIZE)
-    //     {
-    //         tool::Logging(myName_.c_str(), "add delta pair.\n"); 
-    //         string containerName1 = outClientPtr->deltaContainerList_[i-1];
-    //         string containerName2 = outClientPtr->deltaContainerList_[i];
-    //         pair<string, string> pairTmp(containerName1, containerName2);
-    //         outClientPtr->deltaMergePair.push_back(pairTmp);
-    //         i++;
-    //     }
-    // }
-
     if (outClientPtr->baseMergePair.size() != 0)
     {
         tool::Logging(myName_.c_str(), "have small containers, wait for merge.\n"); 
@@ -1318,8 +1174,8 @@ void Ocall_GetMergePair(void* outClient, uint8_t* containerID, uint32_t* size)
     if (outClientPtr->baseMergePair.size() != 0)
     {
         // get name
-        string containerName1 = outClientPtr->baseMergePair[0].first.substr(16, CONTAINER_ID_LENGTH);
-        string containerName2 = outClientPtr->baseMergePair[0].second.substr(16, CONTAINER_ID_LENGTH);
+        string containerName1 = outClientPtr->baseMergePair[0].first;
+        string containerName2 = outClientPtr->baseMergePair[0].second;
         tool::Logging(myName_.c_str(), "1st container name: %s.\n", containerName1.c_str()); 
         tool::Logging(myName_.c_str(), "2nd container name: %s.\n", containerName2.c_str()); 
         OutQueryEntry_t* entry = outClientPtr->_upOutSGX.outQuery->outQueryBase;
@@ -1327,34 +1183,23 @@ void Ocall_GetMergePair(void* outClient, uint8_t* containerID, uint32_t* size)
         memcpy(containerID, containerName1.c_str(), CONTAINER_ID_LENGTH);
     
         // get 1st container size
-        std::ifstream container1(outClientPtr->baseMergePair[0].first.c_str(), std::ifstream::ate | std::ifstream::binary);
+        ContainerView_t containerView;
         uint32_t containerSize1 = 0;
-        if (container1) {
-            containerSize1 = container1.tellg();
-            container1.close();
+        if (containerStoreObj_->OpenContainer(containerName1, BASE_CONTAINER, containerView)) {
+            containerSize1 = containerView.size;
+            containerStoreObj_->Release(containerView);
         }
         *size = containerSize1;
 
         // get 2nd container
-        ifstream containerIn;
-        // tool::Logging(myName_.c_str(), "2nd container path: %s.\n", outClientPtr->baseMergePair[0].second.c_str()); 
-        containerIn.open(outClientPtr->baseMergePair[0].second.c_str(), ifstream::in | ifstream::binary);
-        containerIn.seekg(0, ios_base::end);
-        int readSize = containerIn.tellg();
-        containerIn.seekg(0, ios_base::beg);
-        int containerSize = 0;
-        containerSize = readSize;
-        containerIn.read((char*)outClientPtr->_mergeContianer.body, containerSize);
-        // tool::Logging(myName_.c_str(), "out container: %d %d.\n", (int)outClientPtr->_mergeContainerBuffer[0],
-        //     (int)outClientPtr->_mergeContainerBuffer[1]); 
-        // tool::Logging(myName_.c_str(), "read %u bytes from 2nd containrt.\n", containerSize); 
-        if (containerIn.gcount() != containerSize) {
-            tool::Logging(myName_.c_str(), "container size: %u, read size: %u.\n", containerIn.gcount(), containerSize); 
-            fprintf(stderr, "not match\n");
+        if (!containerStoreObj_->OpenContainer(containerName2, BASE_CONTAINER, containerView) ||
+            containerView.size > MAX_CONTAINER_SIZE) {
+            tool::Logging(myName_.c_str(), "cannot read the 2nd container: %s.\n", containerName2.c_str()); 
             exit(EXIT_FAILURE);
         }
-        containerIn.close();
-        entry->containersize = containerSize;
+        memcpy(outClientPtr->_mergeContianer.body, containerView.data, containerView.size);
+        entry->containersize = containerView.size;
+        containerStoreObj_->Release(containerView);
     }
     else
     {
@@ -1366,21 +1211,29 @@ void Ocall_GetMergePair(void* outClient, uint8_t* containerID, uint32_t* size)
 void Ocall_MergeContent(void* outClient, uint8_t* containerBody, size_t currentSize)
 {
     ClientVar* outClientPtr = (ClientVar*)outClient;
-    string fileName = outClientPtr->baseMergePair[0].first;
-    
-    std::ofstream file(fileName.c_str(), std::ios::app);
-    file.write((char*)containerBody, currentSize);
+    string containerName1 = outClientPtr->baseMergePair[0].first;
+    string containerName2 = outClientPtr->baseMergePair[0].second;
+
+    // append the content to the 1st container, the store replaces it as a whole
+    ContainerView_t containerView;
+    vector<uint8_t> mergeBuffer;
+    if (containerStoreObj_->OpenContainer(containerName1, BASE_CONTAINER, containerView)) {
+        mergeBuffer.assign(containerView.data, containerView.data + containerView.size);
+        containerStoreObj_->Release(containerView);
+    }
+    mergeBuffer.insert(mergeBuffer.end(), containerBody, containerBody + currentSize);
+    containerStoreObj_->SaveContainer(containerName1, BASE_CONTAINER, mergeBuffer.data(),
+        mergeBuffer.size());
     // tool::Logging(myName_.c_str(), "write size: %u, write success.\n", currentSize);
-    file.close();
 
-    if (unlink(outClientPtr->baseMergePair[0].second.c_str()) == 0) {
-        tool::Logging(myName_.c_str(), "delete: %s success.\n", outClientPtr->baseMergePair[0].second.c_str());
+    if (containerStoreObj_->DeleteContainer(containerName2, BASE_CONTAINER)) {
+        tool::Logging(myName_.c_str(), "delete: %s success.\n", containerName2.c_str());
     } 
     else {
-        tool::Logging(myName_.c_str(), "delete: %s faled.\n", outClientPtr->baseMergePair[0].second.c_str());
+        tool::Logging(myName_.c_str(), "delete: %s faled.\n", containerName2.c_str());
     }
 
     outClientPtr->baseMergePair.erase(outClientPtr->baseMergePair.begin());
 
     return ;
-}
\ No newline at end of file
+}
@@ -72,6 +72,19 @@ void EnclaveIndex::ProcessOneBatch(SendMsgBuffer_t* recvChunkBuf,
     return ;
 }
 
+/**
+ * @brief answer a fingerprint batch with the duplicate bitmap
+ * 
+ * @param recvFpBuf the recv fingerprint buffer, the bitmap is written back to it
+ * @param upOutSGX the structure to store the enclave related variable
+ */
+void EnclaveIndex::ProcessFpBatch(SendMsgBuffer_t* recvFpBuf, 
+    UpOutSGX_t* upOutSGX) {
+    totalRecvDataSize_ += recvFpBuf->header->dataSize;
+    Ecall_ProcFpBatch(eidSGX_, recvFpBuf, upOutSGX);
+    return ;
+}
+
 void EnclaveIndex::ProcessOff(SendMsgBuffer_t* recvChunkBuf, 
     UpOutSGX_t* upOutSGX) {
 
@@ -34,10 +34,67 @@ DataReceiver::DataReceiver(AbsIndex* absIndexObj, SSLConnection* dataSecureChann
 DataReceiver::~DataReceiver() {
     fprintf(stderr, "========DataReceiver Info========\n");
     fprintf(stderr, "total receive batch num: %lu\n", batchNum_);
+    fprintf(stderr, "total receive fingerprint batch num: %lu\n", fpBatchNum_);
     fprintf(stderr, "total receive recipe end num: %lu\n", recipeEndNum_);
     fprintf(stderr, "=================================\n");
 }
 
+/**
+ * @brief receive the batches of a client into the free recv buffers
+ * 
+ * @param outClient the out-enclave client ptr
+ * @param freeMQ the ids of the free recv buffers
+ * @param readyMQ the ids of the received recv buffers (RECV_BUF_RING_SIZE: connection closed)
+ * @param replyMQ the ids of the recv buffers holding a reply to send back
+ */
+void DataReceiver::RecvThread(ClientVar* outClient, MessageQueue<uint32_t>* freeMQ,
+    MessageQueue<uint32_t>* readyMQ, MessageQueue<uint32_t>* replyMQ) {
+    uint32_t recvSize = 0;
+    uint32_t bufID;
+    SSL* clientSSL = outClient->_clientSSL;
+
+    while (true) {
+        // wait for a buffer released by the enclave thread
+        if (!freeMQ->PopWait(bufID)) {
+            continue;
+        }
+        if (!dataSecureChannel_->ReceiveData(clientSSL, 
+            outClient->_recvChunkBufRing[bufID].sendBuffer, recvSize)) {
+            bufID = RECV_BUF_RING_SIZE;
+            readyMQ->Push(bufID);
+            break;
+        }
+        if (outClient->_recvChunkBufRing[bufID].header->messageType != CLIENT_UPLOAD_FP) {
+            readyMQ->Push(bufID);
+            continue;
+        }
+        if (!outClient->_fpPrefilter) {
+            // the pre-filter is not accepted in the login, drop the batch without a reply
+            tool::Logging(myName_.c_str(), "drop the fingerprint batch of client %u, "
+                "the pre-filter is not accepted.\n", outClient->_clientID);
+            freeMQ->Push(bufID);
+            continue;
+        }
+
+        // the client waits for the bitmap of its fingerprint batch, send it from this
+        // thread, since the ssl connection cannot be read and written concurrently
+        readyMQ->Push(bufID);
+        while (!replyMQ->PopWait(bufID)) {
+            ;
+        }
+        SendMsgBuffer_t* replyBuf = &outClient->_recvChunkBufRing[bufID];
+        if (!dataSecureChannel_->SendData(clientSSL, replyBuf->sendBuffer,
+            sizeof(NetworkHead_t) + replyBuf->header->dataSize)) {
+            tool::Logging(myName_.c_str(), "send the fingerprint bitmap error.\n");
+            bufID = RECV_BUF_RING_SIZE;
+            readyMQ->Push(bufID);
+            break;
+        }
+        freeMQ->Push(bufID);
+    }
+    return ;
+}
+
 /**
  * @brief the main process to handle new client upload-request connection
  * 
@@ -45,10 +102,9 @@ DataReceiver::~DataReceiver() {
  * @param enclaveInfo the pointer to the enclave info
  */
 void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
-    uint32_t recvSize = 0;
     string clientIP;
     UpOutSGX_t* upOutSGX = &outClient->_upOutSGX;
-    SendMsgBuffer_t* recvChunkBuf = &outClient->_recvChunkBuf;
+    SendMsgBuffer_t* recvChunkBuf;
     Container_t* curContainer = &outClient->_curContainer;
     Container_t* curDeltaContainer = &outClient->_curDeltaContainer;
     SSL* clientSSL = outClient->_clientSSL;
@@ -62,16 +118,31 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
 
     double totalOnlineTime = 0;
 
+    // the recv thread fills the free buffers while this thread processes the received ones
+    MessageQueue<uint32_t> freeMQ(RECV_BUF_RING_SIZE);
+    MessageQueue<uint32_t> readyMQ(RECV_BUF_RING_SIZE + 1);
+    MessageQueue<uint32_t> replyMQ(RECV_BUF_RING_SIZE);
+    for (uint32_t i = 0; i < RECV_BUF_RING_SIZE; i++) {
+        freeMQ.Push(i);
+    }
+    boost::thread recvTh(boost::bind(&DataReceiver::RecvThread, this, outClient,
+        &freeMQ, &readyMQ, &replyMQ));
+    uint32_t bufID;
+
     tool::Logging(myName_.c_str(), "the main thread is running.\n");
     while (true) {
-        // receive data 
-        if (!dataSecureChannel_->ReceiveData(clientSSL, recvChunkBuf->sendBuffer, 
-            recvSize)) {
+        // wait for the next received buffer
+        if (!readyMQ.PopWait(bufID)) {
+            continue;
+        }
+        if (bufID == RECV_BUF_RING_SIZE) {
+            recvTh.join();
             tool::Logging(myName_.c_str(), "client closed socket connect, thread exit now.\n");
             dataSecureChannel_->GetClientIp(clientIP, clientSSL);
             dataSecureChannel_->ClearAcceptedClientSd(clientSSL);
             break;
         } else {
+            recvChunkBuf = &outClient->_recvChunkBufRing[bufID];
             gettimeofday(&sProcTime, NULL);
             
             switch (recvChunkBuf->header->messageType) {
@@ -84,6 +155,14 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
                     batchNum_++;
                     break;
                 }
+                case CLIENT_UPLOAD_FP: {
+                    // answer the fingerprints with the duplicate bitmap
+                    absIndexObj_->ProcessFpBatch(recvChunkBuf, upOutSGX);
+                    absIndexObj_->Ecall_time++;
+                    recvChunkBuf->header->messageType = SERVER_FP_BITMAP;
+                    fpBatchNum_++;
+                    break;
+                }
                 case CLIENT_UPLOAD_RECIPE_END: {
                     // this is the end of one upload 
                     absIndexObj_->ProcessTailBatch(upOutSGX);
@@ -91,6 +170,7 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
                     // finalize the file recipe
                     storageCoreObj_->FinalizeRecipe((FileRecipeHead_t*)recvChunkBuf->dataBuffer,
                         outClient->_recipeWriteHandler);
+                    outClient->_recipeFinalized = true;
                     recipeEndNum_++;
 
                     // update the upload data size
@@ -107,9 +187,20 @@ void DataReceiver::Run(ClientVar* outClient, EnclaveInfo_t* enclaveInfo) {
             gettimeofday(&eProcTime, NULL);
             
             totalProcessTime += tool::GetTimeDiff(sProcTime, eProcTime);
-            
+
+            // return the buffer to the recv thread
+            if (recvChunkBuf->header->messageType == SERVER_FP_BITMAP) {
+                // the recv thread sends the reply, then frees the buffer
+                replyMQ.Push(bufID);
+            } else {
+                freeMQ.Push(bufID);
+            }
         }
     }
+    // drain the free buffers before releasing the queue
+    while (freeMQ.Pop(bufID)) {
+        ;
+    }
 
     // process the last container 
     if (curContainer->currentSize != 0) {
@@ -18,11 +18,40 @@ struct timeval eTimeDataWrite;
 struct timeval sTotalTime;
 struct timeval eTotalTime;
 
+// the tag of the fsync ops in the io_uring user data (the write ops carry the slot id)
+static const uint64_t WRITER_SYNC_TAG = 1ULL << 32;
+
 DataWriter::DataWriter() {
     basecontainerNamePrefix_ = "Base-Containers/";
     deltacontainerNamePrefix_ = "Delta-Containers/";
     containerNameTail_ = config.GetContainerSuffix();
+
+    // the slots of the writes in flight
+    for (uint32_t i = 0; i < WRITER_QUEUE_DEPTH; i++) {
+        slotArr_[i].container = (Container_t*) malloc(sizeof(Container_t));
+#if (CONTAINER_PACK == 1)
+        slotArr_[i].writeBuffer = (uint8_t*) malloc(sizeof(PackRecordHead_t) + MAX_CONTAINER_SIZE);
+#elif (CONTAINER_O_DIRECT == 1)
+        slotArr_[i].writeBuffer = (uint8_t*) aligned_alloc(WRITER_DIRECT_ALIGN,
+            (MAX_CONTAINER_SIZE + WRITER_DIRECT_ALIGN - 1) / WRITER_DIRECT_ALIGN * WRITER_DIRECT_ALIGN);
+#else
+        slotArr_[i].writeBuffer = NULL;
+#endif
+        slotArr_[i].fd = -1;
+        slotArr_[i].fileOffset = 0;
+        freeSlotList_.push_back(i);
+    }
+
+#if (IO_URING_WRITER == 1)
+    int ret = io_uring_queue_init(WRITER_QUEUE_DEPTH + 2 * WRITER_FSYNC_BATCH, &ring_, 0);
+    if (ret < 0) {
+        tool::Logging(myName_.c_str(), "cannot init io_uring: %s\n", strerror(-ret));
+        exit(EXIT_FAILURE);
+    }
+    tool::Logging(myName_.c_str(), "init the DataWriter (io_uring).\n");
+#else
     tool::Logging(myName_.c_str(), "init the DataWriter.\n");
+#endif
 }
 
 /**
@@ -30,24 +59,44 @@ DataWriter::DataWriter() {
  * 
  */
 DataWriter::~DataWriter() {
+#if (IO_URING_WRITER == 1)
+    io_uring_queue_exit(&ring_);
+#endif
+    for (uint32_t i = 0; i < WRITER_QUEUE_DEPTH; i++) {
+        free(slotArr_[i].container);
+#if (CONTAINER_PACK == 1) || (CONTAINER_O_DIRECT == 1)
+        free(slotArr_[i].writeBuffer);
+#endif
+    }
     fprintf(stderr, "========DataWriter Info========\n");
 #if (DATAWRITER_BREAKDOWN == 1)
     fprintf(stderr, "write container time: %lf\n", writeTime_);
 #endif
     fprintf(stderr, "writer container num: %lu\n", containerNum_);
+    fprintf(stderr, "fsync batch num: %lu\n", syncBatchNum_);
     fprintf(stderr, "===============================\n");
 }
 
 /**
- * @brief the main process of data writer
+ * @brief Set the packfiles of the containers
+ * 
+ * @param containerPack the packfiles
+ */
+void DataWriter::SetContainerPack(ContainerPack* containerPack) {
+    containerPack_ = containerPack;
+    return ;
+}
+
+/**
+ * @brief the main process of data writer, the containers of this epoch (one backup)
+ * are durable before epochDone is called
  * 
  * @param inputMQ the input MQ
+ * @param epochDone the callback after the epoch is durable (can be NULL)
  */
-void DataWriter::Run(MessageQueue<Container_t>* inputMQ) {
+void DataWriter::Run(MessageQueue<Container_t>* inputMQ, std::function<void()> epochDone) {
     bool jobDoneFlag = false;
-
-    // store the container extract from the MQ
-    Container_t tmpContainer;
+    uint32_t slotID;
 
     tool::Logging(myName_.c_str(), "the main thread is running.\n");
     gettimeofday(&sTotalTime, NULL);
@@ -57,12 +106,19 @@ void DataWriter::Run(MessageQueue<Container_t>* inputMQ) {
             jobDoneFlag = true;
         }
 
-        if (inputMQ->Pop(tmpContainer)) {
-            // write this container to the disk.
+        while (freeSlotList_.empty()) {
+            // all slots are in flight
+            this->ReapCompletion(true);
+        }
+
+        // extract the container from the MQ to a free slot
+        slotID = freeSlotList_.back();
+        if (inputMQ->PopWait(*slotArr_[slotID].container)) {
+            freeSlotList_.pop_back();
 #if (DATAWRITER_BREAKDOWN == 1)
             gettimeofday(&sTimeDataWrite, NULL);
 #endif
-            SaveToFile(tmpContainer);
+            this->SubmitWrite(slotID);
 #if (DATAWRITER_BREAKDOWN == 1)
             gettimeofday(&eTimeDataWrite, NULL);
             writeTime_ += tool::GetTimeDiff(sTimeDataWrite, eTimeDataWrite);
@@ -70,12 +126,23 @@ void DataWriter::Run(MessageQueue<Container_t>* inputMQ) {
             containerNum_++;
         }
 
+        this->ReapCompletion(false);
+        if (syncPendingNum_ >= WRITER_FSYNC_BATCH) {
+            this->SubmitSync();
+        }
+
         if (jobDoneFlag) {
             break;
         }
         
     }
 
+    // the durability barrier of this epoch
+    this->FlushEpoch();
+    if (epochDone) {
+        epochDone();
+    }
+
     gettimeofday(&eTotalTime, NULL);
     totalTime_ += tool::GetTimeDiff(sTotalTime, eTotalTime);
 
@@ -83,12 +150,262 @@ void DataWriter::Run(MessageQueue<Container_t>* inputMQ) {
     return ;
 }
 
+/**
+ * @brief open the file of a container
+ * 
+ * @param newContainer the container
+ * @param flags the extra open flags
+ * @return int the fd
+ */
+int DataWriter::OpenContainerFile(Container_t& newContainer, int flags) {
+    string fileName((char*)newContainer.containerID, CONTAINER_ID_LENGTH);
+    string fileFullName;
+    if(newContainer.deltaFlag==false){
+        fileFullName = basecontainerNamePrefix_ + fileName + containerNameTail_;
+    }else{
+        fileFullName = deltacontainerNamePrefix_ + fileName + containerNameTail_;
+    }
+    int fd = open(fileFullName.c_str(), O_WRONLY | O_CREAT | O_TRUNC | flags, 0644);
+    if (fd < 0) {
+        tool::Logging(myName_.c_str(), "cannot open container file: %s\n", fileFullName.c_str());
+        exit(EXIT_FAILURE);
+    }
+    return fd;
+}
+
+/**
+ * @brief start the write of the container in a slot
+ * 
+ * @param slotID the slot id
+ */
+void DataWriter::SubmitWrite(uint32_t slotID) {
+    WriteSlot_t* slot = &slotArr_[slotID];
+    Container_t* newContainer = slot->container;
+#if (CONTAINER_PACK == 1)
+    // append the record to the active packfile, the dup-ed fd is closed after the batched fsync
+    containerPack_->Reserve((uint8_t*)newContainer->containerID,
+        (newContainer->deltaFlag == false) ? BASE_CONTAINER : DELTA_CONTAINER,
+        newContainer->body, newContainer->currentSize, slot->packWrite);
+    slot->fd = dup(slot->packWrite.fd);
+    if (slot->fd < 0) {
+        tool::Logging(myName_.c_str(), "cannot dup the packfile fd: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    slot->fileOffset = slot->packWrite.offset;
+    slot->writeSize = sizeof(PackRecordHead_t) + newContainer->currentSize;
+    memcpy(slot->writeBuffer, &slot->packWrite.head, sizeof(PackRecordHead_t));
+    memcpy(slot->writeBuffer + sizeof(PackRecordHead_t), newContainer->body,
+        newContainer->currentSize);
+#elif (CONTAINER_O_DIRECT == 1)
+    // O_DIRECT needs an aligned buffer and size, the padding is truncated after the write
+    slot->fd = this->OpenContainerFile(*newContainer, O_DIRECT);
+    slot->writeSize = (newContainer->currentSize + WRITER_DIRECT_ALIGN - 1) / 
+        WRITER_DIRECT_ALIGN * WRITER_DIRECT_ALIGN;
+    memcpy(slot->writeBuffer, newContainer->body, newContainer->currentSize);
+    memset(slot->writeBuffer + newContainer->currentSize, 0, 
+        slot->writeSize - newContainer->currentSize);
+#else
+    slot->fd = this->OpenContainerFile(*newContainer, 0);
+    slot->writeBuffer = newContainer->body;
+    slot->writeSize = newContainer->currentSize;
+#endif
+    slot->writtenSize = 0;
+    this->IssueWrite(slotID);
+    return ;
+}
+
+/**
+ * @brief issue the remaining part of the write of a slot
+ * 
+ * @param slotID the slot id
+ */
+void DataWriter::IssueWrite(uint32_t slotID) {
+    WriteSlot_t* slot = &slotArr_[slotID];
+#if (IO_URING_WRITER == 1)
+    struct io_uring_sqe* sqe;
+    while ((sqe = io_uring_get_sqe(&ring_)) == NULL) {
+        io_uring_submit(&ring_);
+    }
+    io_uring_prep_write(sqe, slot->fd, slot->writeBuffer + slot->writtenSize,
+        slot->writeSize - slot->writtenSize, slot->fileOffset + slot->writtenSize);
+    io_uring_sqe_set_data(sqe, (void*)(uintptr_t)slotID);
+    io_uring_submit(&ring_);
+    inflightNum_++;
+#else
+    ssize_t res = pwrite(slot->fd, slot->writeBuffer + slot->writtenSize,
+        slot->writeSize - slot->writtenSize, slot->fileOffset + slot->writtenSize);
+    this->CompleteWrite(slotID, (res < 0) ? -errno : (int)res);
+#endif
+    return ;
+}
+
+/**
+ * @brief handle a finished write round of a slot
+ * 
+ * @param slotID the slot id
+ * @param res the written size of this round, or -errno
+ */
+void DataWriter::CompleteWrite(uint32_t slotID, int res) {
+    WriteSlot_t* slot = &slotArr_[slotID];
+    if (res == -EINTR || res == -EAGAIN) {
+        this->IssueWrite(slotID);
+        return ;
+    }
+    if (res <= 0) {
+        tool::Logging(myName_.c_str(), "write container error: %s\n", 
+            (res < 0) ? strerror(-res) : "no space");
+        exit(EXIT_FAILURE);
+    }
+    slot->writtenSize += res;
+    if (slot->writtenSize < slot->writeSize) {
+        // short write
+        this->IssueWrite(slotID);
+        return ;
+    }
+#if (CONTAINER_PACK == 1)
+    containerPack_->Commit(slot->packWrite);
+    // one fsync per packfile in a batch
+    if (find(syncPackList_.begin(), syncPackList_.end(), slot->packWrite.packID) ==
+        syncPackList_.end()) {
+        syncFdList_.push_back(slot->fd);
+        syncPackList_.push_back(slot->packWrite.packID);
+    } else {
+        close(slot->fd);
+    }
+#else
+#if (CONTAINER_O_DIRECT == 1)
+    if (ftruncate(slot->fd, slot->container->currentSize) != 0) {
+        tool::Logging(myName_.c_str(), "cannot truncate the container file.\n");
+        exit(EXIT_FAILURE);
+    }
+#endif
+    // the file is synced in the next fsync batch
+    syncFdList_.push_back(slot->fd);
+#endif
+    syncPendingNum_++;
+    slot->fd = -1;
+    freeSlotList_.push_back(slotID);
+    return ;
+}
+
+/**
+ * @brief start the fsync of all written container files
+ * 
+ */
+void DataWriter::SubmitSync() {
+    if (syncFdList_.empty()) {
+        return ;
+    }
+#if (IO_URING_WRITER == 1)
+    // at most two batches in flight
+    while (syncInflightNum_ > WRITER_FSYNC_BATCH) {
+        this->ReapCompletion(true);
+    }
+    struct io_uring_sqe* sqe;
+    for (auto fd : syncFdList_) {
+        while ((sqe = io_uring_get_sqe(&ring_)) == NULL) {
+            io_uring_submit(&ring_);
+        }
+        io_uring_prep_fsync(sqe, fd, 0);
+        io_uring_sqe_set_data(sqe, (void*)(uintptr_t)(WRITER_SYNC_TAG | (uint32_t)fd));
+        inflightNum_++;
+        syncInflightNum_++;
+    }
+    io_uring_submit(&ring_);
+#else
+    for (auto fd : syncFdList_) {
+        if (fsync(fd) != 0) {
+            tool::Logging(myName_.c_str(), "fsync container error: %s\n", strerror(errno));
+            exit(EXIT_FAILURE);
+        }
+        close(fd);
+    }
+#endif
+    syncFdList_.clear();
+    syncPackList_.clear();
+    syncPendingNum_ = 0;
+    syncBatchNum_++;
+    return ;
+}
+
+/**
+ * @brief reap the finished writes and fsyncs
+ * 
+ * @param wait wait until at least one is finished
+ */
+void DataWriter::ReapCompletion(bool wait) {
+#if (IO_URING_WRITER == 1)
+    struct io_uring_cqe* cqe;
+    if (inflightNum_ == 0) {
+        return ;
+    }
+    if (wait) {
+        int ret = io_uring_wait_cqe(&ring_, &cqe);
+        if (ret < 0 && ret != -EINTR) {
+            tool::Logging(myName_.c_str(), "wait io_uring error: %s\n", strerror(-ret));
+            exit(EXIT_FAILURE);
+        }
+    }
+    while (io_uring_peek_cqe(&ring_, &cqe) == 0) {
+        uint64_t opData = (uint64_t)(uintptr_t)io_uring_cqe_get_data(cqe);
+        int res = cqe->res;
+        io_uring_cqe_seen(&ring_, cqe);
+        inflightNum_--;
+        if (opData & WRITER_SYNC_TAG) {
+            if (res < 0) {
+                tool::Logging(myName_.c_str(), "fsync container error: %s\n", strerror(-res));
+                exit(EXIT_FAILURE);
+            }
+            close((int)(opData & 0xffffffff));
+            syncInflightNum_--;
+        } else {
+            this->CompleteWrite((uint32_t)opData, res);
+        }
+    }
+#else
+    // each pwrite is completed when it is issued
+    (void)wait;
+#endif
+    return ;
+}
+
+/**
+ * @brief wait for all writes, fsync all written containers and the container dirs
+ * 
+ */
+void DataWriter::FlushEpoch() {
+    while (freeSlotList_.size() < WRITER_QUEUE_DEPTH) {
+        this->ReapCompletion(true);
+    }
+    this->SubmitSync();
+    while (inflightNum_ != 0) {
+        this->ReapCompletion(true);
+    }
+
+#if (CONTAINER_PACK == 0)
+    // persist the new file entries (a new packfile is persisted when it is created)
+    for (auto& dirName : {basecontainerNamePrefix_, deltacontainerNamePrefix_}) {
+        int dirFd = open(dirName.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    }
+#endif
+    return ;
+}
+
 /**
  * @brief write the container to the storage backend 
  * 
  * @param newContainer the input container 
  */
 void DataWriter::SaveToFile(Container_t& newContainer) {
+#if (CONTAINER_PACK == 1)
+    containerPack_->Append((uint8_t*)newContainer.containerID,
+        (newContainer.deltaFlag == false) ? BASE_CONTAINER : DELTA_CONTAINER,
+        newContainer.body, newContainer.currentSize);
+#else
     FILE* containerFile = NULL;
     string fileName((char*)newContainer.containerID, CONTAINER_ID_LENGTH);
     string fileFullName;
@@ -105,6 +422,7 @@ void DataWriter::SaveToFile(Container_t& newContainer) {
     fwrite((char*)newContainer.body, newContainer.currentSize, 1,
         containerFile);
     fclose(containerFile);
+#endif
     return ;
 }
 
@@ -115,67 +115,51 @@ void EnclaveRecvDecoder::GetReqContainers(ClientVar* outClient) {
     uint8_t* idBuffer = reqContainer->idBuffer; 
     uint8_t** containerArray = reqContainer->containerArray;
     ReadCache* containerCache = outClient->_containerCache;
+    ContainerStore* containerStore = outClient->_containerStore;
+    RestorePrefetcher* restorePrefetcher = outClient->_restorePrefetcher;
     uint32_t idNum = reqContainer->idNum; 
     string containerNameStr;
     //tool::Logging(myName_.c_str(), "idNum is %d\n", idNum);
 
+    // the enclave is done with the views and the pinned containers of the last batch
+    containerStore->Release(outClient->_reqViewList);
+    containerCache->Unpin(outClient->_reqPinList);
+
     // retrieve each container
+    uint32_t pinIndex;
     for (size_t i = 0; i < idNum; i++) {
         containerNameStr.assign((char*) (idBuffer + i * CONTAINER_ID_LENGTH), 
             CONTAINER_ID_LENGTH);
+        // advance the access sequence of the eviction hints and the read-ahead
+        restorePrefetcher->Consume(containerNameStr);
         
-        // step-1: check the container cache
-        bool cacheHitStatus = containerCache->ExistsInCache(containerNameStr);
-        if (cacheHitStatus) {
-            // step-2: exist in the container cache, read from the cache, directly copy the data from the cache
-            memcpy(containerArray[i], containerCache->ReadFromCache(containerNameStr), 
-                MAX_CONTAINER_SIZE);
+        // step-1: check the container cache (it may be prefetched)
+        containerArray[i] = containerCache->PinFromCache(containerNameStr, pinIndex);
+        if (containerArray[i] != NULL) {
+            // step-2: exist in the container cache, the enclave reads the pinned one
+            outClient->_reqPinList.push_back(pinIndex);
             counter++;
             
             continue ;
         } 
         //tool::Logging(myName_.c_str(), "didn't hit cache\n");
-        // step-3: not exist in the contain cache, read from disk
-        ifstream containerIn;
-        containerNamePrefix_ = "Base-Containers/";
-        string readFileNameStr = containerNamePrefix_ + containerNameStr + containerNameTail_;
-        containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-
-        if (!containerIn.is_open()) {
-            tool::Logging(myName_.c_str(), "cannot open the base container: %s, turn to check delta container\n", readFileNameStr.c_str());
+        // step-3: not exist in the contain cache, map it from the container store
+        ContainerView_t containerView;
+
+        if (!containerStore->OpenContainer(containerNameStr, BASE_CONTAINER, containerView)) {
+            tool::Logging(myName_.c_str(), "cannot open the base container: %s, turn to check delta container\n", containerNameStr.c_str());
             //tool::Logging(myName_.c_str(),"i is %d\n", i);
-            containerNamePrefix_ = "Delta-Containers/";
             //tool::Logging("getreqcontainer", "containernamestr is %s\n", containerNameStr.c_str());
-            readFileNameStr = containerNamePrefix_ + containerNameStr + containerNameTail_;
-            containerIn.open(readFileNameStr, ifstream::in | ifstream::binary);
-            if (!containerIn.is_open()) {
-                tool::Logging(myName_.c_str(), "cannot open the container 2: %s\n", readFileNameStr.c_str());
+            if (!containerStore->OpenContainer(containerNameStr, DELTA_CONTAINER, containerView)) {
+                tool::Logging(myName_.c_str(), "cannot open the container 2: %s\n", containerNameStr.c_str());
                 exit(EXIT_FAILURE);
             }
         }
-        //tool::Logging(myName_.c_str(), "start I/O\n");
-        // get the data section size (total chunk size - metadata section)
-        containerIn.seekg(0, ios_base::end);
-        int readSize = containerIn.tellg();
-        containerIn.seekg(0, ios_base::beg);
-
-        // read the metadata section
-        int containerSize = 0;
-        containerSize = readSize;
-        // read compression data
-        containerIn.read((char*)containerArray[i], containerSize);
-        //tool::Logging(myName_.c_str(), "end I/O\n");
-        if (containerIn.gcount() != containerSize) {
-            tool::Logging(myName_.c_str(), "read size %lu cannot match expected size: %d for container %s.\n",
-                containerIn.gcount(), containerSize, readFileNameStr.c_str());
-            exit(EXIT_FAILURE);
-        }
-        //counter++;
-        //tool::Logging(myName_.c_str(), "counter is %d\n", counter);
-        // close the container file
-        containerIn.close();
+        // the enclave reads the view directly
+        containerArray[i] = containerView.data;
+        outClient->_reqViewList.push_back(containerView);
         readFromContainerFileNum_++;
-        containerCache->InsertToCache(containerNameStr, containerArray[i], containerSize);
+        containerCache->InsertToCache(containerNameStr, containerView.data, containerView.size);
     }
     return ;
 }
@@ -44,12 +44,20 @@ ServerOptThread::ServerOptThread(SSLConnection* dataSecureChannel,
     recvDecoderObj_ = new EnclaveRecvDecoder(dataSecureChannel_, 
         eidSGX_);
 
+    // init the container store
+#if (CONTAINER_PACK == 1)
+    containerPackObj_ = new ContainerPack("Container-Packs/", CONTAINER_PACK_SIZE);
+    dataWriterObj_->SetContainerPack(containerPackObj_);
+#endif
+    containerStoreObj_ = new ContainerStore(CONTAINER_STORE_IDLE_NUM,
+        config.GetContainerSuffix(), containerPackObj_);
+
     // init the RA 
     raUtil_ = new RAUtil(dataSecureChannel_);
 
     // init the out-enclave var
     OutEnclave::Init(dataWriterObj_, fp2ChunkDB_, storageCoreObj_,
-        recvDecoderObj_);
+        recvDecoderObj_, containerStoreObj_);
 
     // for log file
     if (!tool::FileExist(logFileName_)) {
@@ -170,6 +178,10 @@ ServerOptThread::~ServerOptThread() {
     delete dataReceiverObj_;
     delete recvDecoderObj_;
     delete raUtil_;
+    delete containerStoreObj_;
+    if (containerPackObj_ != NULL) {
+        delete containerPackObj_;
+    }
 
     for (auto it : clientLockIndex_) {
         delete it.second;
@@ -200,7 +212,8 @@ void ServerOptThread::Run(SSL* clientSSL) {
     EnclaveInfo_t enclaveInfo;
 
     SendMsgBuffer_t recvBuf;
-    recvBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + SESSION_KEY_BUFFER_SIZE);
+    recvBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) +
+        max(SESSION_KEY_BUFFER_SIZE, UPLOAD_LOGIN_SIZE));
     recvBuf.header = (NetworkHead_t*) recvBuf.sendBuffer;
     recvBuf.header->dataSize = 0;
     recvBuf.dataBuffer = recvBuf.sendBuffer + sizeof(NetworkHead_t);
@@ -381,22 +394,48 @@ void ServerOptThread::Run(SSL* clientSSL) {
             tool::Logging(myName_.c_str(), "recv the upload request from client: %u\n",
                 clientID);
             outClient = new ClientVar(clientID, clientSSL, UPLOAD_OPT, recipePath);
+            outClient->_containerStore = containerStoreObj_;
             Ecall_Init_Client(eidSGX_, clientID, indexType_, UPLOAD_OPT, 
                 recvBuf.dataBuffer + CHUNK_HASH_SIZE, 
                 &outClient->_upOutSGX.sgxClient);
 
+            // accept the options requested after Enc(masterKey) before the receiver starts:
+            // the transport compression (the enclave decompresses each flagged chunk of a
+            // batch by itself), and the fingerprint pre-filter if the server allows it
+            uint32_t transCompress = TRANS_COMPRESS_NONE;
+            uint32_t fpPrefilter = 0;
+            if (recvBuf.header->dataSize >= 2 * CHUNK_HASH_SIZE + sizeof(uint32_t)) {
+                memcpy(&transCompress, recvBuf.dataBuffer + 2 * CHUNK_HASH_SIZE,
+                    sizeof(uint32_t));
+                if (transCompress != TRANS_COMPRESS_LZ4) {
+                    transCompress = TRANS_COMPRESS_NONE;
+                }
+            }
+            if (recvBuf.header->dataSize >= 2 * CHUNK_HASH_SIZE + 2 * sizeof(uint32_t)) {
+                memcpy(&fpPrefilter, recvBuf.dataBuffer + 2 * CHUNK_HASH_SIZE +
+                    sizeof(uint32_t), sizeof(uint32_t));
+                fpPrefilter = (fpPrefilter != 0 && config.GetAcceptFpPrefilter() != 0) ? 1 : 0;
+            }
+            outClient->_fpPrefilter = (fpPrefilter != 0);
+
             thTmp = new boost::thread(attrs, boost::bind(&DataReceiver::Run, dataReceiverObj_,
                 outClient, &enclaveInfo));
             thList.push_back(thTmp); 
 #if (MULTI_CLIENT == 0)
+            // the recipe is published after all containers of this backup are durable
             thTmp = new boost::thread(attrs, boost::bind(&DataWriter::Run, dataWriterObj_,
-                outClient->_inputMQ));
+                outClient->_inputMQ, [this, recipePath, outClient]() {
+                    storageCoreObj_->PublishRecipe(recipePath, outClient->_recipeFinalized);
+                }));
             thList.push_back(thTmp);
 #endif
-            // send the upload-response to the client
+            // send the upload-response to the client (include the accepted options)
             recvBuf.header->messageType = SERVER_LOGIN_RESPONSE;
+            recvBuf.header->dataSize = 2 * sizeof(uint32_t);
+            memcpy(recvBuf.dataBuffer, &transCompress, sizeof(uint32_t));
+            memcpy(recvBuf.dataBuffer + sizeof(uint32_t), &fpPrefilter, sizeof(uint32_t));
             if (!dataSecureChannel_->SendData(clientSSL, recvBuf.sendBuffer, 
-                sizeof(NetworkHead_t))) {
+                sizeof(NetworkHead_t) + recvBuf.header->dataSize)) {
                 tool::Logging(myName_.c_str(), "send the upload-login response error.\n");
                 exit(EXIT_FAILURE);
             }
@@ -408,6 +447,9 @@ void ServerOptThread::Run(SSL* clientSSL) {
             tool::Logging(myName_.c_str(), "recv the restore request from client: %u\n",
                 clientID);
             outClient = new ClientVar(clientID, clientSSL, DOWNLOAD_OPT, recipePath);
+            outClient->_containerStore = containerStoreObj_;
+            outClient->_restorePrefetcher = new RestorePrefetcher(containerStoreObj_,
+                outClient->_containerCache, config.GetReadCacheSize());
             Ecall_Init_Client(eidSGX_, clientID, indexType_, DOWNLOAD_OPT, 
                 recvBuf.dataBuffer + CHUNK_HASH_SIZE,
                 &outClient->_resOutSGX.sgxClient);
@@ -448,6 +490,13 @@ void ServerOptThread::Run(SSL* clientSSL) {
     }
     thList.clear();
 
+#if (MULTI_CLIENT == 1)
+    // the containers are written by the receiver itself
+    if (optType != DOWNLOAD_OPT) {
+        storageCoreObj_->PublishRecipe(recipePath, outClient->_recipeFinalized);
+    }
+#endif
+
     double offlineTime = 0;
     if(optType == OFFLINE_OPT){
         tool::Logging(myName_.c_str(), "Process Offline\n");
@@ -65,4 +65,45 @@ void StorageCore::UpdateRecipeToFile(const uint8_t* recipeBuffer, size_t recipeE
     size_t recipeBufferSize = recipeEntryNum * CHUNK_HASH_SIZE;
     fileRecipeHandler.write((char*)recipeBuffer, recipeBufferSize);
     return ;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief publish the uploaded recipe: persist <recipe>.tmp and rename it to the recipe,
+ * called after all its containers are durable
+ * 
+ * @param recipePath the recipe path
+ * @param finalized whether the recipe end is written (otherwise the upload is dropped)
+ */
+void StorageCore::PublishRecipe(const string& recipePath, bool finalized) {
+    string tmpRecipePath = recipePath + RECIPE_TMP_SUFFIX;
+    if (!finalized) {
+        // the client left before the recipe end, keep the previous recipe (if any)
+        tool::Logging(myName_.c_str(), "recipe is not finalized, drop: %s\n",
+            tmpRecipePath.c_str());
+        remove(tmpRecipePath.c_str());
+        return ;
+    }
+
+    int fd = open(tmpRecipePath.c_str(), O_RDONLY);
+    if (fd < 0) {
+        tool::Logging(myName_.c_str(), "cannot open recipe file: %s\n", tmpRecipePath.c_str());
+        exit(EXIT_FAILURE);
+    }
+    if (fsync(fd) != 0) {
+        tool::Logging(myName_.c_str(), "fsync recipe error: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    close(fd);
+    if (rename(tmpRecipePath.c_str(), recipePath.c_str()) != 0) {
+        tool::Logging(myName_.c_str(), "cannot publish recipe file: %s\n", recipePath.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    // persist the new entry of the recipe dir
+    int dirFd = open(recipeNamePrefix_.c_str(), O_RDONLY | O_DIRECTORY);
+    if (dirFd >= 0) {
+        fsync(dirFd);
+        close(dirFd);
+    }
+    return ;
+}
@@ -0,0 +1,73 @@
+/**
+ * @file chunkPool.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the interface of the chunk pool
+ * @version 0.1
+ * @date 2024-03-12
+ * 
+ * @copyright Copyright (c) 2021
+ * 
+ */
+
+#include "../../include/chunkPool.h"
+
+/**
+ * @brief Construct a new Chunk Pool object
+ * 
+ * @param chunkNum the number of chunk buffers
+ */
+ChunkPool::ChunkPool(uint32_t chunkNum) {
+    chunkNum_ = chunkNum;
+    poolBuffer_ = (uint8_t*) malloc((size_t)chunkNum_ * MAX_CHUNK_SIZE);
+    if (poolBuffer_ == NULL) {
+        tool::Logging(myName_.c_str(), "cannot allocate %u chunk buffers.\n", chunkNum_);
+        exit(EXIT_FAILURE);
+    }
+    freeMQ_ = new MessageQueue<uint8_t*>(chunkNum_);
+    uint8_t* chunkBuffer;
+    for (size_t i = 0; i < chunkNum_; i++) {
+        chunkBuffer = poolBuffer_ + i * MAX_CHUNK_SIZE;
+        freeMQ_->Push(chunkBuffer);
+    }
+}
+
+/**
+ * @brief Destroy the Chunk Pool object
+ * 
+ */
+ChunkPool::~ChunkPool() {
+    uint8_t* chunkBuffer;
+    while (freeMQ_->Pop(chunkBuffer)) {
+        ;
+    }
+    delete freeMQ_;
+    free(poolBuffer_);
+}
+
+/**
+ * @brief acquire a free chunk buffer, wait until one is released
+ * 
+ * @return uint8_t* the chunk buffer (MAX_CHUNK_SIZE)
+ */
+uint8_t* ChunkPool::Acquire() {
+    uint8_t* chunkBuffer;
+    while (!freeMQ_->PopWait(chunkBuffer)) {
+        ;
+    }
+    return chunkBuffer;
+}
+
+/**
+ * @brief release a chunk buffer to the pool, a chunk not in the pool (e.g., in the mapped
+ * input file) is skipped
+ * 
+ * @param chunkBuffer the chunk buffer
+ */
+void ChunkPool::Release(uint8_t* chunkBuffer) {
+    if (chunkBuffer < poolBuffer_ || 
+        chunkBuffer >= poolBuffer_ + (size_t)chunkNum_ * MAX_CHUNK_SIZE) {
+        return ;
+    }
+    freeMQ_->Push(chunkBuffer);
+    return ;
+}
@@ -55,6 +55,11 @@ ClientVar::ClientVar(uint32_t clientID, SSL* clientSSL,
  * 
  */
 ClientVar::~ClientVar() {
+    if (_containerStore != NULL) {
+        _containerStore->Release(_baseViewList);
+        _containerStore->Release(_refViewList);
+        _containerStore->Release(_reqViewList);
+    }
     switch (optType_) {
         case UPLOAD_OPT: {
             this->DestroyUploadBuffer();
@@ -92,13 +97,23 @@ void ClientVar::InitUploadBuffer() {
     _test_buffer = (uint8_t*)malloc(8000*CHUNK_HASH_SIZE);
     _deltaInfo.QueryNum = 0;
 
-    // init the recv buffer
-    _recvChunkBuf.sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + 
-        sendChunkBatchSize_ * sizeof(Chunk_t));
-    _recvChunkBuf.header = (NetworkHead_t*) _recvChunkBuf.sendBuffer;
-    _recvChunkBuf.header->clientID = _clientID;
-    _recvChunkBuf.header->dataSize = 0;
-    _recvChunkBuf.dataBuffer = _recvChunkBuf.sendBuffer + sizeof(NetworkHead_t);
+    // init the batch fetch, the containers are views of the container store
+    _baseFetch.idBuffer = (uint8_t*) malloc(BASE_FETCH_NUM * CONTAINER_ID_LENGTH);
+    _baseFetch.containerArray = (uint8_t**) malloc(BASE_FETCH_NUM * sizeof(uint8_t*));
+    _baseFetch.sizeArray = (uint32_t*) malloc(BASE_FETCH_NUM * sizeof(uint32_t));
+    _baseFetch.idNum = 0;
+
+    // init the recv buffers
+    for (size_t i = 0; i < RECV_BUF_RING_SIZE; i++) {
+        SendMsgBuffer_t* recvBuf = &_recvChunkBufRing[i];
+        recvBuf->sendBuffer = (uint8_t*) malloc(sizeof(NetworkHead_t) + 
+            sendChunkBatchSize_ * sizeof(Chunk_t));
+        recvBuf->header = (NetworkHead_t*) recvBuf->sendBuffer;
+        recvBuf->header->clientID = _clientID;
+        recvBuf->header->dataSize = 0;
+        recvBuf->dataBuffer = recvBuf->sendBuffer + sizeof(NetworkHead_t);
+    }
+    _recvChunkBuf = _recvChunkBufRing[0];
 
     // prepare the input MQ
 #if (MULTI_CLIENT == 1)
@@ -124,17 +139,19 @@ void ClientVar::InitUploadBuffer() {
     _upOutSGX.deltaInfo = &_deltaInfo;
 
     _upOutSGX.outcallcontainer = _outCallcontainer;
+    _upOutSGX.baseFetch = &_baseFetch;
 
     // for offline
     // _mergeContainerBuffer = (uint8_t*)malloc(MAX_CONTAINER_SIZE);
     // _upOutSGX.mergeContainerBuffer = _mergeContainerBuffer;
     _upOutSGX.mergeContainer = &_mergeContianer;
     
-    // init the file recipe
-    _recipeWriteHandler.open(recipePath_, ios_base::trunc | ios_base::binary);
+    // init the file recipe (published by StorageCore::PublishRecipe)
+    string tmpRecipePath = recipePath_ + RECIPE_TMP_SUFFIX;
+    _recipeWriteHandler.open(tmpRecipePath, ios_base::trunc | ios_base::binary);
     if (!_recipeWriteHandler.is_open()) {
         tool::Logging(myName_.c_str(), "cannot init recipe file: %s\n",
-            recipePath_.c_str());
+            tmpRecipePath.c_str());
         exit(EXIT_FAILURE);
     }
     FileRecipeHead_t virtualRecipeEnd;
@@ -153,10 +170,15 @@ void ClientVar::DestroyUploadBuffer() {
     }
     free(_outRecipe.entryFpList);
     free(_outQuery.outQueryBase);
-    free(_recvChunkBuf.sendBuffer);
+    for (size_t i = 0; i < RECV_BUF_RING_SIZE; i++) {
+        free(_recvChunkBufRing[i].sendBuffer);
+    }
     free(_process_buffer);
     free(_out_buffer);
     free(_test_buffer);
+    free(_baseFetch.containerArray);
+    free(_baseFetch.sizeArray);
+    free(_baseFetch.idBuffer);
     // free(_mergeContainerBuffer);
     delete _inputMQ;
     return ;
@@ -175,15 +197,15 @@ void ClientVar::InitRestoreBuffer() {
     _reqContainer.containerArray = (uint8_t**) malloc(CONTAINERARRAY_VALUE * 
         sizeof(uint8_t*));
     _reqContainer.idNum = 0;
+    // the array points to the pinned cache entries or the container views
     for (size_t i = 0; i < CONTAINERARRAY_VALUE; i++) {
-        _reqContainer.containerArray[i] = (uint8_t*) malloc(sizeof(uint8_t) * 
-            MAX_CONTAINER_SIZE);
+        _reqContainer.containerArray[i] = NULL;
     }
 
 
-    //wrl-2020.12.21
+    // the base chunks of a recipe batch are resolved in one query
     _baseoutQuery.outQueryBase = (OutQueryEntry_t*) malloc(sizeof(OutQueryEntry_t) * 
-        5);
+        sendRecipeBatchSize_);
     _baseoutQuery.queryNum = 0;
 
     //wj: init one container buffer 
@@ -237,10 +259,6 @@ void ClientVar::DestroyRestoreBuffer() {
     tool::Logging(myName_.c_str(), "free(_readRecipeBuf); over.\n");
     free(_reqContainer.idBuffer);
     tool::Logging(myName_.c_str(), "free(_reqContainer.idBuffer); over.\n");
-    for (size_t i = 0; i < CONTAINER_CAPPING_VALUE; i++) {
-        free(_reqContainer.containerArray[i]);
-    }
-    tool::Logging(myName_.c_str(), "free(_reqContainer.containerArray[i]); over.\n");
     free(_reqContainer.containerArray);
     tool::Logging(myName_.c_str(), "free(_reqContainer.containerArray); over.\n");
     free(_baseoutQuery.outQueryBase);
@@ -251,6 +269,8 @@ void ClientVar::DestroyRestoreBuffer() {
     free(_reqOneContainer.container);
     tool::Logging(myName_.c_str(), "free(_reqOneContainer.container); over.\n");
     //free(_tmpBatchQueryBufferStr);
+    // stop the read-ahead before the cache is released
+    delete _restorePrefetcher;
     delete _containerCache;
     tool::Logging(myName_.c_str(), "delete _containerCache; over.\n");
     return ;
@@ -43,15 +43,22 @@ void Configure::ReadConf(std::string path) {
     avgChunkSize_ = root.get<uint64_t>("ChunkerConfig.avgChunkSize_");
     slidingWinSize_ = root.get<uint64_t>("ChunkerConfig.slidingWinSize_");
     readSize_ = root.get<uint64_t>("ChunkerConfig.readSize_");
+    chunkingThreadNum_ = root.get<uint64_t>("ChunkerConfig.chunkingThreadNum_", CHUNKING_THREAD_NUM);
+    chunkingSegmentSize_ = root.get<uint64_t>("ChunkerConfig.chunkingSegmentSize_", CHUNKING_SEGMENT_SIZE);
 
     // StorageCore configure
     recipeRootPath_ = root.get<std::string>("StorageCore.recipeRootPath_");
     containerRootPath_ = root.get<std::string>("StorageCore.containerRootPath_");
     fp2ChunkDBName_ = root.get<std::string>("StorageCore.fp2ChunkDBName_");
     topKParam_ = root.get<uint64_t>("StorageCore.topKParam_");
+    sfThreadNum_ = root.get<uint64_t>("StorageCore.sfThreadNum_", SF_THREAD_NUM);
+    acceptFpPrefilter_ = root.get<uint64_t>("StorageCore.acceptFpPrefilter_", ACCEPT_FP_PREFILTER);
 
     // restore writer
     readCacheSize_ = root.get<uint64_t>("RestoreWriter.readCacheSize_");
+    baseCacheSize_ = root.get<uint64_t>("RestoreWriter.baseCacheSize_", RESTORE_BASE_CACHE_SIZE);
+    faaSize_ = root.get<uint64_t>("RestoreWriter.faaSize_", RESTORE_FAA_SIZE);
+    decodeThreadNum_ = root.get<uint64_t>("RestoreWriter.decodeThreadNum_", RESTORE_DECODE_THREAD_NUM);
 
     // for storage server 
     storageServerIp_ = root.get<std::string>("DataSender.storageServerIp_");
@@ -61,6 +68,8 @@ void Configure::ReadConf(std::string path) {
     clientID_ = root.get<uint32_t>("DataSender.clientID_");
     sendChunkBatchSize_ = root.get<uint64_t>("DataSender.sendChunkBatchSize_");
     sendRecipeBatchSize_ = root.get<uint64_t>("DataSender.sendRecipeBatchSize_");
+    fpPrefilter_ = root.get<uint64_t>("DataSender.fpPrefilter_", FP_PREFILTER);
+    transCompress_ = root.get<uint64_t>("DataSender.transCompress_", TRANS_COMPRESS);
     spid_ = root.get<std::string>("DataSender.spid_");
     quoteType_ = root.get<uint16_t>("DataSender.quoteType_");
     iasServerType_ = root.get<uint32_t>("DataSender.iasServerType_");
@@ -0,0 +1,462 @@
+/**
+ * @file containerPack.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the append-only container packfiles
+ * @version 0.1
+ * @date 2024-03-22
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/containerPack.h"
+
+/**
+ * @brief Construct a new Container Pack object, load all packfiles in the dir
+ *
+ * @param packDir the dir of the packfiles
+ * @param packSize the max size of a packfile
+ */
+ContainerPack::ContainerPack(const string& packDir, uint64_t packSize) {
+    packDir_ = packDir;
+    packSize_ = packSize;
+    mkdir(packDir_.c_str(), 0755);
+
+    // the packfiles are loaded in the order of their IDs, a later record replaces an earlier one
+    vector<uint32_t> packIDList;
+    DIR* dir = opendir(packDir_.c_str());
+    if (dir == NULL) {
+        tool::Logging(myName_.c_str(), "cannot open the pack dir: %s\n", packDir_.c_str());
+        exit(EXIT_FAILURE);
+    }
+    struct dirent* dirEntry;
+    uint32_t packID;
+    char tail;
+    while ((dirEntry = readdir(dir)) != NULL) {
+        if (sscanf(dirEntry->d_name, "pack-%u.pac%c", &packID, &tail) == 2 && tail == 'k') {
+            packIDList.push_back(packID);
+        }
+    }
+    closedir(dir);
+    sort(packIDList.begin(), packIDList.end());
+
+    for (size_t i = 0; i < packIDList.size(); i++) {
+        Pack_t* pack = this->OpenPack(packIDList[i], false);
+        if (!this->LoadPack(pack) && i != packIDList.size() - 1) {
+            // an older packfile is not sealed (e.g., crash during the rotation)
+            this->SealPack(pack);
+        }
+        activePack_ = pack;
+    }
+    if (activePack_ == NULL || activePack_->full) {
+        activePack_ = this->OpenPack(packIDList.empty() ? 0 : packIDList.back() + 1, true);
+    }
+
+    tool::Logging(myName_.c_str(), "init the ContainerPack, load %lu packfiles, %lu index entries.\n",
+        packIDList.size(), locationMap_.size());
+}
+
+/**
+ * @brief Destroy the Container Pack object
+ *
+ */
+ContainerPack::~ContainerPack() {
+    for (auto pack : packList_) {
+        if (pack == NULL) {
+            continue;
+        }
+        if (pack->fd >= 0) {
+            // the active packfile is recovered by scanning its records
+            fsync(pack->fd);
+            close(pack->fd);
+        }
+        munmap(pack->addr, pack->mapSize);
+        delete pack;
+    }
+    fprintf(stderr, "========ContainerPack Info========\n");
+    fprintf(stderr, "load index entry num: %lu\n", loadEntryNum_);
+    fprintf(stderr, "recover record num: %lu\n", recoverEntryNum_);
+    fprintf(stderr, "torn record num: %lu\n", tornRecordNum_);
+    fprintf(stderr, "append record num: %lu\n", appendNum_);
+    fprintf(stderr, "seal packfile num: %lu\n", sealNum_);
+    fprintf(stderr, "==================================\n");
+}
+
+/**
+ * @brief get the file name of a packfile
+ *
+ * @param packID the pack ID
+ * @return string the file name
+ */
+string ContainerPack::PackFileName(uint32_t packID) {
+    char fileName[32];
+    snprintf(fileName, sizeof(fileName), "pack-%08u.pack", packID);
+    return packDir_ + fileName;
+}
+
+/**
+ * @brief open and map a packfile
+ *
+ * @param packID the pack ID
+ * @param createFlag create a new packfile
+ * @return Pack_t* the packfile
+ */
+ContainerPack::Pack_t* ContainerPack::OpenPack(uint32_t packID, bool createFlag) {
+    string fileName = this->PackFileName(packID);
+    int fd = open(fileName.c_str(), O_RDWR | (createFlag ? (O_CREAT | O_EXCL) : 0), 0644);
+    if (fd < 0) {
+        tool::Logging(myName_.c_str(), "cannot open the packfile: %s\n", fileName.c_str());
+        exit(EXIT_FAILURE);
+    }
+    struct stat fileStat;
+    fstat(fd, &fileStat);
+
+    // map the whole reserved range once, the records are appended under the mapping
+    size_t mapSize = max((uint64_t)fileStat.st_size, packSize_);
+    void* addr = mmap(NULL, mapSize, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        tool::Logging(myName_.c_str(), "cannot map the packfile: %s\n", fileName.c_str());
+        exit(EXIT_FAILURE);
+    }
+
+    if (createFlag) {
+        // persist the new file entry
+        int dirFd = open(packDir_.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dirFd >= 0) {
+            fsync(dirFd);
+            close(dirFd);
+        }
+    }
+
+    Pack_t* pack = new Pack_t();
+    pack->packID = packID;
+    pack->fd = fd;
+    pack->addr = (uint8_t*)addr;
+    pack->mapSize = mapSize;
+    pack->writeEnd = 0;
+    pack->pendingNum = 0;
+    pack->full = false;
+    if (packList_.size() <= packID) {
+        packList_.resize(packID + 1, NULL);
+    }
+    packList_[packID] = pack;
+    return pack;
+}
+
+/**
+ * @brief load the index of a packfile from its footer, or scan its records if it is not sealed
+ *
+ * @param pack the packfile
+ * @return true the packfile is sealed
+ * @return false the packfile is not sealed
+ */
+bool ContainerPack::LoadPack(Pack_t* pack) {
+    struct stat fileStat;
+    fstat(pack->fd, &fileStat);
+    uint64_t fileSize = fileStat.st_size;
+
+    // step-1: a sealed packfile ends with the index footer
+    PackFooter_t footer;
+    if (fileSize >= sizeof(PackFooter_t) &&
+        pread(pack->fd, &footer, sizeof(PackFooter_t), fileSize - sizeof(PackFooter_t)) ==
+        sizeof(PackFooter_t) && footer.magic == PACK_FOOTER_MAGIC &&
+        footer.indexOffset + (uint64_t)footer.entryNum * sizeof(PackIndexEntry_t) +
+        sizeof(PackFooter_t) == fileSize) {
+        vector<PackIndexEntry_t> entryList(footer.entryNum);
+        size_t indexSize = footer.entryNum * sizeof(PackIndexEntry_t);
+        if (pread(pack->fd, entryList.data(), indexSize, footer.indexOffset) == (ssize_t)indexSize) {
+            for (auto& entry : entryList) {
+                this->ApplyEntry(pack, entry);
+            }
+            // a sealed packfile is not appended anymore
+            pack->entryList.clear();
+            pack->entryList.shrink_to_fit();
+            loadEntryNum_ += footer.entryNum;
+            pack->writeEnd = footer.indexOffset;
+            pack->full = true;
+            close(pack->fd);
+            pack->fd = -1;
+            return true;
+        }
+    }
+
+    // step-2: scan the records of the active packfile, the records are written out of order
+    // and the page cache is written back out of order, so a torn (or zeroed) record can be
+    // followed by complete ones: skip it to the next aligned record
+    uint64_t offset = 0;
+    uint64_t validEnd = 0;
+    PackIndexEntry_t entry;
+    while (offset + sizeof(PackRecordHead_t) <= fileSize) {
+        PackRecordHead_t* head = (PackRecordHead_t*)(pack->addr + offset);
+        if (head->magic != PACK_RECORD_MAGIC || head->type > PACK_RECORD_DELETE + DELTA_CONTAINER ||
+            head->size > MAX_CONTAINER_SIZE ||
+            offset + sizeof(PackRecordHead_t) + head->size > fileSize ||
+            this->RecordChecksum(*head, pack->addr + offset + sizeof(PackRecordHead_t)) !=
+            head->checksum) {
+            if (head->magic == PACK_RECORD_MAGIC) {
+                tornRecordNum_++;
+            }
+            offset += CONTAINER_PACK_ALIGN;
+            continue;
+        }
+        memcpy(entry.containerID, head->containerID, CONTAINER_ID_LENGTH);
+        entry.type = head->type;
+        entry.size = head->size;
+        entry.offset = offset;
+        this->ApplyEntry(pack, entry);
+        recoverEntryNum_++;
+        offset += this->RecordSize(head->size);
+        validEnd = offset;
+    }
+    if (fileSize > validEnd) {
+        // drop the tail after the last complete record, the backup it belongs to is not durable
+        if (ftruncate(pack->fd, validEnd) != 0) {
+            tool::Logging(myName_.c_str(), "cannot truncate the packfile: %u\n", pack->packID);
+            exit(EXIT_FAILURE);
+        }
+    }
+    pack->writeEnd = validEnd;
+    return false;
+}
+
+/**
+ * @brief compute the checksum of a record
+ *
+ * @param head the record head (the checksum field is not covered)
+ * @param body the container body
+ * @return uint32_t the checksum
+ */
+uint32_t ContainerPack::RecordChecksum(const PackRecordHead_t& head, const uint8_t* body) {
+    PackRecordHead_t tmpHead = head;
+    tmpHead.checksum = 0;
+    boost::crc_32_type crc;
+    crc.process_bytes(&tmpHead, sizeof(PackRecordHead_t));
+    crc.process_bytes(body, head.size);
+    return crc.checksum();
+}
+
+/**
+ * @brief apply an index entry to the location map
+ *
+ * @param pack the packfile
+ * @param entry the index entry
+ */
+void ContainerPack::ApplyEntry(Pack_t* pack, PackIndexEntry_t& entry) {
+    pack->entryList.push_back(entry);
+
+    PackLocation_t location;
+    location.packID = pack->packID;
+    location.offset = entry.offset + sizeof(PackRecordHead_t);
+    location.size = entry.size;
+    location.deleted = (entry.type >= PACK_RECORD_DELETE);
+    uint8_t type = location.deleted ? entry.type - PACK_RECORD_DELETE : entry.type;
+
+    // the records are committed out of order, keep the one appended later (the deleted ones as well)
+    string key = this->LocationKey(entry.containerID, type);
+    auto findResult = locationMap_.find(key);
+    if (findResult == locationMap_.end()) {
+        locationMap_[key] = location;
+        return ;
+    }
+    PackLocation_t& oldLocation = findResult->second;
+    if (oldLocation.packID < location.packID || (oldLocation.packID == location.packID &&
+        oldLocation.offset < location.offset)) {
+        oldLocation = location;
+    }
+    return ;
+}
+
+/**
+ * @brief write the index footer of a packfile and close its fd
+ *
+ * @param pack the packfile
+ */
+void ContainerPack::SealPack(Pack_t* pack) {
+    // the records must be durable before the footer, a sealed packfile is never scanned
+    if (fsync(pack->fd) != 0) {
+        tool::Logging(myName_.c_str(), "fsync packfile error: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    PackFooter_t footer;
+    footer.indexOffset = pack->writeEnd;
+    footer.entryNum = pack->entryList.size();
+    footer.magic = PACK_FOOTER_MAGIC;
+    this->WriteAll(pack->fd, (uint8_t*)pack->entryList.data(),
+        pack->entryList.size() * sizeof(PackIndexEntry_t), footer.indexOffset);
+    this->WriteAll(pack->fd, (uint8_t*)&footer, sizeof(PackFooter_t),
+        footer.indexOffset + pack->entryList.size() * sizeof(PackIndexEntry_t));
+    if (fsync(pack->fd) != 0) {
+        tool::Logging(myName_.c_str(), "fsync packfile error: %s\n", strerror(errno));
+        exit(EXIT_FAILURE);
+    }
+    close(pack->fd);
+    pack->fd = -1;
+    pack->full = true;
+    // the footer is only read at startup
+    pack->entryList.clear();
+    pack->entryList.shrink_to_fit();
+    sealNum_++;
+    return ;
+}
+
+/**
+ * @brief write a buffer to a file at an offset
+ *
+ * @param fd the fd
+ * @param buffer the buffer
+ * @param size the buffer size
+ * @param offset the file offset
+ */
+void ContainerPack::WriteAll(int fd, const uint8_t* buffer, size_t size, uint64_t offset) {
+    size_t writtenSize = 0;
+    while (writtenSize < size) {
+        ssize_t ret = pwrite(fd, buffer + writtenSize, size - writtenSize, offset + writtenSize);
+        if (ret <= 0) {
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            tool::Logging(myName_.c_str(), "write packfile error: %s\n",
+                (ret < 0) ? strerror(errno) : "no space");
+            exit(EXIT_FAILURE);
+        }
+        writtenSize += ret;
+    }
+    return ;
+}
+
+/**
+ * @brief reserve a record in the active packfile
+ *
+ * @param containerID the container ID
+ * @param type the record type
+ * @param body the container body (for the checksum of the record head)
+ * @param size the container size
+ * @param packWrite the reserved record <return>
+ */
+void ContainerPack::Reserve(const uint8_t* containerID, uint8_t type, const uint8_t* body,
+    uint32_t size, PackWrite_t& packWrite) {
+    uint64_t recordSize = this->RecordSize(size);
+    packWrite.head.magic = PACK_RECORD_MAGIC;
+    memcpy(packWrite.head.containerID, containerID, CONTAINER_ID_LENGTH);
+    packWrite.head.type = type;
+    packWrite.head.size = size;
+    // outside the lock, the body is hashed once
+    packWrite.head.checksum = this->RecordChecksum(packWrite.head, body);
+
+    boost::unique_lock<boost::shared_mutex> lock(packLck_);
+    if (activePack_->writeEnd != 0 && activePack_->writeEnd + recordSize > packSize_) {
+        // rotate, the old packfile is sealed after its last pending record is committed
+        Pack_t* oldPack = activePack_;
+        oldPack->full = true;
+        activePack_ = this->OpenPack(oldPack->packID + 1, true);
+        if (oldPack->pendingNum == 0) {
+            this->SealPack(oldPack);
+        }
+    }
+
+    packWrite.packID = activePack_->packID;
+    packWrite.fd = activePack_->fd;
+    packWrite.offset = activePack_->writeEnd;
+    activePack_->writeEnd += recordSize;
+    activePack_->pendingNum++;
+    appendNum_++;
+    return ;
+}
+
+/**
+ * @brief make a written record visible
+ *
+ * @param packWrite the reserved record
+ */
+void ContainerPack::Commit(PackWrite_t& packWrite) {
+    PackIndexEntry_t entry;
+    memcpy(entry.containerID, packWrite.head.containerID, CONTAINER_ID_LENGTH);
+    entry.type = packWrite.head.type;
+    entry.size = packWrite.head.size;
+    entry.offset = packWrite.offset;
+
+    boost::unique_lock<boost::shared_mutex> lock(packLck_);
+    Pack_t* pack = packList_[packWrite.packID];
+    this->ApplyEntry(pack, entry);
+    pack->pendingNum--;
+    if (pack->full && pack->pendingNum == 0) {
+        this->SealPack(pack);
+    }
+    return ;
+}
+
+/**
+ * @brief append a container (replace the older one with the same ID)
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @param body the container body
+ * @param size the container size
+ */
+void ContainerPack::Append(const uint8_t* containerID, uint8_t type, const uint8_t* body,
+    uint32_t size) {
+    PackWrite_t packWrite;
+    this->Reserve(containerID, type, body, size, packWrite);
+    this->WriteAll(packWrite.fd, (uint8_t*)&packWrite.head, sizeof(PackRecordHead_t),
+        packWrite.offset);
+    this->WriteAll(packWrite.fd, body, size, packWrite.offset + sizeof(PackRecordHead_t));
+    this->Commit(packWrite);
+    return ;
+}
+
+/**
+ * @brief delete a container
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ */
+void ContainerPack::Delete(const uint8_t* containerID, uint8_t type) {
+    PackWrite_t packWrite;
+    this->Reserve(containerID, PACK_RECORD_DELETE + type, NULL, 0, packWrite);
+    this->WriteAll(packWrite.fd, (uint8_t*)&packWrite.head, sizeof(PackRecordHead_t),
+        packWrite.offset);
+    this->Commit(packWrite);
+    return ;
+}
+
+/**
+ * @brief find a container
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @param data the mapped container body <return>
+ * @param size the container size <return>
+ * @return true success
+ * @return false the container does not exist
+ */
+bool ContainerPack::Lookup(const uint8_t* containerID, uint8_t type, uint8_t*& data,
+    uint32_t& size) {
+    string key = this->LocationKey(containerID, type);
+    boost::shared_lock<boost::shared_mutex> lock(packLck_);
+    auto findResult = locationMap_.find(key);
+    if (findResult == locationMap_.end() || findResult->second.deleted) {
+        return false;
+    }
+    data = packList_[findResult->second.packID]->addr + findResult->second.offset;
+    size = findResult->second.size;
+    return true;
+}
+
+/**
+ * @brief list the containers of a type
+ *
+ * @param type the container type
+ * @param containerList the (container ID, size) list <return>
+ */
+void ContainerPack::List(uint8_t type, vector<pair<string, uint32_t>>& containerList) {
+    boost::shared_lock<boost::shared_mutex> lock(packLck_);
+    for (auto& it : locationMap_) {
+        if ((uint8_t)it.first[CONTAINER_ID_LENGTH] != type || it.second.deleted) {
+            continue;
+        }
+        containerList.push_back(make_pair(it.first.substr(0, CONTAINER_ID_LENGTH),
+            it.second.size));
+    }
+    sort(containerList.begin(), containerList.end());
+    return ;
+}
@@ -0,0 +1,437 @@
+/**
+ * @file containerStore.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the interface of the container store
+ * @version 0.1
+ * @date 2024-03-20
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/containerStore.h"
+
+/**
+ * @brief Construct a new Container Store object
+ *
+ * @param maxIdleNum the max number of unreferenced mappings kept
+ * @param containerSuffix the suffix of the container files
+ * @param containerPack the packfiles holding the containers (NULL: one file per container)
+ */
+ContainerStore::ContainerStore(size_t maxIdleNum, const string& containerSuffix,
+    ContainerPack* containerPack) {
+    maxIdleNum_ = maxIdleNum;
+    containerSuffix_ = containerSuffix;
+    containerPack_ = containerPack;
+    pageSize_ = sysconf(_SC_PAGESIZE);
+    tool::Logging(myName_.c_str(), "init the ContainerStore.\n");
+}
+
+/**
+ * @brief Destroy the Container Store object
+ *
+ */
+ContainerStore::~ContainerStore() {
+    for (auto it : mappingMap_) {
+        if (it.second->refCnt != 0) {
+            tool::Logging(myName_.c_str(), "%s still has %u views.\n",
+                it.first.c_str(), it.second->refCnt);
+        }
+        this->Unmap(it.second);
+    }
+    fprintf(stderr, "========ContainerStore Info========\n");
+    fprintf(stderr, "open view num: %lu\n", openNum_);
+    fprintf(stderr, "map file num: %lu\n", mapNum_);
+    fprintf(stderr, "resident page ratio: %lf\n", totalPageNum_ == 0 ? 0 :
+        (double)residentPageNum_ / totalPageNum_);
+    fprintf(stderr, "===================================\n");
+}
+
+/**
+ * @brief map a container file
+ *
+ * @param fileName the container file
+ * @param fileStat the stat of the file
+ * @return Mapping_t* the mapping, NULL if fails
+ */
+ContainerStore::Mapping_t* ContainerStore::Map(const string& fileName, struct stat& fileStat) {
+    if (fileStat.st_size == 0) {
+        return NULL;
+    }
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+    void* addr = mmap(NULL, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    // the mapping keeps the file alive
+    close(fd);
+    if (addr == MAP_FAILED) {
+        tool::Logging(myName_.c_str(), "cannot map the container: %s\n", fileName.c_str());
+        return NULL;
+    }
+
+    Mapping_t* mapping = new Mapping_t();
+    mapping->fileName = fileName;
+    mapping->addr = (uint8_t*)addr;
+    mapping->size = fileStat.st_size;
+    mapping->ino = fileStat.st_ino;
+    mapping->mtime = fileStat.st_mtim;
+    mapping->refCnt = 0;
+    mapping->stale = false;
+    mapping->idleIter = idleList_.end();
+    mapNum_++;
+    return mapping;
+}
+
+/**
+ * @brief unmap a container file
+ *
+ * @param mapping the mapping
+ */
+void ContainerStore::Unmap(Mapping_t* mapping) {
+    munmap(mapping->addr, mapping->size);
+    delete mapping;
+    return ;
+}
+
+/**
+ * @brief count the resident pages of a mapped range and prefetch it if some are missing
+ *
+ * @param addr the start of the range
+ * @param size the size of the range
+ */
+void ContainerStore::CheckResidency(uint8_t* addr, size_t size) {
+    // a container in a packfile starts inside a page
+    uint8_t* pageAddr = (uint8_t*)((uintptr_t)addr / pageSize_ * pageSize_);
+    size += addr - pageAddr;
+    size_t pageNum = (size + pageSize_ - 1) / pageSize_;
+    vector<unsigned char> pageVec(pageNum);
+    if (mincore(pageAddr, size, pageVec.data()) != 0) {
+        return ;
+    }
+    size_t residentNum = 0;
+    for (size_t i = 0; i < pageNum; i++) {
+        residentNum += (pageVec[i] & 0x1);
+    }
+    totalPageNum_ += pageNum;
+    residentPageNum_ += residentNum;
+    if (residentNum != pageNum) {
+        // the whole container is consumed, start the read-ahead before the first fault
+        madvise(pageAddr, size, MADV_WILLNEED);
+    }
+    return ;
+}
+
+/**
+ * @brief get a view of a container file
+ *
+ * @param fileName the container file
+ * @param view the view <return>
+ * @return true success
+ * @return false the file does not exist
+ */
+bool ContainerStore::Open(const string& fileName, ContainerView_t& view) {
+    struct stat fileStat;
+    if (stat(fileName.c_str(), &fileStat) != 0) {
+        return false;
+    }
+
+    boost::mutex::scoped_lock lock(storeLck_);
+    Mapping_t* mapping = NULL;
+    auto findResult = mappingMap_.find(fileName);
+    if (findResult != mappingMap_.end()) {
+        mapping = findResult->second;
+        if (mapping->ino != fileStat.st_ino || mapping->size != (size_t)fileStat.st_size ||
+            mapping->mtime.tv_sec != fileStat.st_mtim.tv_sec ||
+            mapping->mtime.tv_nsec != fileStat.st_mtim.tv_nsec) {
+            // the file is replaced or appended, map it again
+            mappingMap_.erase(findResult);
+            if (mapping->refCnt == 0) {
+                idleList_.erase(mapping->idleIter);
+                this->Unmap(mapping);
+            } else {
+                mapping->stale = true;
+            }
+            mapping = NULL;
+        }
+    }
+
+    if (mapping == NULL) {
+        mapping = this->Map(fileName, fileStat);
+        if (mapping == NULL) {
+            return false;
+        }
+        mappingMap_[fileName] = mapping;
+    } else if (mapping->refCnt == 0) {
+        idleList_.erase(mapping->idleIter);
+        mapping->idleIter = idleList_.end();
+    }
+
+    if (mapping->refCnt == 0) {
+        this->CheckResidency(mapping->addr, mapping->size);
+    }
+    mapping->refCnt++;
+    openNum_++;
+
+    view.data = mapping->addr;
+    view.size = mapping->size;
+    view.mapping = mapping;
+    return true;
+}
+
+/**
+ * @brief release a view
+ *
+ * @param view the view
+ */
+void ContainerStore::Release(ContainerView_t& view) {
+    if (view.mapping == NULL) {
+        return ;
+    }
+    Mapping_t* mapping = (Mapping_t*)view.mapping;
+    view.mapping = NULL;
+    view.data = NULL;
+    view.size = 0;
+
+    boost::mutex::scoped_lock lock(storeLck_);
+    mapping->refCnt--;
+    if (mapping->refCnt != 0) {
+        return ;
+    }
+    if (mapping->stale) {
+        this->Unmap(mapping);
+        return ;
+    }
+    mapping->idleIter = idleList_.insert(idleList_.end(), mapping);
+    if (idleList_.size() > maxIdleNum_) {
+        // the pages stay in the page cache, only drop the oldest mapping
+        Mapping_t* victim = (Mapping_t*)idleList_.front();
+        idleList_.pop_front();
+        mappingMap_.erase(victim->fileName);
+        this->Unmap(victim);
+    }
+    return ;
+}
+
+/**
+ * @brief release a list of views and clear the list
+ *
+ * @param viewList the list of views
+ */
+void ContainerStore::Release(vector<ContainerView_t>& viewList) {
+    for (auto& view : viewList) {
+        this->Release(view);
+    }
+    viewList.clear();
+    return ;
+}
+
+/**
+ * @brief get the file name of a container
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @return string the file name
+ */
+string ContainerStore::ContainerFileName(const string& containerID, uint8_t type) {
+    if (type == DELTA_CONTAINER) {
+        return "Delta-Containers/" + containerID + containerSuffix_;
+    }
+    return "Base-Containers/" + containerID + containerSuffix_;
+}
+
+/**
+ * @brief get a view of a container
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @param view the view <return>
+ * @return true success
+ * @return false the container does not exist
+ */
+bool ContainerStore::OpenContainer(const string& containerID, uint8_t type,
+    ContainerView_t& view) {
+    // the packfiles stay mapped, the view needs no reference
+    uint8_t* data;
+    uint32_t size;
+    if (containerPack_ == NULL ||
+        !containerPack_->Lookup((uint8_t*)containerID.c_str(), type, data, size)) {
+        // a container file written before the packfiles
+        return this->Open(this->ContainerFileName(containerID, type), view);
+    }
+    boost::mutex::scoped_lock lock(storeLck_);
+    this->CheckResidency(data, size);
+    openNum_++;
+    view.data = data;
+    view.size = size;
+    view.mapping = NULL;
+    return true;
+}
+
+/**
+ * @brief read the record of a chunk to the same offset of a container buffer
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @param offset the offset of the record in the container
+ * @param length the length of the chunk
+ * @param containerBuffer the container buffer (MAX_CONTAINER_SIZE) <return>
+ * @return true success
+ * @return false the record is not stored
+ */
+bool ContainerStore::ReadRecord(const string& containerID, uint8_t type, uint32_t offset,
+    uint32_t length, uint8_t* containerBuffer) {
+    size_t recordSize = CHUNK_RECORD_SIZE(length);
+    if (offset + recordSize > MAX_CONTAINER_SIZE) {
+        return false;
+    }
+
+    uint8_t* data;
+    uint32_t size;
+    if (containerPack_ != NULL &&
+        containerPack_->Lookup((uint8_t*)containerID.c_str(), type, data, size)) {
+        if (offset + recordSize > size) {
+            return false;
+        }
+        memcpy(containerBuffer + offset, data + offset, recordSize);
+        return true;
+    }
+
+    int fd = open(this->ContainerFileName(containerID, type).c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    size_t readSize = 0;
+    while (readSize < recordSize) {
+        ssize_t ret = pread(fd, containerBuffer + offset + readSize, recordSize - readSize,
+            offset + readSize);
+        if (ret <= 0) {
+            if (ret < 0 && errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        readSize += ret;
+    }
+    close(fd);
+    return readSize == recordSize;
+}
+
+/**
+ * @brief write a container (replace the old one), the views of the old one stay valid
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @param body the container body
+ * @param size the container size
+ */
+void ContainerStore::SaveContainer(const string& containerID, uint8_t type,
+    const uint8_t* body, size_t size) {
+    if (containerPack_ != NULL) {
+        // the old record stays in its packfile, an old container file is replaced
+        containerPack_->Append((uint8_t*)containerID.c_str(), type, body, size);
+        unlink(this->ContainerFileName(containerID, type).c_str());
+        return ;
+    }
+
+    // rewrite via a temp file, the mappings of the old file stay valid
+    string fileName = this->ContainerFileName(containerID, type);
+    string tmpFileName = fileName + ".tmp";
+    FILE* containerFile = fopen(tmpFileName.c_str(), "wb");
+    if (!containerFile) {
+        tool::Logging(myName_.c_str(), "cannot open the container: %s\n", tmpFileName.c_str());
+        exit(EXIT_FAILURE);
+    }
+    fwrite((char*)body, size, 1, containerFile);
+    fclose(containerFile);
+    if (rename(tmpFileName.c_str(), fileName.c_str()) != 0) {
+        tool::Logging(myName_.c_str(), "cannot replace the container: %s\n", fileName.c_str());
+        exit(EXIT_FAILURE);
+    }
+    return ;
+}
+
+/**
+ * @brief delete a container
+ *
+ * @param containerID the container ID
+ * @param type the container type
+ * @return true success
+ * @return false the container does not exist
+ */
+bool ContainerStore::DeleteContainer(const string& containerID, uint8_t type) {
+    bool packFlag = false;
+    if (containerPack_ != NULL) {
+        uint8_t* data;
+        uint32_t size;
+        if (containerPack_->Lookup((uint8_t*)containerID.c_str(), type, data, size)) {
+            containerPack_->Delete((uint8_t*)containerID.c_str(), type);
+            packFlag = true;
+        }
+    }
+    bool fileFlag = (unlink(this->ContainerFileName(containerID, type).c_str()) == 0);
+    return packFlag || fileFlag;
+}
+
+/**
+ * @brief list the containers of a type, sorted by the container ID
+ *
+ * @param type the container type
+ * @param containerList the (container ID, size) list <return>
+ */
+void ContainerStore::ListContainer(uint8_t type, vector<pair<string, uint32_t>>& containerList) {
+    if (containerPack_ == NULL) {
+        this->ListContainerFile(type, containerList);
+        sort(containerList.begin(), containerList.end());
+        return ;
+    }
+
+    // the containers in the packfiles, then the container files written before them
+    containerPack_->List(type, containerList);
+    unordered_set<string> packIDSet;
+    for (auto& it : containerList) {
+        packIDSet.insert(it.first);
+    }
+    vector<pair<string, uint32_t>> fileList;
+    this->ListContainerFile(type, fileList);
+    for (auto& it : fileList) {
+        if (packIDSet.find(it.first) == packIDSet.end()) {
+            containerList.push_back(it);
+        }
+    }
+    sort(containerList.begin(), containerList.end());
+    return ;
+}
+
+/**
+ * @brief list the container files of a type (unsorted)
+ *
+ * @param type the container type
+ * @param containerList the (container ID, size) list <return>
+ */
+void ContainerStore::ListContainerFile(uint8_t type, vector<pair<string, uint32_t>>& containerList) {
+    string dirName = (type == DELTA_CONTAINER) ? "Delta-Containers/" : "Base-Containers/";
+    DIR* dir = opendir(dirName.c_str());
+    if (dir == NULL) {
+        if (containerPack_ == NULL) {
+            tool::Logging(myName_.c_str(), "cannot open the container dir: %s\n", dirName.c_str());
+        }
+        return ;
+    }
+    struct dirent* dirEntry;
+    struct stat fileStat;
+    while ((dirEntry = readdir(dir)) != NULL) {
+        string fileName = dirEntry->d_name;
+        if (fileName.size() != CONTAINER_ID_LENGTH + containerSuffix_.size() ||
+            fileName.compare(CONTAINER_ID_LENGTH, string::npos, containerSuffix_) != 0) {
+            continue;
+        }
+        if (stat((dirName + fileName).c_str(), &fileStat) != 0 || !S_ISREG(fileStat.st_mode)) {
+            continue;
+        }
+        containerList.push_back(make_pair(fileName.substr(0, CONTAINER_ID_LENGTH),
+            (uint32_t)fileStat.st_size));
+    }
+    closedir(dir);
+    return ;
+}
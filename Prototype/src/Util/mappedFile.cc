@@ -0,0 +1,73 @@
+/**
+ * @file mappedFile.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the read-only mmap of an input file
+ * @version 0.1
+ * @date 2024-03-28
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/mappedFile.h"
+
+/**
+ * @brief Construct a new Mapped File object, map the whole file for the sequential read
+ *
+ * @param path the file path
+ */
+MappedFile::MappedFile(string path) {
+    fd_ = open(path.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        tool::Logging(myName_.c_str(), "open file: %s error.\n", path.c_str());
+        exit(EXIT_FAILURE);
+    }
+    struct stat fileStat;
+    if (fstat(fd_, &fileStat) != 0) {
+        tool::Logging(myName_.c_str(), "stat file: %s error.\n", path.c_str());
+        exit(EXIT_FAILURE);
+    }
+    size_ = fileStat.st_size;
+    if (size_ == 0) {
+        // cannot map an empty file
+        return ;
+    }
+
+    void* addr = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+    if (addr == MAP_FAILED) {
+        tool::Logging(myName_.c_str(), "cannot map file: %s\n", path.c_str());
+        exit(EXIT_FAILURE);
+    }
+    data_ = (uint8_t*)addr;
+    // the chunkers scan the file once from the head, enlarge the kernel read-ahead
+    madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+/**
+ * @brief Destroy the Mapped File object, unmap the file
+ *
+ */
+MappedFile::~MappedFile() {
+    if (data_ != NULL) {
+        munmap(data_, size_);
+    }
+    close(fd_);
+}
+
+/**
+ * @brief ask the kernel to read a range of the file ahead
+ *
+ * @param offset the range offset
+ * @param length the range length
+ */
+void MappedFile::WillNeed(uint64_t offset, uint64_t length) {
+    if (offset >= size_) {
+        return ;
+    }
+    // madvise needs a page-aligned start
+    uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    uint64_t alignedOffset = offset - (offset % pageSize);
+    length = min(length + (offset - alignedOffset), size_ - alignedOffset);
+    madvise(data_ + alignedOffset, length, MADV_WILLNEED);
+    return ;
+}
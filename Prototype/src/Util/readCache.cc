@@ -10,7 +10,6 @@
  */
 
 #include "../../include/readCache.h"
-#include <boost/thread/mutex.hpp>
 
 /**
  * @brief Construct a new Read Cache object
@@ -23,6 +22,7 @@ ReadCache::ReadCache() {
     for (size_t i = 0; i < cacheSize_; i++) {
         containerPool_[i] = (uint8_t*) malloc(MAX_CONTAINER_SIZE * sizeof(uint8_t));
     }
+    pinCntList_.resize(cacheSize_, 0);
     currentIndex_ = 0;
 }
 
@@ -46,19 +46,32 @@ ReadCache::~ReadCache() {
  * @param length the length of the container section
  */
 void ReadCache::InsertToCache(string& name, uint8_t* data, uint32_t length) {
-    if (readCache_->size() + 1 > cacheSize_) {
-        // evict a item
-        uint32_t replaceIndex = readCache_->pruneValue();
-        // fprintf(stdout, "Cache evict: %u\n", replaceIndex);
-        memcpy(containerPool_[replaceIndex], data, length);
-        readCache_->insert(name, replaceIndex);
-    } else {
+    boost::mutex::scoped_lock lock(cacheLck_);
+    if (readCache_->contains(name)) {
+        // the prefetch thread has inserted it
+        return ;
+    }
+
+    uint32_t replaceIndex;
+    if (currentIndex_ < cacheSize_) {
         // directly using current index
-        // fprintf(stdout, "Cache use: %lu\n", currentIndex_);
-        memcpy(containerPool_[currentIndex_], data, length);
-        readCache_->insert(name, currentIndex_);
+        replaceIndex = currentIndex_;
         currentIndex_++;
+    } else {
+        // evict a item
+        string victimName;
+        uint64_t victimPos;
+        if (!this->FindVictim(victimName, replaceIndex, victimPos)) {
+            return ;
+        }
+        if (!this->Admit(name, victimPos)) {
+            return ;
+        }
+        readCache_->remove(victimName);
     }
+    memcpy(containerPool_[replaceIndex], data, length);
+    readCache_->insert(name, replaceIndex);
+    return ;
 }
 
 /**
@@ -69,6 +82,7 @@ void ReadCache::InsertToCache(string& name, uint8_t* data, uint32_t length) {
  * @return false 
  */
 bool ReadCache::ExistsInCache(string& name) {
+    boost::mutex::scoped_lock lock(cacheLck_);
     bool flag = false;
     flag = this->readCache_->contains(name);
     return flag;
@@ -81,6 +95,164 @@ bool ReadCache::ExistsInCache(string& name) {
  * @return string the data
  */
 uint8_t* ReadCache::ReadFromCache(string& name) {
+    boost::mutex::scoped_lock lock(cacheLck_);
     uint32_t index = this->readCache_->get(name);
     return containerPool_[index];
-}
\ No newline at end of file
+}
+
+/**
+ * @brief pin a cached container, it is not evicted until it is unpinned
+ * 
+ * @param name id of the container
+ * @param index the pool index of the container <return>
+ * @return uint8_t* the container data, NULL if it is not cached
+ */
+uint8_t* ReadCache::PinFromCache(string& name, uint32_t& index) {
+    boost::mutex::scoped_lock lock(cacheLck_);
+    if (!readCache_->tryGet(name, index)) {
+        return NULL;
+    }
+    pinCntList_[index]++;
+    return containerPool_[index];
+}
+
+/**
+ * @brief unpin a list of containers and clear the list
+ * 
+ * @param pinList the pool indexes of the pinned containers
+ */
+void ReadCache::Unpin(vector<uint32_t>& pinList) {
+    boost::mutex::scoped_lock lock(cacheLck_);
+    for (auto index : pinList) {
+        pinCntList_[index]--;
+    }
+    pinList.clear();
+    return ;
+}
+
+/**
+ * @brief add a known future access of a container (the eviction hint)
+ * 
+ * @param name id of the container
+ * @param pos the position in the access sequence
+ */
+void ReadCache::AddFutureAccess(const string& name, uint64_t pos) {
+    boost::mutex::scoped_lock lock(cacheLck_);
+    futureMap_[name].push_back(pos);
+    return ;
+}
+
+/**
+ * @brief the restore accesses a container, drop its earliest future access
+ * 
+ * @param name id of the container
+ */
+void ReadCache::ConsumeAccess(const string& name) {
+    boost::mutex::scoped_lock lock(cacheLck_);
+    auto findResult = futureMap_.find(name);
+    if (findResult == futureMap_.end()) {
+        return ;
+    }
+    uint64_t pos = findResult->second.front();
+    findResult->second.pop_front();
+    if (findResult->second.empty()) {
+        futureMap_.erase(findResult);
+    }
+    if (pos + 1 > accessPos_) {
+        accessPos_ = pos + 1;
+    }
+    return ;
+}
+
+/**
+ * @brief check whether a container would be cached if it is inserted now
+ * 
+ * @param name id of the container
+ * @return true it would be cached
+ * @return false it would be rejected (or it is cached already)
+ */
+bool ReadCache::WouldAdmit(const string& name) {
+    boost::mutex::scoped_lock lock(cacheLck_);
+    if (readCache_->contains(name)) {
+        return false;
+    }
+    if (currentIndex_ < cacheSize_) {
+        return true;
+    }
+    string victimName;
+    uint32_t victimIndex;
+    uint64_t victimPos;
+    if (!this->FindVictim(victimName, victimIndex, victimPos)) {
+        return false;
+    }
+    return this->Admit(name, victimPos);
+}
+
+/**
+ * @brief get the position of the next access of a container
+ * 
+ * @param name id of the container
+ * @return uint64_t the position, UINT64_MAX if it is not accessed again
+ */
+uint64_t ReadCache::NextAccess(const string& name) {
+    auto findResult = futureMap_.find(name);
+    if (findResult == futureMap_.end()) {
+        return UINT64_MAX;
+    }
+    // drop the accesses which are passed
+    deque<uint64_t>& posList = findResult->second;
+    while (!posList.empty() && posList.front() < accessPos_) {
+        posList.pop_front();
+    }
+    if (posList.empty()) {
+        futureMap_.erase(findResult);
+        return UINT64_MAX;
+    }
+    return posList.front();
+}
+
+/**
+ * @brief find the unpinned container whose next access is the farthest (the LRU one on ties)
+ * 
+ * @param victimName id of the container <return>
+ * @param victimIndex the pool index of the container <return>
+ * @param victimPos the position of its next access <return>
+ * @return true find a victim
+ * @return false all cached containers are pinned
+ */
+bool ReadCache::FindVictim(string& victimName, uint32_t& victimIndex, uint64_t& victimPos) {
+    bool findFlag = false;
+    victimPos = 0;
+    // walk from the MRU one to the LRU one
+    auto walker = [&](const lru11::KeyValuePair<string, uint32_t>& item) {
+        if (pinCntList_[item.value] != 0) {
+            // the restore is reading it
+            return ;
+        }
+        uint64_t pos = this->NextAccess(item.key);
+        if (pos >= victimPos) {
+            findFlag = true;
+            victimPos = pos;
+            victimName = item.key;
+            victimIndex = item.value;
+        }
+    };
+    readCache_->cwalk(walker);
+    return findFlag;
+}
+
+/**
+ * @brief check whether a new container is accessed earlier than the victim
+ * 
+ * @param name id of the new container
+ * @param victimPos the position of the next access of the victim
+ * @return true cache the new container
+ * @return false the new container should not be cached
+ */
+bool ReadCache::Admit(const string& name, uint64_t victimPos) {
+    if (futureMap_.empty()) {
+        // no hint, always replace the LRU one
+        return true;
+    }
+    return this->NextAccess(name) <= victimPos;
+}
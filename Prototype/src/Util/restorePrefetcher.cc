@@ -0,0 +1,131 @@
+/**
+ * @file restorePrefetcher.cc
+ * @author Ruilin Wu(202222080631@std.uestc.edu.cn)
+ * @brief implement the read-ahead of the containers of a restore, driven by the resolved file recipe
+ * @version 0.1
+ * @date 2024-03-26
+ *
+ * @copyright Copyright (c) 2021
+ *
+ */
+
+#include "../../include/restorePrefetcher.h"
+
+/**
+ * @brief Construct a new Restore Prefetcher object, start the prefetch thread
+ *
+ * @param containerStore the container store
+ * @param readCache the container cache of the client
+ * @param lookaheadNum the max distance (in container accesses) of the read-ahead
+ */
+RestorePrefetcher::RestorePrefetcher(ContainerStore* containerStore, ReadCache* readCache,
+    uint64_t lookaheadNum) {
+    containerStore_ = containerStore;
+    readCache_ = readCache;
+    lookaheadNum_ = lookaheadNum;
+    worker_ = new boost::thread(boost::bind(&RestorePrefetcher::Run, this));
+}
+
+/**
+ * @brief Destroy the Restore Prefetcher object, stop the prefetch thread
+ *
+ */
+RestorePrefetcher::~RestorePrefetcher() {
+    {
+        boost::mutex::scoped_lock lock(prefetchLck_);
+        done_ = true;
+    }
+    jobCond_.notify_all();
+    worker_->join();
+    delete worker_;
+
+    fprintf(stderr, "========RestorePrefetcher Info========\n");
+    fprintf(stderr, "posted container access num: %lu\n", postNum_);
+    fprintf(stderr, "prefetched container num: %lu\n", prefetchNum_);
+    fprintf(stderr, "skipped container num: %lu\n", skipNum_);
+    fprintf(stderr, "======================================\n");
+}
+
+/**
+ * @brief post the containers of a future load, in the access order
+ *
+ * @param idBuffer the container IDs
+ * @param idNum the number of container IDs
+ */
+void RestorePrefetcher::Post(const uint8_t* idBuffer, uint32_t idNum) {
+    string containerIDStr;
+    {
+        boost::mutex::scoped_lock lock(prefetchLck_);
+        for (size_t i = 0; i < idNum; i++) {
+            containerIDStr.assign((char*)idBuffer + i * CONTAINER_ID_LENGTH,
+                CONTAINER_ID_LENGTH);
+            readCache_->AddFutureAccess(containerIDStr, postPos_);
+            jobList_.push_back(make_pair(containerIDStr, postPos_));
+            postPos_++;
+        }
+        postNum_ += idNum;
+    }
+    jobCond_.notify_all();
+    return ;
+}
+
+/**
+ * @brief the restore accesses a container
+ *
+ * @param containerID the container ID
+ */
+void RestorePrefetcher::Consume(const string& containerID) {
+    readCache_->ConsumeAccess(containerID);
+    {
+        boost::mutex::scoped_lock lock(prefetchLck_);
+        accessPos_++;
+    }
+    jobCond_.notify_all();
+    return ;
+}
+
+/**
+ * @brief the main loop of the prefetch thread
+ *
+ */
+void RestorePrefetcher::Run() {
+    pair<string, uint64_t> job;
+    ContainerView_t containerView;
+    while (true) {
+        {
+            boost::mutex::scoped_lock lock(prefetchLck_);
+            // do not run farther than the cache can hold
+            while (!done_ && (jobList_.empty() ||
+                jobList_.front().second >= accessPos_ + lookaheadNum_)) {
+                jobCond_.wait(lock);
+            }
+            if (done_) {
+                break;
+            }
+            job = jobList_.front();
+            jobList_.pop_front();
+            if (job.second < accessPos_) {
+                // the restore has loaded it
+                skipNum_++;
+                continue;
+            }
+        }
+
+        if (!readCache_->WouldAdmit(job.first)) {
+            // cached, or accessed later than all cached containers
+            skipNum_++;
+            continue;
+        }
+        if (!containerStore_->OpenContainer(job.first, BASE_CONTAINER, containerView)) {
+            if (!containerStore_->OpenContainer(job.first, DELTA_CONTAINER, containerView)) {
+                // the restore reports the missing container when it loads it
+                skipNum_++;
+                continue;
+            }
+        }
+        readCache_->InsertToCache(job.first, containerView.data, containerView.size);
+        containerStore_->Release(containerView);
+        prefetchNum_++;
+    }
+    return ;
+}